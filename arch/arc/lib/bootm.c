@@ -63,6 +63,7 @@ static void boot_jump_linux(struct bootm_headers *images, int flag)
 
 	printf("\nStarting kernel ...%s\n\n", fake ?
 	       "(fake run for tracing)" : "");
+	flush();
 	bootstage_mark_name(BOOTSTAGE_ID_BOOTM_HANDOFF, "start_kernel");
 
 	if (CONFIG_IS_ENABLED(OF_LIBFDT) && images->ft_len) {
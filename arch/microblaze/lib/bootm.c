@@ -41,6 +41,7 @@ static void boot_jump_linux(struct bootm_headers *images, int flag)
 
 	printf("\nStarting kernel ...%s\n\n", fake ?
 	       "(fake run for tracing)" : "");
+	flush();
 	bootstage_mark_name(BOOTSTAGE_ID_BOOTM_HANDOFF, "start_kernel");
 
 	flush_cache_all();
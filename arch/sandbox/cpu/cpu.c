@@ -10,6 +10,7 @@
 #include <errno.h>
 #include <log.h>
 #include <os.h>
+#include <prof.h>
 #include <setjmp.h>
 #include <asm/global_data.h>
 #include <asm/io.h>
@@ -443,6 +444,18 @@ ulong timer_get_boot_us(void)
 	return (count - base_count) / 1000;
 }
 
+#if CONFIG_IS_ENABLED(PROFILER)
+int arch_prof_start(uint rate)
+{
+	return os_prof_start(rate, prof_sample);
+}
+
+void arch_prof_stop(void)
+{
+	os_prof_stop();
+}
+#endif
+
 int sandbox_load_other_fdt(void **fdtp, int *sizep)
 {
 	const char *orig;
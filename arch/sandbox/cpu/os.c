@@ -385,6 +385,97 @@ int os_setup_signal_handlers(void)
 	return 0;
 }
 
+static void (*prof_handler)(unsigned long pc, unsigned long fp,
+			     unsigned long sp, unsigned long stack_top);
+static unsigned long prof_stack_top;
+
+/* Find the top of the main stack, so that the profiler can check frames */
+static unsigned long os_find_stack_top(void)
+{
+	unsigned long start, end;
+	char line[256];
+	unsigned long top = 0;
+	FILE *f;
+
+	f = fopen("/proc/self/maps", "r");
+	if (!f)
+		return 0;
+	while (fgets(line, sizeof(line), f)) {
+		if (strstr(line, "[stack]") &&
+		    sscanf(line, "%lx-%lx", &start, &end) == 2) {
+			top = end;
+			break;
+		}
+	}
+	fclose(f);
+
+	return top;
+}
+
+static void os_prof_handler(int sig, siginfo_t *info, void *con)
+{
+	ucontext_t __maybe_unused *context = con;
+	unsigned long pc, fp, sp;
+
+#if defined(__x86_64__)
+	pc = context->uc_mcontext.gregs[REG_RIP];
+	fp = context->uc_mcontext.gregs[REG_RBP];
+	sp = context->uc_mcontext.gregs[REG_RSP];
+#elif defined(__aarch64__)
+	pc = context->uc_mcontext.pc;
+	fp = context->uc_mcontext.regs[29];
+	sp = context->uc_mcontext.sp;
+#else
+	/* os_prof_start() does not allow this */
+	pc = 0;
+	fp = 0;
+	sp = 0;
+#endif
+	prof_handler(pc, fp, sp, prof_stack_top);
+}
+
+int os_prof_start(unsigned int rate,
+		  void (*handler)(unsigned long pc, unsigned long fp,
+				  unsigned long sp, unsigned long stack_top))
+{
+	struct itimerval timer;
+	struct sigaction act;
+	unsigned long period_us;
+
+#if !defined(__x86_64__) && !defined(__aarch64__)
+	return -ENOSYS;
+#endif
+	if (!rate)
+		return -EINVAL;
+	period_us = 1000000 / rate ?: 1;
+
+	prof_handler = handler;
+	prof_stack_top = os_find_stack_top();
+	memset(&act, '\0', sizeof(act));
+	act.sa_sigaction = os_prof_handler;
+	sigemptyset(&act.sa_mask);
+	act.sa_flags = SA_SIGINFO | SA_RESTART;
+	if (sigaction(SIGPROF, &act, NULL))
+		return -errno;
+
+	timer.it_interval.tv_sec = period_us / 1000000;
+	timer.it_interval.tv_usec = period_us % 1000000;
+	timer.it_value = timer.it_interval;
+	if (setitimer(ITIMER_PROF, &timer, NULL))
+		return -errno;
+
+	return 0;
+}
+
+void os_prof_stop(void)
+{
+	struct itimerval timer;
+
+	memset(&timer, '\0', sizeof(timer));
+	setitimer(ITIMER_PROF, &timer, NULL);
+	signal(SIGPROF, SIG_IGN);
+}
+
 /* Put tty into raw mode so <tab> and <ctrl+c> work */
 void os_tty_raw(int fd, bool allow_sigs)
 {
@@ -38,6 +38,16 @@ size_t sandbox_serial_written(void);
  */
 void sandbox_serial_endisable(bool enabled);
 
+/**
+ * sandbox_serial_set_busy() - Pretend that the UART's FIFO is full
+ * @busy: true to make putc() and puts() return -EAGAIN, false to accept
+ *	output again
+ *
+ * This allows tests to check what happens to output which the UART cannot
+ * take straight away.
+ */
+void sandbox_serial_set_busy(bool busy);
+
 /**
  * struct sandbox_serial_priv - Private data for this driver
  *
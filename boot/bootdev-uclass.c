@@ -17,6 +17,7 @@
 #include <part.h>
 #include <sort.h>
 #include <spl.h>
+#include <uthread.h>
 #include <dm/device-internal.h>
 #include <dm/lists.h>
 #include <dm/uclass-internal.h>
@@ -561,6 +562,36 @@ static int default_get_bootflow(struct udevice *dev, struct bootflow_iter *iter,
 	return 0;
 }
 
+/**
+ * bootdev_abandoned() - Check if a bootdev relies on an abandoned hunter
+ *
+ * @dev: Bootdev to check
+ * Return: true if @dev or one of its parents is in the uclass of a hunter
+ * which was abandoned part-way through, false otherwise
+ */
+static bool bootdev_abandoned(struct udevice *dev)
+{
+	struct bootdev_hunter *start;
+	struct bootstd_priv *std;
+	int n_ent, i;
+
+	std = bootstd_try_priv();
+	if (!std || !std->hunters_abandoned)
+		return false;
+
+	start = ll_entry_start(struct bootdev_hunter, bootdev_hunter);
+	n_ent = ll_entry_count(struct bootdev_hunter, bootdev_hunter);
+	for (; dev; dev = dev_get_parent(dev)) {
+		for (i = 0; i < n_ent; i++) {
+			if ((std->hunters_abandoned & BIT(i)) &&
+			    device_get_uclass_id(dev) == start[i].uclass)
+				return true;
+		}
+	}
+
+	return false;
+}
+
 int bootdev_get_bootflow(struct udevice *dev, struct bootflow_iter *iter,
 			 struct bootflow *bflow)
 {
@@ -569,6 +600,9 @@ int bootdev_get_bootflow(struct udevice *dev, struct bootflow_iter *iter,
 	log_debug("->get_bootflow %s,%x=%p\n", dev->name, iter->part,
 		  ops->get_bootflow);
 	bootflow_init(bflow, dev, iter->method);
+	/* The media may have been left part-way through being set up */
+	if (bootdev_abandoned(dev))
+		return log_msg_ret("abn", -ESHUTDOWN);
 	if (!ops->get_bootflow)
 		return default_get_bootflow(dev, iter, bflow);
 
@@ -755,6 +789,17 @@ int bootdev_setup_iter(struct bootflow_iter *iter, const char *label,
 	} else {
 		bool ok;
 
+		/*
+		 * Start the remaining hunters in the background, so that slow
+		 * media can come up while faster bootdevs are being scanned
+		 */
+		if ((iter->flags & BOOTFLOWIF_HUNT) &&
+		    (iter->flags & BOOTFLOWIF_HUNT_BG)) {
+			ret = bootdev_hunt_start(BOOTDEVP_2_INTERNAL_FAST);
+			if (ret)
+				return log_msg_ret("bg", ret);
+		}
+
 		/* This either returns a non-empty list or NULL */
 		iter->labels = bootstd_get_bootdev_order(bootstd, &ok);
 		if (!ok)
@@ -782,9 +827,25 @@ int bootdev_setup_iter(struct bootflow_iter *iter, const char *label,
 	return 0;
 }
 
+static int bootdev_run_hunter(struct bootstd_priv *std,
+			      struct bootdev_hunter *info, uint seq, bool show)
+{
+	int ret;
+
+	log_debug("Hunting with: %s\n", uclass_get_name(info->uclass));
+	if (info->hunt) {
+		ret = info->hunt(info, show);
+		log_debug("  - hunt result %d\n", ret);
+		if (ret && ret != -ENOENT)
+			return ret;
+	}
+	std->hunters_used |= BIT(seq);
+
+	return 0;
+}
+
 static int bootdev_hunt_drv(struct bootdev_hunter *info, uint seq, bool show)
 {
-	const char *name = uclass_get_name(info->uclass);
 	struct bootstd_priv *std;
 	int ret;
 
@@ -792,23 +853,121 @@ static int bootdev_hunt_drv(struct bootdev_hunter *info, uint seq, bool show)
 	if (ret)
 		return log_msg_ret("std", ret);
 
-	if (!(std->hunters_used & BIT(seq))) {
-		if (show)
-			printf("Hunting with: %s\n",
-			       uclass_get_name(info->uclass));
-		log_debug("Hunting with: %s\n", name);
-		if (info->hunt) {
-			ret = info->hunt(info, show);
-			log_debug("  - hunt result %d\n", ret);
-			if (ret && ret != -ENOENT)
-				return ret;
+	if (std->hunters_used & BIT(seq))
+		return 0;
+	if (std->hunters_abandoned & BIT(seq)) {
+		log_debug("Not hunting with abandoned %s\n",
+			  uclass_get_name(info->uclass));
+		return 0;
+	}
+	if (show)
+		printf("Hunting with: %s\n", uclass_get_name(info->uclass));
+
+	/* If this hunter is running in the background, wait for it */
+	while (std->hunters_busy & BIT(seq))
+		uthread_schedule();
+	if (std->hunters_used & BIT(seq))
+		return 0;
+
+	std->hunters_busy |= BIT(seq);
+	ret = bootdev_run_hunter(std, info, seq, show);
+	std->hunters_busy &= ~BIT(seq);
+
+	return ret;
+}
+
+/**
+ * struct bootdev_hunt_ctx - Context for a hunter running in the background
+ *
+ * @std: bootstd state
+ * @info: Hunter to run
+ * @seq: Position of @info in the linker list
+ */
+struct bootdev_hunt_ctx {
+	struct bootstd_priv *std;
+	struct bootdev_hunter *info;
+	uint seq;
+};
+
+static void bootdev_hunt_thread(void *arg)
+{
+	struct bootdev_hunt_ctx *ctx = arg;
+	struct bootstd_priv *std = ctx->std;
+	int ret;
+
+	ret = bootdev_run_hunter(std, ctx->info, ctx->seq, false);
+	if (ret)
+		log_debug("Background hunt with %s failed (err=%dE)\n",
+			  uclass_get_name(ctx->info->uclass), ret);
+	std->hunters_busy &= ~BIT(ctx->seq);
+	free(ctx);
+}
+
+int bootdev_hunt_start(enum bootdev_prio_t prio)
+{
+	struct bootdev_hunter *start;
+	struct bootstd_priv *std;
+	int n_ent, i;
+	int ret;
+
+	ret = bootstd_get_priv(&std);
+	if (ret)
+		return log_msg_ret("std", ret);
+
+	if (!std->hunt_grp)
+		std->hunt_grp = uthread_grp_new_id();
+	start = ll_entry_start(struct bootdev_hunter, bootdev_hunter);
+	n_ent = ll_entry_count(struct bootdev_hunter, bootdev_hunter);
+	for (i = 0; i < n_ent; i++) {
+		struct bootdev_hunter *info = start + i;
+		struct bootdev_hunt_ctx *ctx;
+
+		if (info->prio < prio ||
+		    ((std->hunters_used | std->hunters_busy |
+		      std->hunters_abandoned) & BIT(i)))
+			continue;
+		ctx = malloc(sizeof(*ctx));
+		if (!ctx)
+			return log_msg_ret("ctx", -ENOMEM);
+		ctx->std = std;
+		ctx->info = info;
+		ctx->seq = i;
+		log_debug("Starting background hunt with: %s\n",
+			  uclass_get_name(info->uclass));
+		std->hunters_busy |= BIT(i);
+		ret = uthread_create(NULL, bootdev_hunt_thread, ctx, 0,
+				     std->hunt_grp);
+		if (ret) {
+			/* leave it to be hunted in the foreground */
+			std->hunters_busy &= ~BIT(i);
+			free(ctx);
+			return log_msg_ret("thr", ret);
 		}
-		std->hunters_used |= BIT(seq);
 	}
 
 	return 0;
 }
 
+void bootdev_hunt_join(struct bootstd_priv *std)
+{
+	if (!std->hunt_grp)
+		return;
+	while (!uthread_grp_done(std->hunt_grp))
+		uthread_schedule();
+}
+
+void bootdev_hunt_abandon(struct bootstd_priv *std)
+{
+	if (!std->hunt_grp)
+		return;
+	uthread_grp_abandon(std->hunt_grp);
+	std->hunt_grp = 0;
+	if (std->hunters_busy)
+		log_debug("Abandoned hunters %x\n", std->hunters_busy);
+	std->hunters_abandoned |= std->hunters_busy;
+	std->hunters_busy = 0;
+}
+
 int bootdev_hunt(const char *spec, bool show)
 {
 	struct bootdev_hunter *start;
@@ -11,12 +11,17 @@
 #include <bootmeth.h>
 #include <bootstd.h>
 #include <dm.h>
-#include <env_internal.h>
+#include <env.h>
+#include <event.h>
 #include <malloc.h>
+#include <part.h>
 #include <serial.h>
+#include <asm/global_data.h>
 #include <dm/device-internal.h>
 #include <dm/uclass-internal.h>
 
+DECLARE_GLOBAL_DATA_PTR;
+
 /* error codes used to signal running out of things */
 enum {
 	BF_NO_MORE_PARTS	= -ESHUTDOWN,
@@ -405,6 +410,8 @@ int bootflow_scan_first(struct udevice *dev, const char *label,
 
 	if (dev || label)
 		flags |= BOOTFLOWIF_SKIP_GLOBAL;
+	if (IS_ENABLED(CONFIG_BOOTSTD_HUNT_UTHREAD))
+		flags |= BOOTFLOWIF_HUNT_BG;
 	bootflow_iter_init(iter, flags);
 
 	/*
@@ -524,11 +531,20 @@ int bootflow_read_all(struct bootflow *bflow)
 
 int bootflow_boot(struct bootflow *bflow)
 {
+	struct bootstd_priv *std;
 	int ret;
 
 	if (bflow->state != BOOTFLOWST_READY)
 		return log_msg_ret("load", -EPROTO);
 
+	/*
+	 * Don't leave hunters driving the hardware while the OS starts, but
+	 * don't wait for slow buses either
+	 */
+	std = bootstd_try_priv();
+	if (std)
+		bootdev_hunt_abandon(std);
+
 	ret = bootmeth_boot(bflow->method, bflow);
 	if (ret)
 		return log_msg_ret("boot", ret);
@@ -541,6 +557,188 @@ int bootflow_boot(struct bootflow *bflow)
 	return log_msg_ret("end", -EFAULT);
 }
 
+/**
+ * bootflow_cache_uuid() - Get the UUID of the partition holding a bootflow
+ *
+ * @bflow: Bootflow to check
+ * @buf: Returns the UUID, or "-" if there is none
+ * @size: Size of @buf
+ * Return: 0 if OK, -ve if the partition could not be read
+ */
+static int bootflow_cache_uuid(const struct bootflow *bflow, char *buf,
+			       int size)
+{
+	struct disk_partition info;
+	struct blk_desc *desc;
+	int ret;
+
+	strlcpy(buf, "-", size);
+	if (!CONFIG_IS_ENABLED(PARTITION_UUIDS) || !bflow->part)
+		return 0;
+
+	desc = dev_get_uclass_plat(bflow->blk);
+	ret = part_get_info(desc, bflow->part, &info);
+	if (ret)
+		return log_msg_ret("uui", ret);
+	if (*disk_partition_uuid(&info))
+		strlcpy(buf, disk_partition_uuid(&info), size);
+
+	return 0;
+}
+
+int bootflow_cache_set(const struct bootflow *bflow)
+{
+	char uuid[UUID_STR_LEN + 1];
+	char buf[BOOTFLOW_CACHE_MAX];
+	struct bootstd_priv *std;
+	int ret;
+
+	ret = bootstd_get_priv(&std);
+	if (ret)
+		return log_msg_ret("cas", ret);
+	free(std->cache_pending);
+	std->cache_pending = NULL;
+	if (!bflow || !bflow->dev || !bflow->blk || !bflow->fname ||
+	    strchr(bflow->fname, ' '))
+		return 0;
+
+	ret = bootflow_cache_uuid(bflow, uuid, sizeof(uuid));
+	if (ret)
+		return log_msg_ret("cau", ret);
+	ret = snprintf(buf, sizeof(buf), "%s:%d %s %s %s", bflow->dev->name,
+		       bflow->part, bflow->method->name, bflow->fname, uuid);
+	if (ret >= sizeof(buf))
+		return log_msg_ret("cal", -E2BIG);
+	std->cache_pending = strdup(buf);
+	if (!std->cache_pending)
+		return log_msg_ret("cmm", -ENOMEM);
+
+	return 0;
+}
+
+const char *bootflow_cache_get(void)
+{
+	struct bootstd_priv *std = bootstd_try_priv();
+
+	return std ? std->cache_pending : NULL;
+}
+
+int bootflow_cache_find(struct bootflow_iter *iter, int flags,
+			struct bootflow *bflow)
+{
+	char *label, *method, *fname, *uuid, *p;
+	char cur_uuid[UUID_STR_LEN + 1];
+	char buf[BOOTFLOW_CACHE_MAX];
+	struct udevice *dev, *bmeth;
+	const char *val;
+	int method_flags;
+	int prio, ret;
+
+	if (!IS_ENABLED(CONFIG_BOOTSTD_FULL))
+		return log_msg_ret("caf", -ENOSYS);
+	val = env_get(BOOTFLOW_CACHE_VAR);
+	if (!val)
+		return -ENOENT;
+	strlcpy(buf, val, sizeof(buf));
+	p = buf;
+	label = strsep(&p, " ");
+	method = strsep(&p, " ");
+	fname = strsep(&p, " ");
+	uuid = strsep(&p, " ");
+	if (!uuid)
+		return log_msg_ret("cap", -EINVAL);
+	log_debug("cached bootflow: %s %s %s %s\n", label, method, fname, uuid);
+	if (uclass_get_device_by_name(UCLASS_BOOTMETH, method, &bmeth))
+		return log_msg_ret("cae", -ESTALE);
+
+	/*
+	 * Hunt one priority at a time until the bootdev turns up, so that the
+	 * slower hunters after it are not run
+	 */
+	p = strchr(label, ':');
+	if (!p)
+		return log_msg_ret("cab", -EINVAL);
+	*p = '\0';
+	for (prio = BOOTDEVP_1_PRE_SCAN; prio < BOOTDEVP_COUNT; prio++) {
+		if (!(flags & BOOTFLOWIF_HUNT) ||
+		    !uclass_find_device_by_name(UCLASS_BOOTDEV, label, &dev))
+			break;
+		ret = bootdev_hunt_prio(prio, false);
+		if (ret)
+			return log_msg_ret("cah", ret);
+	}
+	if (uclass_find_device_by_name(UCLASS_BOOTDEV, label, &dev))
+		return log_msg_ret("cad", -ESTALE);
+	*p = ':';
+
+	/* Set up to scan just the one partition, with just the one bootmeth */
+	bootflow_iter_init(iter, (flags & ~BOOTFLOWIF_HUNT) |
+			   BOOTFLOWIF_SKIP_GLOBAL);
+	iter->method_order = calloc(1, sizeof(struct udevice *));
+	if (!iter->method_order)
+		return log_msg_ret("cao", -ENOMEM);
+	iter->method_order[0] = bmeth;
+	iter->num_methods = 1;
+	iter->method = bmeth;
+	ret = bootdev_setup_iter(iter, label, &dev, &method_flags);
+	if (ret) {
+		ret = log_msg_ret("cai", -ESTALE);
+		goto err;
+	}
+	bootflow_iter_set_dev(iter, dev, method_flags);
+
+	/* Check the UUID before the bootmeth reads anything */
+	bootflow_init(bflow, dev, bmeth);
+	bflow->part = iter->part;
+	if (bootdev_get_sibling_blk(dev, &bflow->blk) ||
+	    bootflow_cache_uuid(bflow, cur_uuid, sizeof(cur_uuid)) ||
+	    strcmp(uuid, cur_uuid)) {
+		ret = log_msg_ret("cau", -ESTALE);
+		goto err;
+	}
+
+	ret = bootflow_check(iter, bflow);
+	if (!ret && bflow->fname && !strcmp(fname, bflow->fname))
+		return 0;
+	bootflow_free(bflow);
+	ret = log_msg_ret("cam", -ESTALE);
+err:
+	bootflow_iter_uninit(iter);
+
+	return ret;
+}
+
+#if CONFIG_IS_ENABLED(BOOTFLOW_CACHE)
+/**
+ * bootflow_cache_ft_fixup() - Tell the OS which bootflow it was booted from
+ *
+ * This adds the pending record to /chosen, so that the OS can confirm a
+ * successful boot by copying it to the BOOTFLOW_CACHE_VAR environment variable
+ */
+static int bootflow_cache_ft_fixup(void *ctx, struct event *event)
+{
+	oftree tree = event->data.ft_fixup.tree;
+	const char *pending;
+	ofnode chosen;
+	int ret;
+
+	pending = bootflow_cache_get();
+	if (!pending)
+		return 0;
+
+	ret = ofnode_add_subnode(oftree_root(tree), "chosen", &chosen);
+	if (ret && ret != -EEXIST)
+		return log_msg_ret("cfc", ret);
+	ret = ofnode_write_prop(chosen, BOOTFLOW_CACHE_PROP, pending,
+				strlen(pending) + 1, true);
+	if (ret)
+		return log_msg_ret("cfp", ret);
+
+	return 0;
+}
+EVENT_SPY_FULL(EVT_FT_FIXUP, bootflow_cache_ft_fixup);
+#endif
+
 int bootflow_run_boot(struct bootflow_iter *iter, struct bootflow *bflow)
 {
 	int ret;
@@ -550,7 +748,11 @@ int bootflow_run_boot(struct bootflow_iter *iter, struct bootflow *bflow)
 	if (IS_ENABLED(CONFIG_OF_HAS_PRIOR_STAGE) &&
 	    (bflow->flags & BOOTFLOWF_USE_PRIOR_FDT))
 		printf("Using prior-stage device tree\n");
+	if (CONFIG_IS_ENABLED(BOOTFLOW_CACHE))
+		bootflow_cache_set(bflow);
 	ret = bootflow_boot(bflow);
+	if (CONFIG_IS_ENABLED(BOOTFLOW_CACHE))
+		bootflow_cache_set(NULL);
 	if (!IS_ENABLED(CONFIG_BOOTSTD_FULL)) {
 		printf("Boot failed (err=%d)\n", ret);
 		return ret;
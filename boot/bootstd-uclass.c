@@ -7,6 +7,7 @@
  */
 
 #include <alist.h>
+#include <bootdev.h>
 #include <bootflow.h>
 #include <bootstd.h>
 #include <dm.h>
@@ -102,8 +103,10 @@ static int bootstd_remove(struct udevice *dev)
 {
 	struct bootstd_priv *priv = dev_get_priv(dev);
 
+	bootdev_hunt_join(priv);
 	free(priv->prefixes);
 	free(priv->bootdev_order);
+	free(priv->cache_pending);
 	bootstd_clear_glob_(priv);
 
 	return 0;
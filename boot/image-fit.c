@@ -36,6 +36,7 @@ DECLARE_GLOBAL_DATA_PTR;
 #include <bootm.h>
 #include <image.h>
 #include <bootstage.h>
+#include <perf.h>
 #include <upl.h>
 #include <u-boot/crc.h>
 
@@ -1249,6 +1250,7 @@ int fit_set_timestamp(void *fit, int noffset, time_t timestamp)
 int calculate_hash(const void *data, int data_len, const char *name,
 			uint8_t *value, int *value_len)
 {
+	uint64_t start = perf_begin();
 #if !defined(USE_HOSTCC) && defined(CONFIG_DM_HASH)
 	int rc;
 	enum HASH_ALGO hash_algo;
@@ -1286,6 +1288,7 @@ int calculate_hash(const void *data, int data_len, const char *name,
 	algo->hash_func_ws(data, data_len, value, algo->chunk_size);
 	*value_len = algo->digest_size;
 #endif
+	perf_end(PERF_HASH, start, data_len);
 
 	return 0;
 }
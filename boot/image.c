@@ -14,6 +14,7 @@
 #include <log.h>
 #include <malloc.h>
 #include <u-boot/crc.h>
+#include <u-boot/schedule.h>
 
 #ifdef CONFIG_SHOW_BOOT_PROGRESS
 #include <status_led.h>
@@ -57,6 +58,7 @@ DECLARE_GLOBAL_DATA_PTR;
 #include <gzip.h>
 #include <image.h>
 #include <imximage.h>
+#include <perf.h>
 #include <relocate.h>
 #include <linux/lzo.h>
 #include <linux/zstd.h>
@@ -448,14 +450,51 @@ int image_decomp_type(const unsigned char *buf, ulong len)
 	return cmagic->comp_id;
 }
 
+#ifndef USE_HOSTCC
+/**
+ * image_decomp_zstd() - Decompress a zstd image a chunk at a time
+ *
+ * Large images, such as a ramdisk, can take a while to decompress, so let the
+ * watchdog and other tasks run after each chunk
+ *
+ * @load_buf: Place to put the decompressed image
+ * @unc_len: Available space for the decompressed image
+ * @image_buf: Compressed image
+ * @image_len: Size of the compressed image
+ * Return: size of the decompressed image, or -ve on error
+ */
+static int image_decomp_zstd(void *load_buf, uint unc_len,
+			     const void *image_buf, ulong image_len)
+{
+	struct zstd_stream zs;
+	struct abuf out;
+	ulong pos, len;
+	int ret = 0;
+
+	abuf_init_set(&out, load_buf, unc_len);
+	zstd_stream_init(&zs, &out);
+	for (pos = 0; !ret && pos < image_len; pos += len) {
+		len = min_t(ulong, image_len - pos, CHUNKSZ);
+		ret = zstd_stream_decompress(&zs, image_buf + pos, len);
+		schedule();
+	}
+	if (ret)
+		return ret;
+
+	return zstd_stream_finish(&zs);
+}
+#endif
+
 int image_decomp(int comp, ulong load, ulong image_start, int type,
 		 void *load_buf, void *image_buf, ulong image_len,
 		 uint unc_len, ulong *load_end)
 {
 	int ret = -ENOSYS;
+	uint64_t start;
 
 	*load_end = load;
 	print_decomp_msg(comp, type, load == image_start, load);
+	start = perf_begin();
 
 	/*
 	 * Load the image to the right place, decompressing if needed. After
@@ -516,17 +555,16 @@ int image_decomp(int comp, ulong load, ulong image_start, int type,
 		}
 		break;
 	case IH_COMP_ZSTD:
-		if (!tools_build() && CONFIG_IS_ENABLED(ZSTD)) {
-			struct abuf in, out;
-
-			abuf_init_set(&in, image_buf, image_len);
-			abuf_init_set(&out, load_buf, unc_len);
-			ret = zstd_decompress(&in, &out);
+#ifndef USE_HOSTCC
+		if (CONFIG_IS_ENABLED(ZSTD)) {
+			ret = image_decomp_zstd(load_buf, unc_len, image_buf,
+						image_len);
 			if (ret >= 0) {
 				image_len = ret;
 				ret = 0;
 			}
 		}
+#endif
 		break;
 	}
 	if (ret == -ENOSYS) {
@@ -537,6 +575,8 @@ int image_decomp(int comp, ulong load, ulong image_start, int type,
 	*load_end = load + image_len;
 	if (ret)
 		return ret;
+	if (comp != IH_COMP_NONE)
+		perf_end(PERF_DECOMP, start, image_len);
 
 	return 0;
 }
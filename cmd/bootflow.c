@@ -149,11 +149,11 @@ static int do_bootflow_scan(struct cmd_tbl *cmdtp, int flag, int argc,
 {
 	struct bootstd_priv *std;
 	struct bootflow_iter iter;
-	struct udevice *dev = NULL;
+	struct udevice *dev = NULL, *cached_dev = NULL, *cached_meth = NULL;
 	struct bootflow bflow;
 	bool all = false, boot = false, errors = false, no_global = false;
 	bool list = false, no_hunter = false, menu = false, text_mode = false;
-	int num_valid = 0;
+	int num_valid = 0, cached_part = 0;
 	const char *label = NULL;
 	bool has_args;
 	int ret, i;
@@ -201,6 +201,28 @@ static int do_bootflow_scan(struct cmd_tbl *cmdtp, int flag, int argc,
 	if (!no_hunter)
 		flags |= BOOTFLOWIF_HUNT;
 
+	/* Go straight to the bootflow which booted last time, if still there */
+	if (IS_ENABLED(CONFIG_BOOTFLOW_CACHE) && boot && !menu && !dev &&
+	    !label) {
+		bootstd_clear_glob();
+		ret = bootflow_cache_find(&iter, flags & ~BOOTFLOWIF_SHOW,
+					  &bflow);
+		if (!ret) {
+			ret = bootstd_add_bootflow(&bflow);
+			if (ret < 0) {
+				printf("Out of memory\n");
+				return CMD_RET_FAILURE;
+			}
+			bootflow_run_boot(&iter, &bflow);
+			bootflow_iter_uninit(&iter);
+
+			/* It did not boot, so don't try it again below */
+			cached_dev = bflow.dev;
+			cached_meth = bflow.method;
+			cached_part = bflow.part;
+		}
+	}
+
 	/*
 	 * If we have a device, just scan for bootflows attached to that device
 	 */
@@ -232,7 +254,9 @@ static int do_bootflow_scan(struct cmd_tbl *cmdtp, int flag, int argc,
 		}
 		if (list)
 			show_bootflow(i, &bflow, errors);
-		if (!menu && boot && !bflow.err)
+		if (!menu && boot && !bflow.err &&
+		    (bflow.dev != cached_dev || bflow.method != cached_meth ||
+		     bflow.part != cached_part))
 			bootflow_run_boot(&iter, &bflow);
 	}
 	bootflow_iter_uninit(&iter);
@@ -5,6 +5,9 @@
 
 #include <bootstage.h>
 #include <command.h>
+#include <env.h>
+#include <malloc.h>
+#include <mapmem.h>
 #include <vsprintf.h>
 #include <linux/string.h>
 
@@ -16,6 +19,44 @@ static int do_bootstage_report(struct cmd_tbl *cmdtp, int flag, int argc,
 	return 0;
 }
 
+static int do_bootstage_trace(struct cmd_tbl *cmdtp, int flag, int argc,
+			      char *const argv[])
+{
+	ulong base, size;
+	char *buf;
+	int len;
+
+	len = bootstage_trace_export(NULL, 0);
+	if (argc < 2) {
+		buf = malloc(len + 1);
+		if (!buf) {
+			printf("Out of memory\n");
+			return CMD_RET_FAILURE;
+		}
+		bootstage_trace_export(buf, len);
+		buf[len] = '\0';
+		puts(buf);
+		free(buf);
+
+		return 0;
+	}
+
+	if (argc < 3)
+		return CMD_RET_USAGE;
+	base = hextoul(argv[1], NULL);
+	size = hextoul(argv[2], NULL);
+	if (len > size) {
+		printf("Trace needs %#x bytes\n", len);
+		return CMD_RET_FAILURE;
+	}
+	buf = map_sysmem(base, len);
+	bootstage_trace_export(buf, len);
+	unmap_sysmem(buf);
+	env_set_hex("filesize", len);
+
+	return 0;
+}
+
 #if IS_ENABLED(CONFIG_BOOTSTAGE_STASH)
 static int get_base_size(int argc, char *const argv[], ulong *basep,
 			 ulong *sizep)
@@ -64,6 +105,7 @@ static int do_bootstage_stash(struct cmd_tbl *cmdtp, int flag, int argc,
 
 static struct cmd_tbl cmd_bootstage_sub[] = {
 	U_BOOT_CMD_MKENT(report, 2, 1, do_bootstage_report, "", ""),
+	U_BOOT_CMD_MKENT(trace, 3, 1, do_bootstage_trace, "", ""),
 #if IS_ENABLED(CONFIG_BOOTSTAGE_STASH)
 	U_BOOT_CMD_MKENT(stash, 4, 0, do_bootstage_stash, "", ""),
 	U_BOOT_CMD_MKENT(unstash, 4, 0, do_bootstage_stash, "", ""),
@@ -95,6 +137,7 @@ U_BOOT_CMD(bootstage, 4, 1, do_boostage,
 	"Boot stage command",
 	" - check boot progress and timing\n"
 	"report                      - Print a report\n"
+	"trace [<addr> <size>]       - Show or write a Chrome trace (JSON)\n"
 #if IS_ENABLED(CONFIG_BOOTSTAGE_STASH)
 	"stash [<start> [<size>]]    - Stash data into memory\n"
 	"unstash [<start> [<size>]]  - Unstash data from memory\n"
@@ -8,8 +8,10 @@
 
 #include <command.h>
 #include <dm.h>
+#include <time.h>
 #include <video.h>
 #include <video_console.h>
+#include <linux/math64.h>
 
 static int do_font_list(struct cmd_tbl *cmdtp, int flag, int argc,
 			char *const argv[])
@@ -78,12 +80,47 @@ static int do_font_size(struct cmd_tbl *cmdtp, int flag, int argc,
 	return 0;
 }
 
+static int do_font_bench(struct cmd_tbl *cmdtp, int flag, int argc,
+			 char *const argv[])
+{
+	const char *line = "The quick brown fox jumps over the lazy dog. 0123456789\n";
+	struct vidconsole_glyph_stats stats;
+	struct udevice *dev;
+	uint count = 100;
+	ulong start, us;
+	uint i, chars;
+
+	if (uclass_first_device_err(UCLASS_VIDEO_CONSOLE, &dev))
+		return CMD_RET_FAILURE;
+	if (argc > 1)
+		count = dectoul(argv[1], NULL);
+
+	start = timer_get_us();
+	for (i = 0; i < count; i++)
+		vidconsole_put_string(dev, line);
+	us = timer_get_us() - start;
+	chars = count * strlen(line);
+
+	printf("%u chars in %lu us", chars, us);
+	if (us)
+		printf(", %llu chars/s", div_u64((u64)chars * 1000000, us));
+	printf("\n");
+	if (!console_truetype_glyph_stats(dev, &stats)) {
+		printf("glyph cache: %u hits, %u misses, %u / %u bytes\n",
+		       stats.hits, stats.misses, stats.used, stats.limit);
+	}
+
+	return 0;
+}
+
 U_BOOT_LONGHELP(font,
 	"list       - list available fonts\n"
 	"font select <name> [<size>] - select font to use\n"
-	"font size <size> - select font size to");
+	"font size <size> - select font size to\n"
+	"font bench [<count>] - measure console drawing speed");
 
 U_BOOT_CMD_WITH_SUBCMDS(font, "Fonts", font_help_text,
 	U_BOOT_SUBCMD_MKENT(list, 1, 1, do_font_list),
 	U_BOOT_SUBCMD_MKENT(select, 3, 1, do_font_select),
-	U_BOOT_SUBCMD_MKENT(size, 2, 1, do_font_size));
+	U_BOOT_SUBCMD_MKENT(size, 2, 1, do_font_size),
+	U_BOOT_SUBCMD_MKENT(bench, 2, 1, do_font_bench));
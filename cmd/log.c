@@ -375,6 +375,30 @@ static int do_log_rec(struct cmd_tbl *cmdtp, int flag, int argc,
 	return 0;
 }
 
+static int do_log_dump(struct cmd_tbl *cmdtp, int flag, int argc,
+		       char *const argv[])
+{
+	bool clear = false;
+
+	if (!CONFIG_IS_ENABLED(LOG_BINARY)) {
+		printf("Binary log not enabled\n");
+		return CMD_RET_FAILURE;
+	}
+	if (argc > 1) {
+		if (strcmp(argv[1], "-c"))
+			return CMD_RET_USAGE;
+		clear = true;
+	}
+	if (log_bin_dump() < 0) {
+		printf("No binary log\n");
+		return CMD_RET_FAILURE;
+	}
+	if (clear)
+		log_bin_reset();
+
+	return 0;
+}
+
 U_BOOT_LONGHELP(log,
 	"level [<level>] - get/set log level\n"
 	"categories - list log categories\n"
@@ -405,7 +429,9 @@ U_BOOT_LONGHELP(log,
 	"\tc=category, l=level, F=file, L=line number, f=function, m=msg\n"
 	"\tor 'default', or 'all' for all\n"
 	"log rec <category> <level> <file> <line> <func> <message> - "
-		"output a log record");
+		"output a log record\n"
+	"log dump [-c] - show records in the binary log\n"
+	"\t-c - Clear the log afterwards");
 
 U_BOOT_CMD_WITH_SUBCMDS(log, "log system", log_help_text,
 	U_BOOT_SUBCMD_MKENT(level, 2, 1, do_log_level),
@@ -417,4 +443,5 @@ U_BOOT_CMD_WITH_SUBCMDS(log, "log system", log_help_text,
 	U_BOOT_SUBCMD_MKENT(filter-remove, 4, 1, do_log_filter_remove),
 	U_BOOT_SUBCMD_MKENT(format, 2, 1, do_log_format),
 	U_BOOT_SUBCMD_MKENT(rec, 7, 1, do_log_rec),
+	U_BOOT_SUBCMD_MKENT(dump, 2, 1, do_log_dump),
 );
@@ -11,6 +11,7 @@
 #include <lmb.h>
 #include <malloc.h>
 #include <mapmem.h>
+#include <slab.h>
 #include <asm/global_data.h>
 
 DECLARE_GLOBAL_DATA_PTR;
@@ -59,6 +60,11 @@ static int do_meminfo(struct cmd_tbl *cmdtp, int flag, int argc,
 	puts("DRAM:  ");
 	print_size(gd->ram_size, "\n");
 
+	if (IS_ENABLED(CONFIG_SYS_MALLOC_SLAB)) {
+		putc('\n');
+		slab_show_stats();
+	}
+
 	if (!IS_ENABLED(CONFIG_CMD_MEMINFO_MAP))
 		return 0;
 
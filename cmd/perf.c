@@ -0,0 +1,55 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Show performance counters
+ */
+
+#include <command.h>
+#include <perf.h>
+#include <linux/string.h>
+
+static int do_perf_show(struct cmd_tbl *cmdtp, int flag, int argc,
+			char *const argv[])
+{
+	bool hist = false;
+
+	if (argc > 1) {
+		if (strcmp(argv[1], "-h"))
+			return CMD_RET_USAGE;
+		hist = true;
+	}
+	perf_show(hist);
+
+	return 0;
+}
+
+static int do_perf_reset(struct cmd_tbl *cmdtp, int flag, int argc,
+			 char *const argv[])
+{
+	perf_reset();
+
+	return 0;
+}
+
+static int do_perf_stash(struct cmd_tbl *cmdtp, int flag, int argc,
+			 char *const argv[])
+{
+	int ret;
+
+	ret = perf_stash();
+	if (ret) {
+		printf("Cannot stash counters (err=%dE)\n", ret);
+		return CMD_RET_FAILURE;
+	}
+
+	return 0;
+}
+
+U_BOOT_LONGHELP(perf,
+	"show [-h]  - show counters (-h to include time histograms)\n"
+	"perf reset      - reset all counters to zero\n"
+	"perf stash      - write counters to the bloblist");
+
+U_BOOT_CMD_WITH_SUBCMDS(perf, "Performance counters", perf_help_text,
+	U_BOOT_SUBCMD_MKENT(show, 2, 1, do_perf_show),
+	U_BOOT_SUBCMD_MKENT(reset, 1, 1, do_perf_reset),
+	U_BOOT_SUBCMD_MKENT(stash, 1, 1, do_perf_stash));
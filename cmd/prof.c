@@ -0,0 +1,104 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Control of the sampling profiler
+ */
+
+#include <command.h>
+#include <env.h>
+#include <mapmem.h>
+#include <prof.h>
+#include <vsprintf.h>
+
+static int do_prof_start(struct cmd_tbl *cmdtp, int flag, int argc,
+			 char *const argv[])
+{
+	uint rate = 0;
+	int ret;
+
+	if (argc > 1)
+		rate = dectoul(argv[1], NULL);
+	ret = prof_start(rate);
+	if (ret) {
+		printf("Cannot start profiler (err=%dE)\n", ret);
+		return CMD_RET_FAILURE;
+	}
+
+	return 0;
+}
+
+static int do_prof_stop(struct cmd_tbl *cmdtp, int flag, int argc,
+			char *const argv[])
+{
+	prof_stop();
+
+	return 0;
+}
+
+static int do_prof_stats(struct cmd_tbl *cmdtp, int flag, int argc,
+			 char *const argv[])
+{
+	prof_print_stats();
+
+	return 0;
+}
+
+static int do_prof_wipe(struct cmd_tbl *cmdtp, int flag, int argc,
+			char *const argv[])
+{
+	prof_wipe();
+
+	return 0;
+}
+
+static int do_prof_samples(struct cmd_tbl *cmdtp, int flag, int argc,
+			   char *const argv[])
+{
+	size_t buff_size, avail, buff_ptr, needed, used;
+	char *buff;
+	int err;
+
+	/* Use the same buffer as the 'trace' command unless told otherwise */
+	if (argc == 3) {
+		buff_size = hextoul(argv[2], NULL);
+		buff = map_sysmem(hextoul(argv[1], NULL), buff_size);
+		buff_ptr = 0;
+	} else if (argc == 1) {
+		buff_size = env_get_ulong("profsize", 16, 0);
+		buff = map_sysmem(env_get_ulong("profbase", 16, 0), buff_size);
+		buff_ptr = env_get_ulong("profoffset", 16, 0);
+	} else {
+		return CMD_RET_USAGE;
+	}
+	if (buff_ptr > buff_size)
+		return CMD_RET_USAGE;
+
+	avail = buff_size - buff_ptr;
+	err = prof_list_samples(buff + buff_ptr, avail, &needed);
+	if (err) {
+		printf("Error: %#zx bytes needed\n", needed);
+		return CMD_RET_FAILURE;
+	}
+	used = needed;
+	printf("Samples dumped to %08lx, size %#zx\n",
+	       (ulong)map_to_sysmem(buff + buff_ptr), used);
+
+	env_set_hex("profbase", map_to_sysmem(buff));
+	env_set_hex("profsize", buff_size);
+	env_set_hex("profoffset", buff_ptr + used);
+
+	return 0;
+}
+
+U_BOOT_LONGHELP(prof,
+	"start [<rate>]          - start sampling, <rate> times a second\n"
+	"prof stop                    - stop sampling\n"
+	"prof stats                   - display profiler statistics\n"
+	"prof wipe                    - discard all samples\n"
+	"prof samples [<addr> <size>] - dump samples into buffer for proftool");
+
+U_BOOT_CMD_WITH_SUBCMDS(prof, "Sampling profiler", prof_help_text,
+	U_BOOT_SUBCMD_MKENT(start, 2, 1, do_prof_start),
+	U_BOOT_SUBCMD_MKENT(stop, 1, 1, do_prof_stop),
+	U_BOOT_SUBCMD_MKENT(stats, 1, 1, do_prof_stats),
+	U_BOOT_SUBCMD_MKENT(wipe, 1, 1, do_prof_wipe),
+	U_BOOT_SUBCMD_MKENT(samples, 3, 1, do_prof_samples));
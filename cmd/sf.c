@@ -18,7 +18,9 @@
 #include <spi_flash.h>
 #include <asm/cache.h>
 #include <jffs2/jffs2.h>
+#include <linux/math64.h>
 #include <linux/mtd/mtd.h>
+#include <linux/sizes.h>
 
 #include <asm/io.h>
 #include <dm/device-internal.h>
@@ -584,6 +586,82 @@ static int do_spi_flash_test(int argc, char *const argv[])
 	return 0;
 }
 
+#ifdef CONFIG_CMD_SF_BENCH
+static void spi_flash_show_proto(enum spi_nor_protocol proto)
+{
+	const char *dtr = spi_nor_protocol_is_dtr(proto) ? "D" : "";
+
+	printf("%u%s-%u%s-%u%s", spi_nor_get_protocol_inst_nbits(proto), dtr,
+	       spi_nor_get_protocol_addr_nbits(proto), dtr,
+	       spi_nor_get_protocol_data_nbits(proto), dtr);
+}
+
+static int do_spi_flash_bench(int argc, char *const argv[])
+{
+	u32 orig_hwcap = flash->read_hwcap;
+	ulong offset = 0, len = SZ_1M;
+	u8 *buf, *ref;
+	int bit, ret;
+
+	if (argc > 1 && strict_strtoul(argv[1], 16, &offset))
+		return CMD_RET_USAGE;
+	if (argc > 2 && strict_strtoul(argv[2], 16, &len))
+		return CMD_RET_USAGE;
+	if (offset >= flash->size)
+		return CMD_RET_USAGE;
+	len = min_t(ulong, len, flash->size - offset);
+
+	ref = memalign(ARCH_DMA_MINALIGN, len);
+	buf = memalign(ARCH_DMA_MINALIGN, len);
+	if (!ref || !buf) {
+		printf("Cannot allocate memory (%lu bytes)\n", len);
+		ret = CMD_RET_FAILURE;
+		goto out;
+	}
+
+	ret = spi_flash_read(flash, offset, len, ref);
+	if (ret) {
+		printf("Read failed (err = %d)\n", ret);
+		ret = CMD_RET_FAILURE;
+		goto out;
+	}
+
+	printf("Reading %lu bytes @ 0x%lx\n", len, offset);
+	for (bit = 0; bit < 32; bit++) {
+		u64 start, us, kib_s;
+
+		if (spi_nor_select_read_hwcap(flash, BIT(bit)))
+			continue;
+
+		memset(buf, '\0', len);
+		start = timer_get_us();
+		ret = spi_flash_read(flash, offset, len, buf);
+		us = max_t(u64, timer_get_us() - start, 1);
+
+		printf("%c ", BIT(bit) == orig_hwcap ? '*' : ' ');
+		spi_flash_show_proto(flash->read_proto);
+		printf(" (%02x)", flash->read_opcode);
+		if (ret) {
+			printf(": read failed (err = %d)\n", ret);
+			continue;
+		}
+		kib_s = div64_u64((u64)len * 1000000, us * 1024);
+		printf(": %llu us, %llu KiB/s, %llu.%02llu MiB/s%s\n", us, kib_s,
+		       kib_s / 1024, (kib_s % 1024) * 100 / 1024,
+		       memcmp(buf, ref, len) ? " (data mismatch)" : "");
+	}
+	ret = CMD_RET_SUCCESS;
+
+out:
+	if (orig_hwcap)
+		spi_nor_select_read_hwcap(flash, orig_hwcap);
+	free(buf);
+	free(ref);
+
+	return ret;
+}
+#endif
+
 static int do_spi_flash(struct cmd_tbl *cmdtp, int flag, int argc,
 			char *const argv[])
 {
@@ -616,6 +694,10 @@ static int do_spi_flash(struct cmd_tbl *cmdtp, int flag, int argc,
 		ret = do_spi_protect(argc, argv);
 	else if (IS_ENABLED(CONFIG_CMD_SF_TEST) && !strcmp(cmd, "test"))
 		ret = do_spi_flash_test(argc, argv);
+#ifdef CONFIG_CMD_SF_BENCH
+	else if (!strcmp(cmd, "bench"))
+		ret = do_spi_flash_bench(argc, argv);
+#endif
 	else
 		ret = CMD_RET_USAGE;
 
@@ -643,6 +725,9 @@ U_BOOT_LONGHELP(sf,
 #endif
 #ifdef CONFIG_CMD_SF_TEST
 	"\nsf test offset len		- run a very basic destructive test"
+#endif
+#ifdef CONFIG_CMD_SF_BENCH
+	"\nsf bench [offset [len]]		- measure read speed per protocol"
 #endif
 	);
 
@@ -48,6 +48,7 @@ U_BOOT_CMD(
 static int do_gzwrite(struct cmd_tbl *cmdtp, int flag,
 		      int argc, char *const argv[])
 {
+	enum gzwrite_zeros zeros = GZWRITE_ZEROS_WRITE;
 	struct blk_desc *bdev;
 	int ret;
 	unsigned char *addr;
@@ -56,6 +57,15 @@ static int do_gzwrite(struct cmd_tbl *cmdtp, int flag,
 	u64 startoffs = 0;
 	u64 szexpected = 0;
 
+	if (argc > 1 && !strcmp(argv[1], "-s")) {
+		zeros = GZWRITE_ZEROS_SKIP;
+		argc--;
+		argv++;
+	} else if (argc > 1 && !strcmp(argv[1], "-e")) {
+		zeros = GZWRITE_ZEROS_ERASE;
+		argc--;
+		argv++;
+	}
 	if (argc < 5)
 		return CMD_RET_USAGE;
 	ret = blk_get_device_by_str(argv[1], argv[2], &bdev);
@@ -75,15 +85,18 @@ static int do_gzwrite(struct cmd_tbl *cmdtp, int flag,
 		}
 	}
 
-	ret = gzwrite(addr, length, bdev, writebuf, startoffs, szexpected);
+	ret = gzwrite(addr, length, bdev, writebuf, startoffs, szexpected,
+		      zeros);
 
 	return ret ? CMD_RET_FAILURE : CMD_RET_SUCCESS;
 }
 
 U_BOOT_CMD(
-	gzwrite, 8, 0, do_gzwrite,
+	gzwrite, 9, 0, do_gzwrite,
 	"unzip and write memory to block device",
-	"<interface> <dev> <addr> length [wbuf=1M [offs=0 [outsize=0]]]\n"
+	"[-s | -e] <interface> <dev> <addr> length [wbuf=1M [offs=0 [outsize=0]]]\n"
+	"\t-s skips write buffers which are all zero, for zeroed media\n"
+	"\t-e erases write buffers which are all zero instead of writing them\n"
 	"\twbuf is the size in bytes (hex) of write buffer\n"
 	"\t\tand should be padded to erase size for SSDs\n"
 	"\toffs is the output start offset in bytes (hex)\n"
@@ -621,6 +621,25 @@ static int do_usb(struct cmd_tbl *cmdtp, int flag, int argc, char *const argv[])
 		do_usb_start();
 		return 0;
 	}
+#ifdef CONFIG_USB_RESCAN
+	if (strncmp(argv[1], "rescan", 6) == 0) {
+		int ret;
+
+		if (!usb_started) {
+			printf("starting USB...\n");
+			do_usb_start();
+			return 0;
+		}
+		printf("rescanning USB...\n");
+		ret = usb_rescan();
+		if (ret < 0) {
+			printf("USB rescan failed (err=%d)\n", ret);
+			return CMD_RET_FAILURE;
+		}
+		printf("%d port change(s) found\n", ret);
+		return 0;
+	}
+#endif
 	if (strncmp(argv[1], "stop", 4) == 0) {
 		if (argc != 2)
 			console_assign(stdin, "serial");
@@ -698,6 +717,9 @@ U_BOOT_CMD(
 	"USB sub-system",
 	"start - start (scan) USB controller\n"
 	"usb reset - reset (rescan) USB controller\n"
+#ifdef CONFIG_USB_RESCAN
+	"usb rescan - look for devices plugged in or removed since start\n"
+#endif
 	"usb stop [f] - stop USB [f]=force stop\n"
 	"usb tree - show USB device tree\n"
 	"usb info [dev] - show available USB devices\n"
@@ -61,6 +61,9 @@ static struct tag_name {
 	{ BLOBLISTT_U_BOOT_SPL_HANDOFF, "SPL hand-off" },
 	{ BLOBLISTT_VBE, "VBE" },
 	{ BLOBLISTT_U_BOOT_VIDEO, "SPL video handoff" },
+	{ BLOBLISTT_U_BOOT_NAND_BBT, "NAND bad block table" },
+	{ BLOBLISTT_U_BOOT_LOG, "U-Boot binary log" },
+	{ BLOBLISTT_U_BOOT_PERF, "U-Boot performance counters" },
 
 	/* BLOBLISTT_VENDOR_AREA */
 };
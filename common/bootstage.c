@@ -24,6 +24,14 @@ DECLARE_GLOBAL_DATA_PTR;
 
 enum {
 	RECORD_COUNT = CONFIG_VAL(BOOTSTAGE_RECORD_COUNT),
+#if CONFIG_IS_ENABLED(BOOTSTAGE_SPANS)
+	SPAN_COUNT = CONFIG_BOOTSTAGE_SPAN_COUNT,
+#else
+	SPAN_COUNT = 0,
+#endif
+	/* Spans available before relocation, to limit use of malloc_f */
+	SPAN_COUNT_F = SPAN_COUNT < 32 ? SPAN_COUNT : 32,
+	SPAN_NAME_LEN = 20,
 };
 
 struct bootstage_record {
@@ -34,9 +42,49 @@ struct bootstage_record {
 	enum bootstage_id id;
 };
 
+/**
+ * struct bootstage_span - A period of time during boot
+ *
+ * Spans can be nested, e.g. probing a device may involve probing its parent.
+ * The name is copied, since devices may be unbound later.
+ *
+ * @start_us: Start time in microseconds
+ * @end_us: End time in microseconds (invalid while BOOTSTAGE_SPANF_OPEN is set)
+ * @parent: Index of the parent span, or -1 if none
+ * @flags: Flags (enum bootstage_span_flags)
+ * @name: Name of span, truncated if needed
+ */
+struct bootstage_span {
+	u32 start_us;
+	u32 end_us;
+	s16 parent;
+	u16 flags;
+	char name[SPAN_NAME_LEN];
+};
+
+/**
+ * struct bootstage_data - Bootstage information
+ *
+ * @rec_count: Number of records in use
+ * @next_id: Next ID to allocate for BOOTSTAGE_ID_ALLOC
+ * @span: Span table, or NULL if none
+ * @span_max: Number of entries available in @span
+ * @span_count: Number of spans in use
+ * @span_dropped: Number of spans which could not be recorded
+ * @cur_span: Index of the innermost open span, or -1 if none
+ * @span_busy: true while reading the time for a span, since this may probe the
+ *	timer
+ * @record: Records
+ */
 struct bootstage_data {
 	uint rec_count;
 	uint next_id;
+	struct bootstage_span *span;
+	uint span_max;
+	uint span_count;
+	uint span_dropped;
+	int cur_span;
+	bool span_busy;
 	struct bootstage_record record[RECORD_COUNT];
 };
 
@@ -56,6 +104,7 @@ struct bootstage_hdr {
 
 int bootstage_relocate(void *to)
 {
+	struct bootstage_span *span;
 	struct bootstage_data *data;
 	int i;
 	char *ptr;
@@ -64,8 +113,15 @@ int bootstage_relocate(void *to)
 	memcpy(to, gd->bootstage, sizeof(struct bootstage_data));
 	data = gd->bootstage = to;
 
+	/* The span table follows the data, whether or not it was set up */
+	span = (struct bootstage_span *)(data + 1);
+	if (data->span)
+		memcpy(span, data->span, data->span_count * sizeof(*span));
+	data->span = span;
+	data->span_max = SPAN_COUNT;
+
 	/* Figure out where to relocate the strings to */
-	ptr = (char *)(data + 1);
+	ptr = (char *)(span + SPAN_COUNT);
 
 	/*
 	 * Duplicate all strings.  They may point to an old location in the
@@ -220,6 +276,48 @@ uint32_t bootstage_accum(enum bootstage_id id)
 	return duration;
 }
 
+#if CONFIG_IS_ENABLED(BOOTSTAGE_SPANS)
+int bootstage_span_begin(const char *name, uint flags)
+{
+	struct bootstage_data *data = gd->bootstage;
+	struct bootstage_span *span;
+	ulong start_us;
+
+	/* Reading the time may probe the timer, which would come back here */
+	if (!data || data->span_busy)
+		return -EBUSY;
+	if (data->span_count == data->span_max) {
+		data->span_dropped++;
+		return -ENOSPC;
+	}
+	data->span_busy = true;
+	start_us = timer_get_boot_us();
+	data->span_busy = false;
+
+	span = &data->span[data->span_count];
+	strlcpy(span->name, name ?: "?", sizeof(span->name));
+	span->start_us = start_us;
+	span->flags = flags | BOOTSTAGE_SPANF_OPEN;
+	span->parent = data->cur_span;
+	data->cur_span = data->span_count;
+
+	return data->span_count++;
+}
+
+void bootstage_span_end(int id)
+{
+	struct bootstage_data *data = gd->bootstage;
+	struct bootstage_span *span;
+
+	if (!data || id < 0 || id >= data->span_count)
+		return;
+	span = &data->span[id];
+	span->end_us = timer_get_boot_us();
+	span->flags &= ~BOOTSTAGE_SPANF_OPEN;
+	data->cur_span = span->parent;
+}
+#endif
+
 /**
  * Get a record name as a printable string
  *
@@ -260,6 +358,56 @@ static uint32_t print_time_record(struct bootstage_record *rec, uint32_t prev)
 }
 
 #ifdef CONFIG_OF_LIBFDT
+/**
+ * add_spans_devicetree() - Add all bootstage spans to a device tree
+ *
+ * Each span has a 'name' and a 'start' time. It also has a 'duration' unless it
+ * is still open, a 'parent' if it is nested and a 'device' property if it
+ * covers probing a device.
+ *
+ * @blob: Device tree blob
+ * @bootstage: Offset of the bootstage node
+ */
+static void add_spans_devicetree(struct fdt_header *blob, int bootstage)
+{
+	struct bootstage_data *data = gd->bootstage;
+	int parent;
+	int i;
+
+	/*
+	 * There may be a lot of spans, so stop quietly if the device tree runs
+	 * out of space
+	 */
+	parent = fdt_add_subnode(blob, bootstage, "spans");
+	if (parent < 0)
+		return;
+
+	/* As with records, add them in reverse order */
+	for (i = data->span_count - 1; i >= 0; i--) {
+		struct bootstage_span *span = &data->span[i];
+		int node, ret;
+
+		node = fdt_add_subnode(blob, parent, simple_itoa(i));
+		if (node < 0)
+			break;
+		ret = fdt_setprop_string(blob, node, "name", span->name);
+		if (!ret)
+			ret = fdt_setprop_u32(blob, node, "start", span->start_us);
+		if (!ret && !(span->flags & BOOTSTAGE_SPANF_OPEN))
+			ret = fdt_setprop_u32(blob, node, "duration",
+					      span->end_us - span->start_us);
+		if (!ret && span->parent >= 0)
+			ret = fdt_setprop_u32(blob, node, "parent",
+					      span->parent);
+		if (!ret && (span->flags & BOOTSTAGE_SPANF_PROBE))
+			ret = fdt_setprop_empty(blob, node, "device");
+		if (ret) {
+			log_debug("Out of space for spans\n");
+			break;
+		}
+	}
+}
+
 /**
  * Add all bootstage timings to a device tree.
  *
@@ -312,6 +460,9 @@ static int add_bootstages_devicetree(struct fdt_header *blob)
 			return -EINVAL;
 	}
 
+	if (data->span_count)
+		add_spans_devicetree(blob, bootstage);
+
 	return 0;
 }
 
@@ -324,6 +475,33 @@ int bootstage_fdt_add_report(void)
 }
 #endif
 
+static void print_spans(struct bootstage_data *data)
+{
+	struct bootstage_span *span;
+	int i;
+
+	printf("\nSpans (%u):\n", data->span_count);
+	printf("%11s%11s  %s\n", "Start", "Duration", "Name");
+	for (i = 0, span = data->span; i < data->span_count; i++, span++) {
+		int depth, parent;
+
+		/* A parent always comes before its children */
+		for (depth = 0, parent = span->parent; parent >= 0; depth++)
+			parent = data->span[parent].parent;
+		print_grouped_ull(span->start_us, BOOTSTAGE_DIGITS);
+		if (span->flags & BOOTSTAGE_SPANF_OPEN)
+			printf("%11s", "-");
+		else
+			print_grouped_ull(span->end_us - span->start_us,
+					  BOOTSTAGE_DIGITS);
+		printf("  %*s%s\n", depth * 2, "", span->name);
+	}
+	if (data->span_dropped)
+		printf("Overflowed span table by %u entries\n"
+		       "Please increase CONFIG_BOOTSTAGE_SPAN_COUNT\n",
+		       data->span_dropped);
+}
+
 void bootstage_report(void)
 {
 	struct bootstage_data *data = gd->bootstage;
@@ -351,6 +529,93 @@ void bootstage_report(void)
 		if (rec->start_us)
 			prev = print_time_record(rec, -1);
 	}
+
+	if (data->span_count)
+		print_spans(data);
+}
+
+/**
+ * trace_printf() - Add formatted text to a trace buffer
+ *
+ * Text is written if there is space. The pointer is always advanced, so that
+ * the total size needed can be determined.
+ *
+ * @ptrp: Pointer to the current position, updated by this function
+ * @end: Pointer to end of buffer
+ * @fmt: printf() format string
+ */
+static void trace_printf(char **ptrp, char *end, const char *fmt, ...)
+{
+	va_list args;
+	int len;
+
+	va_start(args, fmt);
+	len = vsnprintf(*ptrp, *ptrp < end ? end - *ptrp : 0, fmt, args);
+	va_end(args);
+	*ptrp += len;
+}
+
+/* Add a JSON string, with quoting */
+static void trace_name(char **ptrp, char *end, const char *name)
+{
+	trace_printf(ptrp, end, "{\"name\":\"");
+	for (; *name; name++) {
+		if (*name == '"' || *name == '\\')
+			trace_printf(ptrp, end, "\\%c", *name);
+		else if ((uchar)*name < ' ')
+			trace_printf(ptrp, end, "\\u%04x", *name);
+		else
+			trace_printf(ptrp, end, "%c", *name);
+	}
+	trace_printf(ptrp, end, "\",\"pid\":1,\"tid\":1,");
+}
+
+int bootstage_trace_export(char *buf, int size)
+{
+	struct bootstage_data *data = gd->bootstage;
+	char *ptr = buf, *end = buf + size;
+	struct bootstage_record *rec;
+	struct bootstage_span *span;
+	char name[20];
+	ulong now;
+	int i;
+
+	now = timer_get_boot_us();
+	trace_printf(&ptr, end, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	trace_printf(&ptr, end,
+		     "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"U-Boot\"}}");
+
+	/* Marks and accumulated times are shown as instant events */
+	for (i = 0, rec = data->record; i < data->rec_count; i++, rec++) {
+		trace_printf(&ptr, end, ",\n");
+		trace_name(&ptr, end,
+			   get_record_name(name, sizeof(name), rec));
+		if (rec->start_us)
+			trace_printf(&ptr, end,
+				     "\"cat\":\"accum\",\"ph\":\"i\",\"s\":\"g\",\"ts\":%u,\"args\":{\"total_us\":%lu}}",
+				     rec->start_us, rec->time_us);
+		else
+			trace_printf(&ptr, end,
+				     "\"cat\":\"mark\",\"ph\":\"i\",\"s\":\"g\",\"ts\":%lu}",
+				     rec->time_us);
+	}
+
+	/* Spans are complete events; any which are still open end now */
+	for (i = 0, span = data->span; i < data->span_count; i++, span++) {
+		u32 end_us = span->flags & BOOTSTAGE_SPANF_OPEN ? now :
+			span->end_us;
+
+		trace_printf(&ptr, end, ",\n");
+		trace_name(&ptr, end, span->name);
+		trace_printf(&ptr, end,
+			     "\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%u,\"dur\":%u,\"args\":{\"id\":%d,\"parent\":%d}}",
+			     span->flags & BOOTSTAGE_SPANF_PROBE ? "probe" :
+			     "span", span->start_us, end_us - span->start_us, i,
+			     span->parent);
+	}
+	trace_printf(&ptr, end, "\n]}\n");
+
+	return ptr - buf;
 }
 
 /**
@@ -517,6 +782,7 @@ int bootstage_get_size(bool add_strings)
 	int size;
 
 	size = sizeof(struct bootstage_data);
+	size += SPAN_COUNT * sizeof(struct bootstage_span);
 	if (add_strings) {
 		struct bootstage_data *data = gd->bootstage;
 		struct bootstage_record *rec;
@@ -539,6 +805,18 @@ int bootstage_init(bool first)
 		return -ENOMEM;
 	data = gd->bootstage;
 	memset(data, '\0', size);
+	data->cur_span = -1;
+
+	/*
+	 * Only a few spans are available until relocation, when the full table
+	 * is set up. They are optional, so don't fail if there is no space.
+	 */
+	if (SPAN_COUNT_F) {
+		size = SPAN_COUNT_F * sizeof(struct bootstage_span);
+		data->span = malloc(size);
+		if (data->span)
+			data->span_max = SPAN_COUNT_F;
+	}
 	if (first) {
 		data->next_id = BOOTSTAGE_ID_USER;
 		bootstage_add_record(BOOTSTAGE_ID_AWAKE, "reset", 0, 0);
@@ -17,6 +17,7 @@
 
 #include <malloc.h>
 #include <mapmem.h>
+#include <perf.h>
 #include <string.h>
 #include <asm/io.h>
 #include <valgrind/memcheck.h>
@@ -39,6 +40,9 @@ DECLARE_GLOBAL_DATA_PTR;
  #undef MALLOC_ZERO
 static inline void MALLOC_ZERO(void *p, size_t sz) { memset(p, 0, sz); }
 static inline void MALLOC_COPY(void *dest, const void *src, size_t sz) { memcpy(dest, src, sz); }
+#elif CONFIG_IS_ENABLED(SYS_MALLOC_SLAB)
+ #define MALLOC_SLAB
+ #define STATIC_IF_MCHECK static
 #else
  #define STATIC_IF_MCHECK
  #define mALLOc_impl mALLOc
@@ -1279,6 +1283,7 @@ Void_t* mALLOc_impl(bytes) size_t bytes;
   if (bytes > CONFIG_SYS_MALLOC_LEN || (long)bytes < 0)
      return NULL;
 
+  perf_add(PERF_MALLOC, bytes);
   nb = request2size(bytes);  /* padded request size; */
 
   /* Check for exact match in a bin */
@@ -1549,6 +1554,7 @@ void fREe_impl(mem) Void_t* mem;
   if (mem == NULL)                              /* free(0) has no effect */
     return;
 
+  perf_add(PERF_FREE, 0);
   p = mem2chunk(mem);
   hd = p->size;
 
@@ -2242,6 +2248,75 @@ void mcheck_check_all(void) { mcheck_pedantic_check(); }
 
 enum mcheck_status mprobe(void *__ptr) { return mcheck_mprobe(__ptr); }
 // mcheck API }
+#elif defined(MALLOC_SLAB)
+ #include "malloc_slab.inc.h"
+
+Void_t *mALLOc(size_t bytes)
+{
+	void *p;
+
+	if (bytes <= SLAB_MAX_SIZE && slab_ready()) {
+		p = slab_alloc(bytes);
+		if (p)
+			return p;
+	}
+
+	return mALLOc_impl(bytes);
+}
+
+void fREe(Void_t *mem)
+{
+	if (slab_owns(mem))
+		slab_free(mem);
+	else
+		fREe_impl(mem);
+}
+
+Void_t *rEALLOc(Void_t *oldmem, size_t bytes)
+{
+	size_t size;
+	void *p;
+
+	if (!slab_owns(oldmem))
+		return rEALLOc_impl(oldmem, bytes);
+
+	if (!bytes) {
+		slab_free(oldmem);
+		return NULL;
+	}
+	size = slab_usable_size(oldmem);
+	if (bytes <= size)
+		return oldmem;
+	p = mALLOc(bytes);
+	if (!p)
+		return NULL;
+	memcpy(p, oldmem, size);
+	slab_free(oldmem);
+
+	return p;
+}
+
+/* Aligned requests are left to dlmalloc */
+Void_t *mEMALIGn(size_t alignment, size_t bytes)
+{
+	return mEMALIGn_impl(alignment, bytes);
+}
+
+Void_t *cALLOc(size_t n, size_t elem_size)
+{
+	size_t sz = n * elem_size;
+	void *p;
+
+	if (sz <= SLAB_MAX_SIZE && slab_ready()) {
+		p = slab_alloc(sz);
+		if (p) {
+			memset(p, '\0', sz);
+			return p;
+		}
+	}
+
+	return cALLOc_impl(n, elem_size);
+}
 #endif
 
 /*
@@ -2343,6 +2418,10 @@ size_t malloc_usable_size(mem) Void_t* mem;
   mchunkptr p;
   if (mem == NULL)
     return 0;
+#ifdef MALLOC_SLAB
+  else if (slab_owns(mem))
+    return slab_usable_size(mem);
+#endif
   else
   {
     p = mem2chunk(mem);
@@ -2394,7 +2473,10 @@ static void malloc_update_mallinfo(void)
   current_mallinfo.hblks = n_mmaps;
   current_mallinfo.hblkhd = mmapped_mem;
   current_mallinfo.keepcost = chunksize(top);
-
+#ifdef MALLOC_SLAB
+  /* Count slab objects as in use, but not the free space in slab pages */
+  current_mallinfo.uordblks -= slab.page_bytes - slab.obj_bytes;
+#endif
 }
 #endif	/* DEBUG */
 
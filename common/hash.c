@@ -29,6 +29,7 @@
 
 #include <hash.h>
 #include <image.h>
+#include <perf.h>
 #include <u-boot/crc.h>
 #include <u-boot/sha1.h>
 #include <u-boot/sha256.h>
@@ -398,6 +399,7 @@ int hash_block(const char *algo_name, const void *data, unsigned int len,
 	       uint8_t *output, int *output_size)
 {
 	struct hash_algo *algo;
+	uint64_t start;
 	int ret;
 
 	ret = hash_lookup_algo(algo_name, &algo);
@@ -411,7 +413,9 @@ int hash_block(const char *algo_name, const void *data, unsigned int len,
 	}
 	if (output_size)
 		*output_size = algo->digest_size;
+	start = perf_begin();
 	algo->hash_func_ws(data, len, output, algo->chunk_size);
+	perf_end(PERF_HASH, start, len);
 
 	return 0;
 }
@@ -220,6 +220,7 @@ static int log_dispatch(struct log_rec *rec, const char *fmt, va_list args)
 {
 	struct log_device *ldev;
 	char buf[CONFIG_SYS_CBSIZE];
+	bool raw = false;
 
 	/*
 	 * When a log driver writes messages (e.g. via the network stack) this
@@ -231,10 +232,15 @@ static int log_dispatch(struct log_rec *rec, const char *fmt, va_list args)
 
 	/* Emit message */
 	gd->processing_msg = true;
+	rec->fmt = fmt;
+	va_copy(rec->args, args);
 	list_for_each_entry(ldev, &gd->log_head, sibling_node) {
 		if ((ldev->flags & LOGDF_ENABLE) &&
 		    log_passes_filters(ldev, rec)) {
-			if (!rec->msg) {
+			/* Raw drivers format the message later, if at all */
+			if (ldev->flags & LOGDF_RAW) {
+				raw = true;
+			} else if (!rec->msg) {
 				int len;
 
 				len = vsnprintf(buf, sizeof(buf), fmt, args);
@@ -244,6 +250,12 @@ static int log_dispatch(struct log_rec *rec, const char *fmt, va_list args)
 			ldev->drv->emit(ldev, rec);
 		}
 	}
+	va_end(rec->args);
+	if (raw && !rec->msg) {
+		int len = strlen(fmt);
+
+		gd->log_cont = len && fmt[len - 1] != '\n';
+	}
 	gd->processing_msg = false;
 	return 0;
 }
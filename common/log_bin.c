@@ -0,0 +1,661 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Binary log driver, which records log messages without formatting them
+ *
+ * Each record holds the format string and a copy of its arguments. The message
+ * is only formatted when the log is dumped, so logging at a high level costs
+ * little more than copying the arguments.
+ */
+
+#include <bloblist.h>
+#include <errno.h>
+#include <log.h>
+#include <malloc.h>
+#include <time.h>
+#include <asm/global_data.h>
+#include <linux/ctype.h>
+#include <linux/math64.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+#define LOG_BIN_MAGIC		0x4c42494e	/* "LBIN" */
+
+/* Maximum number of bytes of arguments (or text) for a single record */
+#define LOG_BIN_MAX_ARGS	256
+
+/* Maximum length of a single conversion specification, e.g. "%-08llx" */
+#define LOG_BIN_MAX_SPEC	32
+
+/**
+ * enum log_bin_flags - Flags for a binary record
+ *
+ * These share the u8 with enum log_rec_flags, so start at the top
+ *
+ * @LOGBF_TEXT: The record holds the formatted message, not arguments
+ * @LOGBF_PRE_RELOC: The record was written before relocation, so its pointers
+ *	must be adjusted by gd->reloc_off
+ * @LOGBF_PAD: The record is padding at the end of the ring
+ */
+enum log_bin_flags {
+	LOGBF_TEXT	= BIT(5),
+	LOGBF_PRE_RELOC	= BIT(6),
+	LOGBF_PAD	= BIT(7),
+};
+
+/**
+ * enum log_bin_arg_t - Type of an argument, according to the format string
+ *
+ * @LOGBA_NONE: No argument (e.g. '%%')
+ * @LOGBA_INT: int, or anything promoted to it
+ * @LOGBA_LONG: long, size_t or ptrdiff_t
+ * @LOGBA_LLONG: long long
+ * @LOGBA_PTR: pointer
+ * @LOGBA_STR: string, which is copied into the record
+ */
+enum log_bin_arg_t {
+	LOGBA_NONE,
+	LOGBA_INT,
+	LOGBA_LONG,
+	LOGBA_LLONG,
+	LOGBA_PTR,
+	LOGBA_STR,
+};
+
+/**
+ * struct log_bin_spec - A conversion specification in a format string
+ *
+ * @start: Pointer to the '%'
+ * @end: Pointer to the character after the conversion character
+ * @type: Type of argument
+ * @star_width: true if the width is given by an argument
+ * @star_prec: true if the precision is given by an argument
+ * @prec: Precision, or -1 if none or given by an argument
+ */
+struct log_bin_spec {
+	const char *start;
+	const char *end;
+	enum log_bin_arg_t type;
+	bool star_width;
+	bool star_prec;
+	int prec;
+};
+
+/**
+ * struct log_bin_rec - A record in the binary log
+ *
+ * @size: Size of the record in bytes, including this header
+ * @level: Log level
+ * @flags: Flags (enum log_rec_flags and enum log_bin_flags)
+ * @cat: Log category
+ * @line: Line number
+ * @time_us: Timestamp in microseconds
+ * @file: Source file (not copied)
+ * @func: Function name (not copied)
+ * @fmt: Format string (not copied)
+ * @args: Arguments for @fmt, or the message with %LOGBF_TEXT
+ */
+struct log_bin_rec {
+	u16 size;
+	u8 level;
+	u8 flags;
+	u16 cat;
+	u16 line;
+	u64 time_us;
+	const char *file;
+	const char *func;
+	const char *fmt;
+	u8 args[];
+};
+
+/**
+ * struct log_bin_hdr - Header for the binary log
+ *
+ * The records are held in a ring which follows this header. A record never
+ * wraps around the end of the ring; padding is added instead.
+ *
+ * @magic: LOG_BIN_MAGIC
+ * @size: Size of the ring in bytes
+ * @head: Offset of the oldest record
+ * @used: Number of bytes in use, including padding
+ * @count: Number of records in the ring
+ * @dropped: Number of records dropped to make space
+ */
+struct log_bin_hdr {
+	u32 magic;
+	u32 size;
+	u32 head;
+	u32 used;
+	u32 count;
+	u32 dropped;
+	u8 data[] __aligned(8);
+};
+
+/**
+ * log_bin_get() - Get the binary log, setting it up if needed
+ *
+ * Before relocation the log can only be held in the bloblist. Afterwards the
+ * pointer is cached.
+ *
+ * Return: pointer to log, or NULL if none
+ */
+static struct log_bin_hdr *log_bin_get(void)
+{
+	static struct log_bin_hdr *log_bin;
+	struct log_bin_hdr *hdr = log_bin;
+	int size;
+
+	if (hdr)
+		return hdr;
+
+	size = sizeof(*hdr) + CONFIG_LOG_BINARY_SIZE;
+	if (IS_ENABLED(CONFIG_LOG_BINARY_BLOBLIST))
+		hdr = bloblist_ensure(BLOBLISTT_U_BOOT_LOG, size);
+	else if (gd->flags & GD_FLG_RELOC)
+		hdr = malloc(size);
+	if (!hdr)
+		return NULL;
+	if (hdr->magic != LOG_BIN_MAGIC ||
+	    hdr->size != CONFIG_LOG_BINARY_SIZE) {
+		memset(hdr, '\0', sizeof(*hdr));
+		hdr->magic = LOG_BIN_MAGIC;
+		hdr->size = CONFIG_LOG_BINARY_SIZE;
+	}
+	if (gd->flags & GD_FLG_RELOC)
+		log_bin = hdr;
+
+	return hdr;
+}
+
+/**
+ * log_bin_parse() - Find the next conversion specification in a format string
+ *
+ * @fmtp: Pointer to the format string; updated to point after the conversion
+ *	specification, or to the terminator if there are none left
+ * @spec: Returns information about the specification
+ * Return: 1 if a specification was found, 0 if there are no more,
+ *	-EOPNOTSUPP if it cannot be handled
+ */
+static int log_bin_parse(const char **fmtp, struct log_bin_spec *spec)
+{
+	enum log_bin_arg_t type = LOGBA_INT;
+	const char *p;
+
+	p = strchr(*fmtp, '%');
+	if (!p) {
+		*fmtp += strlen(*fmtp);
+		return 0;
+	}
+	memset(spec, '\0', sizeof(*spec));
+	spec->start = p++;
+	spec->prec = -1;
+	if (*p == '%') {
+		spec->type = LOGBA_NONE;
+		spec->end = p + 1;
+		*fmtp = spec->end;
+		return 1;
+	}
+
+	while (*p && strchr("-+ #0", *p))
+		p++;
+	if (*p == '*') {
+		spec->star_width = true;
+		p++;
+	}
+	while (isdigit(*p))
+		p++;
+	if (*p == '.') {
+		p++;
+		if (*p == '*') {
+			spec->star_prec = true;
+			p++;
+		} else {
+			spec->prec = 0;
+			while (isdigit(*p))
+				spec->prec = spec->prec * 10 + *p++ - '0';
+		}
+	}
+
+	switch (*p) {
+	case 'h':
+		if (*++p == 'h')
+			p++;
+		break;
+	case 'l':
+		type = LOGBA_LONG;
+		if (*++p == 'l') {
+			type = LOGBA_LLONG;
+			p++;
+		}
+		break;
+	case 'L':
+	case 'q':
+		type = LOGBA_LLONG;
+		p++;
+		break;
+	case 'z':
+	case 'Z':
+	case 't':
+		type = LOGBA_LONG;
+		p++;
+		break;
+	}
+
+	switch (*p) {
+	case 'd':
+	case 'i':
+	case 'u':
+	case 'o':
+	case 'x':
+	case 'X':
+		break;
+	case 'c':
+		type = LOGBA_INT;
+		break;
+	case 's':
+		if (type != LOGBA_INT)
+			return -EOPNOTSUPP;
+		type = LOGBA_STR;
+		break;
+	case 'p':
+		/* Extensions such as %pU dereference the pointer */
+		if (isalnum(p[1]))
+			return -EOPNOTSUPP;
+		type = LOGBA_PTR;
+		break;
+	default:
+		return -EOPNOTSUPP;
+	}
+	spec->type = type;
+	spec->end = p + 1;
+	*fmtp = spec->end;
+
+	return 1;
+}
+
+static int log_bin_put(u8 **outp, const u8 *end, const void *val, int len)
+{
+	if (*outp + len > end)
+		return -ENOSPC;
+	memcpy(*outp, val, len);
+	*outp += len;
+
+	return 0;
+}
+
+/**
+ * log_bin_capture() - Copy the arguments of a log record
+ *
+ * @fmt: Format string
+ * @args: Arguments to copy
+ * @buf: Buffer for the arguments
+ * @size: Size of @buf
+ * Return: number of bytes used, -EOPNOTSUPP if the format string cannot be
+ *	handled, -ENOSPC if there is not enough space
+ */
+static int log_bin_capture(const char *fmt, va_list args, u8 *buf, int size)
+{
+	const u8 *end = buf + size;
+	struct log_bin_spec spec;
+	u8 *out = buf;
+	int ret;
+
+	while ((ret = log_bin_parse(&fmt, &spec)) > 0) {
+		int prec = spec.prec;
+
+		ret = 0;
+		if (spec.star_width) {
+			int val = va_arg(args, int);
+
+			ret = log_bin_put(&out, end, &val, sizeof(val));
+			if (ret)
+				return ret;
+		}
+		if (spec.star_prec) {
+			prec = va_arg(args, int);
+			ret = log_bin_put(&out, end, &prec, sizeof(prec));
+			if (ret)
+				return ret;
+		}
+		switch (spec.type) {
+		case LOGBA_NONE:
+			break;
+		case LOGBA_INT: {
+			int val = va_arg(args, int);
+
+			ret = log_bin_put(&out, end, &val, sizeof(val));
+			break;
+		}
+		case LOGBA_LONG: {
+			long val = va_arg(args, long);
+
+			ret = log_bin_put(&out, end, &val, sizeof(val));
+			break;
+		}
+		case LOGBA_LLONG: {
+			long long val = va_arg(args, long long);
+
+			ret = log_bin_put(&out, end, &val, sizeof(val));
+			break;
+		}
+		case LOGBA_PTR: {
+			void *val = va_arg(args, void *);
+
+			ret = log_bin_put(&out, end, &val, sizeof(val));
+			break;
+		}
+		case LOGBA_STR: {
+			const char *str = va_arg(args, const char *);
+			int len;
+
+			/* The string may be on the stack, so copy it */
+			if (!str)
+				str = "<NULL>";
+			len = prec >= 0 ? strnlen(str, prec) : strlen(str);
+			ret = log_bin_put(&out, end, str, len);
+			if (!ret)
+				ret = log_bin_put(&out, end, "", 1);
+			break;
+		}
+		}
+		if (ret)
+			return ret;
+	}
+	if (ret)
+		return ret;
+
+	return out - buf;
+}
+
+static void log_bin_add(char **outp, char *end, int len)
+{
+	/* snprintf() returns the length it would have used */
+	*outp += min(len, (int)(end - *outp) - 1);
+}
+
+static const void *log_bin_get_arg(const u8 **argsp, int size)
+{
+	const void *ptr = *argsp;
+
+	*argsp += size;
+
+	return ptr;
+}
+
+/**
+ * log_bin_format() - Format the message for a binary record
+ *
+ * @brec: Record to format
+ * @fmt: Format string, adjusted for relocation if needed
+ * @buf: Buffer for the message
+ * @size: Size of @buf, which must be at least 1
+ */
+static void log_bin_format(const struct log_bin_rec *brec, const char *fmt,
+			   char *buf, int size)
+{
+	const u8 *args = brec->args;
+	struct log_bin_spec spec;
+	char *end = buf + size;
+	char *out = buf;
+	const char *lit;
+
+	if (brec->flags & LOGBF_TEXT) {
+		strlcpy(buf, (const char *)brec->args, size);
+		return;
+	}
+
+	*out = '\0';
+	lit = fmt;
+	while (log_bin_parse(&fmt, &spec) > 0) {
+		char sfmt[LOG_BIN_MAX_SPEC];
+		char *s = sfmt;
+		const char *p;
+		int val;
+
+		log_bin_add(&out, end, snprintf(out, end - out, "%.*s",
+						(int)(spec.start - lit), lit));
+		lit = spec.end;
+
+		/* Put any '*' values directly into the specification */
+		for (p = spec.start; p < spec.end && s < sfmt + 20; p++) {
+			if (*p == '*') {
+				memcpy(&val, log_bin_get_arg(&args, sizeof(val)),
+				       sizeof(val));
+				s += snprintf(s, 12, "%d", val);
+			} else {
+				*s++ = *p;
+			}
+		}
+		*s = '\0';
+
+		switch (spec.type) {
+		case LOGBA_NONE:
+			log_bin_add(&out, end, snprintf(out, end - out, "%%"));
+			break;
+		case LOGBA_INT:
+			memcpy(&val, log_bin_get_arg(&args, sizeof(val)),
+			       sizeof(val));
+			log_bin_add(&out, end, snprintf(out, end - out, sfmt,
+							val));
+			break;
+		case LOGBA_LONG: {
+			long lval;
+
+			memcpy(&lval, log_bin_get_arg(&args, sizeof(lval)),
+			       sizeof(lval));
+			log_bin_add(&out, end, snprintf(out, end - out, sfmt,
+							lval));
+			break;
+		}
+		case LOGBA_LLONG: {
+			long long llval;
+
+			memcpy(&llval, log_bin_get_arg(&args, sizeof(llval)),
+			       sizeof(llval));
+			log_bin_add(&out, end, snprintf(out, end - out, sfmt,
+							llval));
+			break;
+		}
+		case LOGBA_PTR: {
+			void *ptr;
+
+			memcpy(&ptr, log_bin_get_arg(&args, sizeof(ptr)),
+			       sizeof(ptr));
+			log_bin_add(&out, end, snprintf(out, end - out, sfmt,
+							ptr));
+			break;
+		}
+		case LOGBA_STR: {
+			const char *str = (const char *)args;
+
+			args += strlen(str) + 1;
+			log_bin_add(&out, end, snprintf(out, end - out, sfmt,
+							str));
+			break;
+		}
+		}
+	}
+	snprintf(out, end - out, "%s", lit);
+}
+
+/* Drop the oldest record */
+static void log_bin_drop(struct log_bin_hdr *hdr)
+{
+	struct log_bin_rec *brec = (void *)hdr->data + hdr->head;
+
+	hdr->head += brec->size;
+	if (hdr->head == hdr->size)
+		hdr->head = 0;
+	hdr->used -= brec->size;
+	if (!(brec->flags & LOGBF_PAD)) {
+		hdr->count--;
+		hdr->dropped++;
+	}
+}
+
+/**
+ * log_bin_alloc() - Make space for a new record, dropping old ones if needed
+ *
+ * @hdr: Binary log
+ * @size: Size of record, a multiple of 8 bytes
+ * Return: pointer to the space for the record
+ */
+static struct log_bin_rec *log_bin_alloc(struct log_bin_hdr *hdr, uint size)
+{
+	struct log_bin_rec *brec;
+	uint tail;
+
+	if (!hdr->used)
+		hdr->head = 0;
+	tail = (hdr->head + hdr->used) % hdr->size;
+
+	/* Pad out the end of the ring so the record does not wrap */
+	if (tail + size > hdr->size) {
+		uint pad = hdr->size - tail;
+
+		while (hdr->size - hdr->used < pad)
+			log_bin_drop(hdr);
+		brec = (void *)hdr->data + tail;
+		brec->size = pad;
+		brec->flags = LOGBF_PAD;
+		hdr->used += pad;
+		tail = 0;
+	}
+	while (hdr->size - hdr->used < size)
+		log_bin_drop(hdr);
+	hdr->used += size;
+	hdr->count++;
+	brec = (void *)hdr->data + tail;
+	brec->size = size;
+
+	return brec;
+}
+
+static int log_bin_emit(struct log_device *ldev, struct log_rec *rec)
+{
+	struct log_bin_hdr *hdr = log_bin_get();
+	u8 args[LOG_BIN_MAX_ARGS];
+	struct log_bin_rec *brec;
+	u8 flags = rec->flags;
+	va_list copy;
+	int len;
+
+	if (!hdr)
+		return -ENOSPC;
+
+	/*
+	 * If another driver has already formatted the message, just copy it.
+	 * Also fall back to text if the arguments cannot be copied.
+	 */
+	len = -EINVAL;
+	if (!rec->msg) {
+		va_copy(copy, rec->args);
+		len = log_bin_capture(rec->fmt, copy, args, sizeof(args));
+		va_end(copy);
+	}
+	if (len < 0) {
+		flags |= LOGBF_TEXT;
+		if (rec->msg) {
+			strlcpy((char *)args, rec->msg, sizeof(args));
+		} else {
+			va_copy(copy, rec->args);
+			vsnprintf((char *)args, sizeof(args), rec->fmt, copy);
+			va_end(copy);
+		}
+		len = strlen((char *)args) + 1;
+	}
+	if (!(gd->flags & GD_FLG_RELOC))
+		flags |= LOGBF_PRE_RELOC;
+
+	brec = log_bin_alloc(hdr, ALIGN(sizeof(*brec) + len, 8));
+	brec->level = rec->level;
+	brec->flags = flags;
+	brec->cat = rec->cat;
+	brec->line = rec->line;
+	brec->time_us = timer_get_us();
+	brec->file = rec->file;
+	brec->func = rec->func;
+	brec->fmt = rec->fmt;
+	memcpy(brec->args, args, len);
+
+	return 0;
+}
+
+/* Convert a pointer recorded before relocation so that it can be used now */
+static const char *log_bin_ptr(const struct log_bin_rec *brec, const char *ptr)
+{
+	if (ptr && (brec->flags & LOGBF_PRE_RELOC) &&
+	    (gd->flags & GD_FLG_RELOC))
+		return ptr + gd->reloc_off;
+
+	return ptr;
+}
+
+int log_bin_dump(void)
+{
+	struct log_bin_hdr *hdr = log_bin_get();
+	struct log_device *ldev;
+	char buf[CONFIG_SYS_CBSIZE];
+	uint pos, done;
+	int count = 0;
+
+	if (!hdr)
+		return -ENOENT;
+	ldev = log_device_find_by_name("console");
+	if (hdr->dropped)
+		printf("(%u records dropped)\n", hdr->dropped);
+	for (pos = hdr->head, done = 0; done < hdr->used;) {
+		struct log_bin_rec *brec = (void *)hdr->data + pos;
+		struct log_rec rec;
+
+		if (!(brec->flags & LOGBF_PAD)) {
+			memset(&rec, '\0', sizeof(rec));
+			rec.cat = brec->cat;
+			rec.level = brec->level;
+			rec.line = brec->line;
+			rec.flags = brec->flags & ~(LOGBF_TEXT |
+						    LOGBF_PRE_RELOC);
+			rec.file = log_bin_ptr(brec, brec->file);
+			rec.func = log_bin_ptr(brec, brec->func);
+			rec.fmt = log_bin_ptr(brec, brec->fmt);
+			log_bin_format(brec, rec.fmt, buf, sizeof(buf));
+			rec.msg = buf;
+
+			if (!(rec.flags & LOGRECF_CONT)) {
+				u32 us;
+				u64 secs;
+
+				secs = div_u64_rem(brec->time_us, 1000000, &us);
+				printf("[%5llu.%06u] ", secs, us);
+			}
+			if (ldev)
+				ldev->drv->emit(ldev, &rec);
+			else
+				puts(buf);
+			count++;
+		}
+		done += brec->size;
+		pos += brec->size;
+		if (pos == hdr->size)
+			pos = 0;
+	}
+
+	return count;
+}
+
+void log_bin_reset(void)
+{
+	struct log_bin_hdr *hdr = log_bin_get();
+
+	if (hdr) {
+		hdr->head = 0;
+		hdr->used = 0;
+		hdr->count = 0;
+		hdr->dropped = 0;
+	}
+}
+
+LOG_DRIVER(binary) = {
+	.name	= "binary",
+	.emit	= log_bin_emit,
+	.flags	= LOGDF_ENABLE | LOGDF_RAW,
+};
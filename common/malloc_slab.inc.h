@@ -0,0 +1,268 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Slab front-end for small heap allocations
+ *
+ * This is included by dlmalloc.c, since it obtains its pages directly from
+ * the dlmalloc internals, bypassing the public entry points which call into
+ * the slab.
+ *
+ * Each pool (struct slab_cache) holds objects of one size, in 4KiB pages
+ * allocated with memalign(). A page starts with a struct slab_page and is
+ * followed by the objects. Free objects are kept on a list within each page,
+ * so the page holding an object is found by rounding its address down. A
+ * bitmap with one bit per page of the heap records which pages belong to the
+ * slab, so that free() can tell slab objects from dlmalloc chunks.
+ */
+
+#include <slab.h>
+#include <linux/bitops.h>
+#include <linux/kernel.h>
+
+enum {
+	SLAB_ALIGN	= 16,
+	SLAB_POOL_MAX	= SLAB_PAGE_SIZE / 8,	/* largest typed-pool object */
+};
+
+/**
+ * struct slab_page - Header at the start of each slab page
+ *
+ * @node: Node in the pool's list of partial pages, if any objects are free
+ * @cache: Pool which owns this page
+ * @free: First free object, each free object pointing to the next
+ * @inuse: Number of objects allocated
+ * @unused: Index of the first object which has never been allocated
+ * @total: Number of objects in the page
+ */
+struct slab_page {
+	struct list_head node;
+	struct slab_cache *cache;
+	void *free;
+	uint inuse;
+	uint unused;
+	uint total;
+};
+
+#define SLAB_HDR_SIZE	ALIGN(sizeof(struct slab_page), SLAB_ALIGN)
+
+#define SLAB_CLASS(_size)	{ .name = "slab-" #_size, .size = _size }
+
+static struct slab_cache slab_class[] = {
+	SLAB_CLASS(16),
+	SLAB_CLASS(32),
+	SLAB_CLASS(48),
+	SLAB_CLASS(64),
+	SLAB_CLASS(96),
+	SLAB_CLASS(128),
+	SLAB_CLASS(192),
+	SLAB_CLASS(256),
+};
+
+/* Index into slab_class[] for each request size, in units of SLAB_ALIGN */
+static const u8 slab_class_idx[SLAB_MAX_SIZE / SLAB_ALIGN + 1] = {
+	0, 0, 1, 2, 3, 4, 4, 5, 5, 6, 6, 6, 6, 7, 7, 7, 7,
+};
+
+/**
+ * struct slab_info - Overall state of the slab
+ *
+ * @caches: List of pools which have been used (struct slab_cache)
+ * @map: Bitmap of the heap pages which are slab pages, NULL until the first
+ *	slab page is allocated
+ * @base: Address of the first page covered by @map
+ * @npages: Number of pages covered by @map
+ * @page_bytes: Heap space taken by slab pages, including dlmalloc overhead
+ * @obj_bytes: Space taken by allocated slab objects
+ */
+static struct slab_info {
+	struct list_head caches;
+	ulong *map;
+	ulong base;
+	ulong npages;
+	ulong page_bytes;
+	ulong obj_bytes;
+} slab;
+
+/* The slab is not used before relocation, nor when testing malloc failures */
+static bool slab_ready(void)
+{
+	if (!(gd->flags & GD_FLG_FULL_MALLOC_INIT) || !mem_malloc_start)
+		return false;
+
+	return !CONFIG_IS_ENABLED(UNIT_TEST) || !malloc_testing;
+}
+
+static ulong slab_page_idx(const void *ptr)
+{
+	return ((ulong)ptr - slab.base) / SLAB_PAGE_SIZE;
+}
+
+static struct slab_page *slab_page_of(const void *ptr)
+{
+	return (struct slab_page *)ALIGN_DOWN((ulong)ptr, SLAB_PAGE_SIZE);
+}
+
+bool slab_owns(const void *ptr)
+{
+	ulong idx;
+
+	if (!slab.map || (ulong)ptr < slab.base)
+		return false;
+	idx = slab_page_idx(ptr);
+
+	return idx < slab.npages && (slab.map[BIT_WORD(idx)] & BIT_MASK(idx));
+}
+
+static void slab_cache_setup(struct slab_cache *cache)
+{
+	if (!slab.caches.next)
+		INIT_LIST_HEAD(&slab.caches);
+	cache->size = ALIGN(cache->size, MALLOC_ALIGNMENT);
+	INIT_LIST_HEAD(&cache->partial);
+	list_add_tail(&cache->sibling, &slab.caches);
+	cache->ready = true;
+}
+
+static struct slab_page *slab_new_page(struct slab_cache *cache)
+{
+	struct slab_page *page;
+	ulong idx;
+
+	if (!slab.map) {
+		slab.base = ALIGN_DOWN(mem_malloc_start, SLAB_PAGE_SIZE);
+		slab.npages = DIV_ROUND_UP(mem_malloc_end - slab.base,
+					   SLAB_PAGE_SIZE);
+		slab.map = cALLOc_impl(BITS_TO_LONGS(slab.npages),
+				       sizeof(ulong));
+		if (!slab.map)
+			return NULL;
+	}
+
+	page = mEMALIGn_impl(SLAB_PAGE_SIZE, SLAB_PAGE_SIZE);
+	if (!page)
+		return NULL;
+	page->cache = cache;
+	page->free = NULL;
+	page->inuse = 0;
+	page->unused = 0;
+	page->total = (SLAB_PAGE_SIZE - SLAB_HDR_SIZE) / cache->size;
+	list_add(&page->node, &cache->partial);
+
+	idx = slab_page_idx(page);
+	slab.map[BIT_WORD(idx)] |= BIT_MASK(idx);
+	slab.page_bytes += chunksize(mem2chunk(page));
+	cache->pages++;
+
+	return page;
+}
+
+static void *slab_cache_alloc(struct slab_cache *cache)
+{
+	struct slab_page *page;
+	void *obj;
+
+	if (!cache->ready)
+		slab_cache_setup(cache);
+	if (list_empty(&cache->partial)) {
+		page = slab_new_page(cache);
+		if (!page)
+			return NULL;
+	} else {
+		page = list_first_entry(&cache->partial, struct slab_page,
+					node);
+	}
+
+	if (page->free) {
+		obj = page->free;
+		page->free = *(void **)obj;
+	} else {
+		obj = (void *)page + SLAB_HDR_SIZE +
+			page->unused++ * cache->size;
+	}
+	if (++page->inuse == page->total)
+		list_del(&page->node);
+	cache->inuse++;
+	cache->allocs++;
+	slab.obj_bytes += cache->size;
+
+	return obj;
+}
+
+/* Allocate an object large enough for @bytes, which is <= SLAB_MAX_SIZE */
+static void *slab_alloc(size_t bytes)
+{
+	uint idx = slab_class_idx[DIV_ROUND_UP(bytes, SLAB_ALIGN)];
+	void *obj;
+
+	obj = slab_cache_alloc(&slab_class[idx]);
+	if (obj)
+		perf_add(PERF_MALLOC, bytes);
+
+	return obj;
+}
+
+static void slab_free(void *ptr)
+{
+	struct slab_page *page = slab_page_of(ptr);
+	struct slab_cache *cache = page->cache;
+	ulong idx;
+
+	perf_add(PERF_FREE, 0);
+	*(void **)ptr = page->free;
+	page->free = ptr;
+	if (page->inuse-- == page->total)
+		list_add(&page->node, &cache->partial);
+	cache->inuse--;
+	slab.obj_bytes -= cache->size;
+
+	/* Keep one empty page in each pool, to avoid thrashing */
+	if (page->inuse || list_is_singular(&cache->partial))
+		return;
+	list_del(&page->node);
+	idx = slab_page_idx(page);
+	slab.map[BIT_WORD(idx)] &= ~BIT_MASK(idx);
+	slab.page_bytes -= chunksize(mem2chunk(page));
+	cache->pages--;
+	fREe_impl(page);
+}
+
+static size_t slab_usable_size(const void *ptr)
+{
+	return slab_page_of(ptr)->cache->size;
+}
+
+void *slab_pool_alloc(struct slab_cache *pool)
+{
+	void *obj;
+
+	if (!slab_ready() || pool->size > SLAB_POOL_MAX)
+		return cALLOc(1, pool->size);
+	obj = slab_cache_alloc(pool);
+	if (!obj)
+		return NULL;
+	perf_add(PERF_MALLOC, pool->size);
+	memset(obj, '\0', pool->size);
+
+	return obj;
+}
+
+void slab_show_stats(void)
+{
+	struct slab_cache *cache;
+
+	printf("%-16s %6s %6s %8s %8s %10s\n", "Pool", "Size", "Pages",
+	       "Objects", "In use", "Allocs");
+	printf("---------------------------------------------------------\n");
+	if (slab.caches.next) {
+		list_for_each_entry(cache, &slab.caches, sibling) {
+			if (!cache->pages)
+				continue;
+			printf("%-16s %6u %6u %8u %8u %10lu\n", cache->name,
+			       cache->size, cache->pages, cache->pages *
+			       (uint)((SLAB_PAGE_SIZE - SLAB_HDR_SIZE) /
+				      cache->size),
+			       cache->inuse, cache->allocs);
+		}
+	}
+	printf("Slab pages use %lx bytes, objects %lx bytes\n",
+	       slab.page_bytes, slab.obj_bytes);
+}
@@ -7,6 +7,7 @@
 #include <errno.h>
 #include <fpga.h>
 #include <gzip.h>
+#include <hash.h>
 #include <image.h>
 #include <log.h>
 #include <memalign.h>
@@ -193,6 +194,185 @@ static int get_aligned_image_size(struct spl_load_info *info, int data_size,
 	return ALIGN(data_size, spl_get_bl_len(info));
 }
 
+/**
+ * struct spl_fit_hash - hash of an image, calculated as it is read
+ *
+ * @node: offset of the image's hash node
+ * @algo: hash algorithm
+ * @value: calculated hash value
+ */
+struct spl_fit_hash {
+	int node;
+	struct hash_algo *algo;
+	u8 value[FIT_MAX_HASH_LEN];
+};
+
+#if CONFIG_IS_ENABLED(FIT_HASH_WHILE_LOADING)
+/**
+ * spl_fit_hash_setup() - check whether an image can be hashed as it is read
+ *
+ * This is only done if the image has a single hash node and no signature
+ * node, so that the hash is all that fit_image_verify_with_data() would
+ * calculate
+ *
+ * @fit: FIT blob
+ * @node: image node
+ * @hash: returns the hash node and algorithm
+ * Return: 0 if OK, -ENOSYS if the image must be checked after it is read
+ */
+static int spl_fit_hash_setup(const void *fit, int node,
+			      struct spl_fit_hash *hash)
+{
+	const char *algo;
+	int noffset;
+
+	hash->node = -1;
+	fdt_for_each_subnode(noffset, fit, node) {
+		const char *name = fit_get_name(fit, noffset, NULL);
+
+		if (!strncmp(name, FIT_SIG_NODENAME,
+			     strlen(FIT_SIG_NODENAME)))
+			return -ENOSYS;
+		if (!strncmp(name, FIT_HASH_NODENAME,
+			     strlen(FIT_HASH_NODENAME))) {
+			if (hash->node >= 0)
+				return -ENOSYS;
+			hash->node = noffset;
+		}
+	}
+	if (hash->node < 0 ||
+	    fdt_getprop(fit, hash->node, FIT_IGNORE_PROP, NULL) ||
+	    fit_image_hash_get_algo(fit, hash->node, &algo) ||
+	    hash_lookup_algo(algo, &hash->algo) ||
+	    !hash->algo->hash_init)
+		return -ENOSYS;
+
+	return 0;
+}
+
+/**
+ * spl_fit_read_hashed() - read an image in chunks, hashing each as it arrives
+ *
+ * Each chunk is hashed straight after it is read, while it is likely still
+ * in the cache, rather than reading the whole image back from memory once it
+ * has been loaded
+ *
+ * @info: device to read from
+ * @offset: offset to read from, aligned to the block length
+ * @size: number of bytes to read, aligned to the block length
+ * @buf: buffer to read into
+ * @overhead: offset of the image data within @buf
+ * @length: size of the image data
+ * @hash: hash to calculate, as set up by spl_fit_hash_setup()
+ * Return: 0 if OK, -EIO on read error, -ENOMEM if out of memory
+ */
+static int spl_fit_read_hashed(struct spl_load_info *info, ulong offset,
+			       ulong size, void *buf, ulong overhead,
+			       size_t length, struct spl_fit_hash *hash)
+{
+	ulong chunk = ALIGN(CONFIG_VAL(FIT_HASH_CHUNK_SIZE),
+			    spl_get_bl_len(info));
+	ulong end = overhead + length;
+	ulong pos, n, from, to;
+	struct hash_algo *algo = hash->algo;
+	void *ctx;
+	int ret = 0;
+
+	if (algo->hash_init(algo, &ctx))
+		return -ENOMEM;
+
+	for (pos = 0; pos < size; pos += n) {
+		n = min(chunk, size - pos);
+		if (info->read(info, offset + pos, n, buf + pos) <
+		    min(n, end - pos)) {
+			ret = -EIO;
+			break;
+		}
+
+		/* only hash the image data, not the alignment around it */
+		from = max(pos, overhead);
+		to = min(pos + n, end);
+		if (from < to &&
+		    algo->hash_update(algo, ctx, buf + from, to - from,
+				      to == end)) {
+			ret = -EIO;
+			break;
+		}
+	}
+
+	/* this also frees the context */
+	if (algo->hash_finish(algo, ctx, hash->value, algo->digest_size) &&
+	    !ret)
+		ret = -EIO;
+
+	return ret;
+}
+
+/**
+ * spl_fit_check_hashed() - check an image which was hashed as it was read
+ *
+ * This does the same checks as fit_image_verify_with_data(), using the hash
+ * calculated by spl_fit_read_hashed()
+ *
+ * @fit: FIT blob
+ * @node: image node
+ * @data: image data
+ * @length: size of image data
+ * @hash: calculated hash
+ * Return: 0 if OK, -EPERM if the image is not valid
+ */
+static int spl_fit_check_hashed(const void *fit, int node, const void *data,
+				size_t length, struct spl_fit_hash *hash)
+{
+	char *err_msg = NULL;
+	int verify_all = 1;
+	u8 *fit_value;
+	int fit_value_len;
+
+	if (fit_image_verify_required_sigs(fit, node, data, length,
+					   gd_fdt_blob(), &verify_all)) {
+		err_msg = "Unable to verify required signature";
+	} else {
+		printf("%s", hash->algo->name);
+		if (fit_image_hash_get_value(fit, hash->node, &fit_value,
+					     &fit_value_len))
+			err_msg = "Can't get hash value property";
+		else if (fit_value_len != hash->algo->digest_size)
+			err_msg = "Bad hash value len";
+		else if (memcmp(hash->value, fit_value, fit_value_len))
+			err_msg = "Bad hash value";
+	}
+	if (err_msg) {
+		printf(" error!\n%s for '%s' hash node in '%s' image node\n",
+		       err_msg, fit_get_name(fit, hash->node, NULL),
+		       fit_get_name(fit, node, NULL));
+		return -EPERM;
+	}
+	puts("+ ");
+
+	return 0;
+}
+#else
+static int spl_fit_hash_setup(const void *fit, int node,
+			      struct spl_fit_hash *hash)
+{
+	return -ENOSYS;
+}
+
+static int spl_fit_read_hashed(struct spl_load_info *info, ulong offset,
+			       ulong size, void *buf, ulong overhead,
+			       size_t length, struct spl_fit_hash *hash)
+{
+	return -ENOSYS;
+}
+
+static int spl_fit_check_hashed(const void *fit, int node, const void *data,
+				size_t length, struct spl_fit_hash *hash)
+{
+	return -ENOSYS;
+}
+#endif
+
 /**
  * load_simple_fit(): load the image described in a certain FIT node
  * @info:	points to information about the device to load data from
@@ -225,6 +405,8 @@ static int load_simple_fit(struct spl_load_info *info, ulong fit_offset,
 	const void *data;
 	const void *fit = ctx->fit;
 	bool external_data = false;
+	struct spl_fit_hash hash;
+	bool hashed = false;
 
 	log_debug("starting\n");
 	if (CONFIG_IS_ENABLED(BOOTMETH_VBE) &&
@@ -305,8 +487,20 @@ static int load_simple_fit(struct spl_load_info *info, ulong fit_offset,
 		log_debug("reading from offset %x / %lx size %lx to %p: ",
 			  offset, read_offset, size, src_ptr);
 
-		if (info->read(info, read_offset, size, src_ptr) < length)
+		if (CONFIG_IS_ENABLED(FIT_HASH_WHILE_LOADING) &&
+		    !spl_fit_hash_setup(fit, node, &hash)) {
+			int ret;
+
+			ret = spl_fit_read_hashed(info, read_offset, size,
+						  src_ptr, overhead, length,
+						  &hash);
+			if (ret)
+				return ret;
+			hashed = true;
+		} else if (info->read(info, read_offset, size, src_ptr) <
+			   length) {
 			return -EIO;
+		}
 
 		debug("External data: dst=%p, offset=%x, size=%lx\n",
 		      src_ptr, offset, (unsigned long)length);
@@ -325,9 +519,14 @@ static int load_simple_fit(struct spl_load_info *info, ulong fit_offset,
 	if (CONFIG_IS_ENABLED(FIT_SIGNATURE)) {
 		printf("## Checking hash(es) for Image %s ... ",
 		       fit_get_name(fit, node, NULL));
-		if (!fit_image_verify_with_data(fit, node, gd_fdt_blob(), src,
-						length))
+		if (hashed) {
+			if (spl_fit_check_hashed(fit, node, src, length, &hash))
+				return -EPERM;
+		} else if (!fit_image_verify_with_data(fit, node,
+						       gd_fdt_blob(), src,
+						       length)) {
 			return -EPERM;
+		}
 		puts("OK\n");
 	}
 
@@ -34,6 +34,7 @@
 #include <linux/ctype.h>
 #include <linux/delay.h>
 #include <linux/list.h>
+#include <dm/device-internal.h>
 #include <asm/byteorder.h>
 #ifdef CONFIG_SANDBOX
 #include <asm/state.h>
@@ -943,6 +944,87 @@ int usb_hub_scan(struct udevice *hub)
 	return usb_hub_configure(udev);
 }
 
+static struct udevice *usb_hub_find_port_child(struct udevice *hub, int port)
+{
+	struct udevice *dev;
+
+	device_foreach_child(dev, hub) {
+		struct usb_device *udev;
+
+		if (!device_active(dev) ||
+		    device_get_uclass_id(dev) == UCLASS_USB_EMUL)
+			continue;
+		udev = dev_get_parent_priv(dev);
+		if (udev->portnr == port)
+			return dev;
+	}
+
+	return NULL;
+}
+
+int usb_hub_rescan(struct udevice *hub)
+{
+	ALLOC_CACHE_ALIGN_BUFFER(struct usb_port_status, portsts, 1);
+	struct usb_device *dev = dev_get_parent_priv(hub);
+	unsigned short portstatus, portchange;
+	struct udevice *child;
+	int changes = 0;
+	int i, ret;
+
+	for (i = 0; i < dev->maxchild; i++) {
+		ret = usb_get_port_status(dev, i + 1, portsts);
+		if (ret < 0) {
+			debug("%s: port %d: get_port_status failed\n",
+			      hub->name, i + 1);
+			continue;
+		}
+		portstatus = le16_to_cpu(portsts->wPortStatus);
+		portchange = le16_to_cpu(portsts->wPortChange);
+		child = usb_hub_find_port_child(hub, i + 1);
+		debug("%s: port %d status %x change %x child %s\n", hub->name,
+		      i + 1, portstatus, portchange,
+		      child ? child->name : "(none)");
+
+		if (!(portchange & USB_PORT_STAT_C_CONNECTION)) {
+			/* Same device as before, keep it and its descriptors */
+			if (child && (portstatus & USB_PORT_STAT_CONNECTION)) {
+				if (device_get_uclass_id(child) ==
+				    UCLASS_USB_HUB) {
+					ret = usb_hub_rescan(child);
+					if (ret > 0)
+						changes += ret;
+				}
+				continue;
+			}
+			/* Still nothing there */
+			if (!child && !(portstatus & USB_PORT_STAT_CONNECTION))
+				continue;
+		}
+
+		changes++;
+		if (child) {
+			debug("%s: port %d: removing '%s'\n", hub->name, i + 1,
+			      child->name);
+			ret = device_remove(child, DM_REMOVE_NORMAL);
+			if (!ret)
+				ret = device_unbind(child);
+			if (ret) {
+				printf("%s: cannot remove '%s' (err=%d)\n",
+				       hub->name, child->name, ret);
+				continue;
+			}
+		}
+
+		if (portstatus & USB_PORT_STAT_CONNECTION)
+			usb_hub_port_connect_change(dev, i);
+		else
+			usb_clear_port_feature(dev, i + 1,
+					       USB_PORT_FEAT_C_CONNECTION);
+	}
+
+	return changes;
+}
+
 static int usb_hub_post_probe(struct udevice *dev)
 {
 	debug("%s\n", __func__);
@@ -11,6 +11,7 @@
 #include <log.h>
 #include <malloc.h>
 #include <part.h>
+#include <perf.h>
 #include <dm/device-internal.h>
 #include <dm/lists.h>
 #include <dm/uclass-internal.h>
@@ -434,6 +435,7 @@ long blk_read(struct udevice *dev, lbaint_t start, lbaint_t blkcnt, void *buf)
 	struct blk_desc *desc = dev_get_uclass_plat(dev);
 	const struct blk_ops *ops = blk_get_ops(dev);
 	ulong blks_read;
+	u64 perf_start;
 
 	if (!ops->read)
 		return -ENOSYS;
@@ -442,6 +444,8 @@ long blk_read(struct udevice *dev, lbaint_t start, lbaint_t blkcnt, void *buf)
 			  start, blkcnt, desc->blksz, buf))
 		return blkcnt;
 
+	perf_start = perf_begin();
+
 	if (IS_ENABLED(CONFIG_BOUNCE_BUFFER) && desc->bb) {
 		struct blk_bounce_buffer bbstate = { .dev = dev };
 		int ret;
@@ -463,6 +467,9 @@ long blk_read(struct udevice *dev, lbaint_t start, lbaint_t blkcnt, void *buf)
 	if (blks_read == blkcnt)
 		blkcache_fill(desc->uclass_id, desc->devnum, start, blkcnt,
 			      desc->blksz, buf);
+	if ((long)blks_read > 0)
+		perf_end(PERF_BLK_READ, perf_start,
+			 (u64)blks_read * desc->blksz);
 
 	return blks_read;
 }
@@ -473,11 +480,13 @@ long blk_write(struct udevice *dev, lbaint_t start, lbaint_t blkcnt,
 	struct blk_desc *desc = dev_get_uclass_plat(dev);
 	const struct blk_ops *ops = blk_get_ops(dev);
 	long blks_written;
+	u64 perf_start;
 
 	if (!ops->write)
 		return -ENOSYS;
 
 	blkcache_invalidate(desc->uclass_id, desc->devnum);
+	perf_start = perf_begin();
 
 	if (IS_ENABLED(CONFIG_BOUNCE_BUFFER) && desc->bb) {
 		struct blk_bounce_buffer bbstate = { .dev = dev };
@@ -497,6 +506,9 @@ long blk_write(struct udevice *dev, lbaint_t start, lbaint_t blkcnt,
 	} else {
 		blks_written = ops->write(dev, start, blkcnt, buf);
 	}
+	if (blks_written > 0)
+		perf_end(PERF_BLK_WRITE, perf_start,
+			 (u64)blks_written * desc->blksz);
 
 	return blks_written;
 }
@@ -505,13 +517,21 @@ long blk_erase(struct udevice *dev, lbaint_t start, lbaint_t blkcnt)
 {
 	struct blk_desc *desc = dev_get_uclass_plat(dev);
 	const struct blk_ops *ops = blk_get_ops(dev);
+	u64 perf_start;
+	long blks_erased;
 
 	if (!ops->erase)
 		return -ENOSYS;
 
 	blkcache_invalidate(desc->uclass_id, desc->devnum);
 
-	return ops->erase(dev, start, blkcnt);
+	perf_start = perf_begin();
+	blks_erased = ops->erase(dev, start, blkcnt);
+	if (blks_erased > 0)
+		perf_end(PERF_BLK_ERASE, perf_start,
+			 (u64)blks_erased * desc->blksz);
+
+	return blks_erased;
 }
 
 ulong blk_dread(struct blk_desc *desc, lbaint_t start, lbaint_t blkcnt,
@@ -8,6 +8,7 @@
  * Pavel Herrmann <morpheus.ibis@gmail.com>
  */
 
+#include <bootstage.h>
 #include <cpu_func.h>
 #include <errno.h>
 #include <event.h>
@@ -18,6 +19,7 @@
 #include <fdtdec.h>
 #include <fdt_support.h>
 #include <malloc.h>
+#include <slab.h>
 #include <asm/cache.h>
 #include <dm/device.h>
 #include <dm/device-internal.h>
@@ -37,6 +39,9 @@
 
 DECLARE_GLOBAL_DATA_PTR;
 
+/* Devices are allocated from their own pool, when the slab is enabled */
+static SLAB_POOL(udevice_pool, struct udevice);
+
 static int device_bind_common(struct udevice *parent, const struct driver *drv,
 			      const char *name, void *plat,
 			      ulong driver_data, ofnode node,
@@ -62,7 +67,7 @@ static int device_bind_common(struct udevice *parent, const struct driver *drv,
 		return ret;
 	}
 
-	dev = calloc(1, sizeof(struct udevice));
+	dev = slab_pool_alloc(&udevice_pool);
 	if (!dev)
 		return -ENOMEM;
 
@@ -478,17 +483,11 @@ static int device_get_dma_constraints(struct udevice *dev)
 	return 0;
 }
 
-int device_probe(struct udevice *dev)
+static int device_do_probe(struct udevice *dev)
 {
 	const struct driver *drv;
 	int ret;
 
-	if (!dev)
-		return -EINVAL;
-
-	if (dev_get_flags(dev) & DM_FLAG_ACTIVATED)
-		return 0;
-
 	ret = device_notify(dev, EVT_DM_PRE_PROBE);
 	if (ret)
 		return ret;
@@ -616,6 +615,24 @@ fail:
 	return ret;
 }
 
+int device_probe(struct udevice *dev)
+{
+	int span;
+	int ret;
+
+	if (!dev)
+		return -EINVAL;
+
+	if (dev_get_flags(dev) & DM_FLAG_ACTIVATED)
+		return 0;
+
+	span = bootstage_span_begin(dev->name, BOOTSTAGE_SPANF_PROBE);
+	ret = device_do_probe(dev);
+	bootstage_span_end(span);
+
+	return ret;
+}
+
 void *dev_get_plat(const struct udevice *dev)
 {
 	if (!dev) {
@@ -21,6 +21,7 @@
 
 #include <log.h>
 #include <malloc.h>
+#include <slab.h>
 #include <asm/global_data.h>
 #include <linux/bug.h>
 #include <linux/libfdt.h>
@@ -41,6 +42,10 @@ static struct device_node *of_aliases;
 /* "/chosen" node */
 static struct device_node *of_chosen;
 
+/* pools for nodes and properties added to the live tree */
+static SLAB_POOL(node_pool, struct device_node);
+static SLAB_POOL(property_pool, struct property);
+
 /* node pointed to by the stdout-path alias */
 static struct device_node *of_stdout;
 
@@ -983,7 +988,7 @@ int of_write_prop(struct device_node *np, const char *propname, int len,
 	}
 
 	/* Property does not exist -> append new property */
-	new = malloc(sizeof(struct property));
+	new = slab_pool_alloc(&property_pool);
 	if (!new)
 		return -ENOMEM;
 
@@ -1027,7 +1032,7 @@ int of_add_subnode(struct device_node *parent, const char *name, int len,
 	}
 
 	/* Subnode does not exist -> append new subnode */
-	new = calloc(1, sizeof(struct device_node));
+	new = slab_pool_alloc(&node_pool);
 	if (!new)
 		return -ENOMEM;
 
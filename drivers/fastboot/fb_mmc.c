@@ -164,6 +164,27 @@ static lbaint_t fb_mmc_sparse_reserve(struct sparse_storage *info,
 	return blkcnt;
 }
 
+static lbaint_t fb_mmc_sparse_erase(struct sparse_storage *info,
+		lbaint_t blk, lbaint_t blkcnt)
+{
+	struct fb_mmc_sparse *sparse = info->priv;
+	struct blk_desc *dev_desc = sparse->dev_desc;
+	struct mmc *mmc = find_mmc_device(dev_desc->devnum);
+
+	/*
+	 * Erased blocks must read back as zero, which only an eMMC reports,
+	 * in ERASED_MEM_CONT. Otherwise write the zeros instead.
+	 */
+	if (!mmc || !mmc->ext_csd || mmc->ext_csd[EXT_CSD_ERASED_MEM_CONT])
+		return 0;
+
+	/* Without trim, the card would erase whole erase groups */
+	if (!mmc->can_trim && ((blk | blkcnt) & (mmc->erase_grp_size - 1)))
+		return 0;
+
+	return fb_mmc_blk_write(dev_desc, blk, blkcnt, NULL);
+}
+
 static void write_raw_image(struct blk_desc *dev_desc,
 			    struct disk_partition *info, const char *part_name,
 			    void *buffer, u32 download_bytes, char *response)
@@ -620,6 +641,9 @@ void fastboot_mmc_flash_write(const char *cmd, void *download_buffer,
 		sparse.size = info.size;
 		sparse.write = fb_mmc_sparse_write;
 		sparse.reserve = fb_mmc_sparse_reserve;
+		sparse.erase = NULL;
+		if (IS_ENABLED(CONFIG_FASTBOOT_MMC_SPARSE_ERASE))
+			sparse.erase = fb_mmc_sparse_erase;
 		sparse.mssg = fastboot_fail;
 
 		printf("Flashing sparse image at offset " LBAFU "\n",
@@ -47,6 +47,10 @@
 #include <asm/io.h>
 #include <linux/errno.h>
 
+/* SPL only keeps a bad block table when it passes it on to U-Boot proper */
+#define NAND_HAS_BBT	(!IS_ENABLED(CONFIG_XPL_BUILD) || \
+			 CONFIG_IS_ENABLED(NAND_BBT_HANDOFF))
+
 /* Define default oob placement schemes for large and small page devices */
 #ifndef CONFIG_SYS_NAND_DRIVER_ECC_LAYOUT
 static struct nand_ecclayout nand_oob_8 = {
@@ -435,7 +439,7 @@ static int nand_block_markbad_lowlevel(struct mtd_info *mtd, loff_t ofs)
 {
 	struct nand_chip *chip = mtd_to_nand(mtd);
 	int ret = 0;
-#ifndef CONFIG_XPL_BUILD
+#if NAND_HAS_BBT
 	int res;
 #endif
 
@@ -455,7 +459,7 @@ static int nand_block_markbad_lowlevel(struct mtd_info *mtd, loff_t ofs)
 		nand_release_device(mtd);
 	}
 
-#ifndef CONFIG_XPL_BUILD
+#if NAND_HAS_BBT
 	/* Mark block bad in BBT */
 	if (chip->bbt) {
 		res = nand_markbad_bbt(mtd, ofs);
@@ -509,7 +513,7 @@ static int nand_block_isreserved(struct mtd_info *mtd, loff_t ofs)
 	if (!chip->bbt)
 		return 0;
 	/* Return info from the table */
-#ifndef CONFIG_XPL_BUILD
+#if NAND_HAS_BBT
 	return nand_isreserved_bbt(mtd, ofs);
 #else
 	return 0;
@@ -539,7 +543,7 @@ static int nand_block_checkbad(struct mtd_info *mtd, loff_t ofs, int allowbbt)
 		return chip->block_bad(mtd, ofs);
 
 	/* Return info from the table */
-#ifndef CONFIG_XPL_BUILD
+#if NAND_HAS_BBT
 	return nand_isbad_bbt(mtd, ofs, allowbbt);
 #else
 	return 0;
@@ -1089,6 +1093,46 @@ static void __maybe_unused nand_release_data_interface(struct nand_chip *chip)
 	kfree(chip->data_interface);
 }
 
+/**
+ * nand_cont_read_page_op - Do a READ PAGE operation within a cache read
+ * @chip: The NAND chip
+ * @page: page to read
+ * @offset_in_page: offset within the page
+ * @buf: buffer used to store the data
+ * @len: length of the buffer
+ *
+ * The first page of a sequential cache read is loaded with READ PAGE. READ
+ * CACHE SEQUENTIAL then moves it to the cache register and makes the chip
+ * load the next page from the array while the host transfers and corrects
+ * the current one. The last page is fetched with READ CACHE END, which
+ * terminates the sequence. Pages must be requested in order.
+ *
+ * Returns 0 on success, a negative error code otherwise.
+ */
+static int nand_cont_read_page_op(struct nand_chip *chip, unsigned int page,
+				  unsigned int offset_in_page, void *buf,
+				  unsigned int len)
+{
+	struct mtd_info *mtd = nand_to_mtd(chip);
+
+	if (page == chip->cont_read.first_page)
+		chip->cmdfunc(mtd, NAND_CMD_READ0, 0, page);
+
+	if (page == chip->cont_read.last_page) {
+		chip->cmdfunc(mtd, NAND_CMD_READCACHEEND, -1, -1);
+		chip->cont_read.ongoing = false;
+	} else {
+		chip->cmdfunc(mtd, NAND_CMD_READCACHESEQ, -1, -1);
+	}
+
+	if (offset_in_page)
+		chip->cmdfunc(mtd, NAND_CMD_RNDOUT, offset_in_page, -1);
+	if (len)
+		chip->read_buf(mtd, buf, len);
+
+	return 0;
+}
+
 /**
  * nand_read_page_op - Do a READ PAGE operation
  * @chip: The NAND chip
@@ -1113,6 +1157,12 @@ int nand_read_page_op(struct nand_chip *chip, unsigned int page,
 	if (offset_in_page + len > mtd->writesize + mtd->oobsize)
 		return -EINVAL;
 
+	if (chip->cont_read.ongoing &&
+	    page >= chip->cont_read.first_page &&
+	    page <= chip->cont_read.last_page)
+		return nand_cont_read_page_op(chip, page, offset_in_page, buf,
+					      len);
+
 	chip->cmdfunc(mtd, NAND_CMD_READ0, offset_in_page, page);
 	if (len)
 		chip->read_buf(mtd, buf, len);
@@ -2304,6 +2354,55 @@ static int nand_setup_read_retry(struct mtd_info *mtd, int retry_mode)
 	return chip->setup_read_retry(mtd, retry_mode);
 }
 
+/**
+ * nand_setup_cont_read - [INTERN] Start a sequential cache read if possible
+ * @mtd: MTD device structure
+ * @realpage: first page to read, including the chip number
+ * @page: first page to read, within the chip
+ * @readlen: number of bytes to read, starting at the beginning of @page
+ *
+ * Cache reads are used for runs of at least two whole pages, without OOB
+ * data, and never cross an eraseblock boundary. The chip must advertise
+ * READ CACHE in its ONFI parameter page and the controller must pass the
+ * commands on.
+ *
+ * Every page in the run must be fetched from the chip in order, so the page
+ * buffer is invalidated if it holds one of them.
+ */
+static void nand_setup_cont_read(struct mtd_info *mtd, int realpage, int page,
+				 uint32_t readlen)
+{
+	struct nand_chip *chip = mtd_to_nand(mtd);
+	unsigned int pages, last;
+
+	if (!IS_ENABLED(CONFIG_SYS_NAND_CACHE_READ) ||
+	    !(chip->options & NAND_CMDFUNC_CACHE_READ) ||
+	    (chip->options & NAND_NEED_READRDY) || !chip->onfi_version ||
+	    !(le16_to_cpu(chip->onfi_params.opt_cmd) &
+	      ONFI_OPT_CMD_READ_CACHE) ||
+	    !nand_standard_page_accessors(&chip->ecc) ||
+	    chip->ecc.mode == NAND_ECC_HW_OOB_FIRST ||
+	    chip->read_retries > 1)
+		return;
+
+	pages = readlen >> chip->page_shift;
+	if (pages < 2)
+		return;
+
+	last = page | ((1 << (chip->phys_erase_shift - chip->page_shift)) - 1);
+	last = min(last, page + pages - 1);
+	if (last == page)
+		return;
+
+	if (chip->pagebuf >= realpage &&
+	    chip->pagebuf <= realpage + (int)(last - page))
+		chip->pagebuf = -1;
+
+	chip->cont_read.first_page = page;
+	chip->cont_read.last_page = last;
+	chip->cont_read.ongoing = true;
+}
+
 /**
  * nand_do_read_ops - [INTERN] Read data with ECC
  * @mtd: MTD device structure
@@ -2363,6 +2462,10 @@ static int nand_do_read_ops(struct mtd_info *mtd, loff_t from,
 				pr_debug("%s: using read bounce buffer for buf@%p\n",
 						 __func__, buf);
 
+			if (!col && !oob && !chip->cont_read.ongoing)
+				nand_setup_cont_read(mtd, realpage, page,
+						     readlen);
+
 read_retry:
 			if (nand_standard_page_accessors(&chip->ecc)) {
 				ret = nand_read_page_op(chip, page, 0, NULL, 0);
@@ -2478,6 +2581,12 @@ read_retry:
 			chip->select_chip(mtd, chipnr);
 		}
 	}
+
+	/* Terminate a cache read which was cut short by an error */
+	if (chip->cont_read.ongoing) {
+		chip->cmdfunc(mtd, NAND_CMD_READCACHEEND, -1, -1);
+		chip->cont_read.ongoing = false;
+	}
 	chip->select_chip(mtd, -1);
 
 	ops->retlen = ops->len - (size_t) readlen;
@@ -3751,7 +3860,7 @@ static void nand_set_defaults(struct nand_chip *chip, int busw)
 	if (!chip->read_buf || chip->read_buf == nand_read_buf)
 		chip->read_buf = busw ? nand_read_buf16 : nand_read_buf;
 
-#ifndef CONFIG_XPL_BUILD
+#if NAND_HAS_BBT
 	if (!chip->scan_bbt)
 		chip->scan_bbt = nand_default_bbt;
 #endif
@@ -5172,6 +5281,10 @@ int nand_scan_tail(struct mtd_info *mtd)
 	/* Invalidate the pagebuffer reference */
 	chip->pagebuf = -1;
 
+	/* The default large page cmdfunc passes cache read commands through */
+	if (chip->cmdfunc == nand_command_lp)
+		chip->options |= NAND_CMDFUNC_CACHE_READ;
+
 	/* Large page NAND with SOFT_ECC should support subpage reads */
 	switch (ecc->mode) {
 	case NAND_ECC_SOFT:
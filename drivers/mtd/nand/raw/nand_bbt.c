@@ -57,6 +57,7 @@
  *
  */
 
+#include <bloblist.h>
 #include <log.h>
 #include <malloc.h>
 #include <dm/devres.h>
@@ -1060,6 +1061,121 @@ static void verify_bbt_descr(struct mtd_info *mtd, struct nand_bbt_descr *bd)
 	BUG_ON(table_size > (1 << this->bbt_erase_shift));
 }
 
+/**
+ * bbt_handoff_find - Find the bad block table handed over for a chip
+ * @mtd: MTD device structure
+ *
+ * Return: the table if there is one for this chip, NULL otherwise
+ */
+static struct nand_bbt_handoff *bbt_handoff_find(struct mtd_info *mtd)
+{
+	struct nand_chip *this = mtd_to_nand(mtd);
+	int len = (mtd->size >> (this->bbt_erase_shift + 2)) ? : 1;
+	struct nand_bbt_handoff *ho;
+	int size;
+
+	ho = bloblist_get_blob(BLOBLISTT_U_BOOT_NAND_BBT, &size);
+	if (!ho || size != sizeof(*ho) + len || ho->size != mtd->size ||
+	    ho->erase_shift != this->bbt_erase_shift ||
+	    ho->id_len != this->id.len ||
+	    memcmp(ho->id, this->id.data, this->id.len))
+		return NULL;
+
+	return ho;
+}
+
+/**
+ * bbt_handoff_restore - Take over the bad block table from an earlier phase
+ * @mtd: MTD device structure
+ *
+ * Return: true if @this->bbt was filled in, false if the device must be
+ * scanned
+ */
+static bool bbt_handoff_restore(struct mtd_info *mtd)
+{
+	struct nand_chip *this = mtd_to_nand(mtd);
+	int len = (mtd->size >> (this->bbt_erase_shift + 2)) ? : 1;
+	int i, numblocks = mtd->size >> this->bbt_erase_shift;
+	struct nand_bbt_handoff *ho;
+
+	if (!CONFIG_IS_ENABLED(NAND_BBT_HANDOFF))
+		return false;
+
+	ho = bbt_handoff_find(mtd);
+	if (!ho || !ho->gen)
+		return false;
+
+	memcpy(this->bbt, ho->bbt, len);
+	for (i = 0; i < numblocks; i++) {
+		if (bbt_get_entry(this, i) != BBT_BLOCK_GOOD)
+			mtd->ecc_stats.badblocks++;
+	}
+	pr_debug("nand_bbt: using handed-over table, generation %u\n",
+		 ho->gen);
+
+	return true;
+}
+
+/**
+ * bbt_handoff_save - Pass the bad block table on to the next phase
+ * @mtd: MTD device structure
+ *
+ * Only the first chip to get here has its table passed on.
+ */
+static void bbt_handoff_save(struct mtd_info *mtd)
+{
+	struct nand_chip *this = mtd_to_nand(mtd);
+	int len = (mtd->size >> (this->bbt_erase_shift + 2)) ? : 1;
+	struct nand_bbt_handoff *ho;
+
+	if (!CONFIG_IS_ENABLED(NAND_BBT_HANDOFF) ||
+	    !IS_ENABLED(CONFIG_XPL_BUILD))
+		return;
+
+	ho = bbt_handoff_find(mtd);
+	if (!ho) {
+		if (bloblist_find(BLOBLISTT_U_BOOT_NAND_BBT, 0))
+			return;
+		ho = bloblist_add(BLOBLISTT_U_BOOT_NAND_BBT,
+				  sizeof(*ho) + len, 0);
+		if (!ho) {
+			pr_debug("nand_bbt: no space to hand over table\n");
+			return;
+		}
+	}
+
+	/* Keep the table invalid until it is complete */
+	ho->gen = 0;
+	ho->erase_shift = this->bbt_erase_shift;
+	ho->size = mtd->size;
+	ho->id_len = this->id.len;
+	memcpy(ho->id, this->id.data, sizeof(ho->id));
+	memcpy(ho->bbt, this->bbt, len);
+	ho->gen = 1;
+}
+
+/**
+ * bbt_handoff_mark - Record a newly bad block in the handed-over table
+ * @mtd: MTD device structure
+ * @block: block number
+ * @mark: new state of the block
+ */
+static void bbt_handoff_mark(struct mtd_info *mtd, int block, uint8_t mark)
+{
+	struct nand_bbt_handoff *ho;
+
+	if (!CONFIG_IS_ENABLED(NAND_BBT_HANDOFF))
+		return;
+
+	ho = bbt_handoff_find(mtd);
+	if (!ho || !ho->gen)
+		return;
+
+	ho->bbt[block >> BBT_ENTRY_SHIFT] |=
+		(mark & BBT_ENTRY_MASK) << ((block & BBT_ENTRY_MASK) * 2);
+	ho->gen++;
+}
+
 /**
  * nand_scan_bbt - [NAND Interface] scan, find, read and maybe create bad block table(s)
  * @mtd: MTD device structure
@@ -1094,10 +1210,13 @@ static int nand_scan_bbt(struct mtd_info *mtd, struct nand_bbt_descr *bd)
 	 * memory based bad block table.
 	 */
 	if (!td) {
+		if (bbt_handoff_restore(mtd))
+			return 0;
 		if ((res = nand_memory_bbt(mtd, bd))) {
 			pr_err("nand_bbt: can't scan flash and build the RAM-based BBT\n");
 			goto err;
 		}
+		bbt_handoff_save(mtd);
 		return 0;
 	}
 	verify_bbt_descr(mtd, td);
@@ -1367,6 +1486,7 @@ int nand_markbad_bbt(struct mtd_info *mtd, loff_t offs)
 
 	/* Mark bad block in memory */
 	bbt_mark_entry(this, block, BBT_BLOCK_WORN);
+	bbt_handoff_mark(mtd, block, BBT_BLOCK_WORN);
 
 	/* Update flash-based bad block table */
 	if (this->bbt_options & NAND_BBT_USE_FLASH)
@@ -66,6 +66,9 @@ static const char *const state_name[] = {
  * @page_addr: Page address of the most-recent command
  * @fd: File descriptor for the backing data
  * @fd_page_addr: Page address that @fd is seek'd to
+ * @cache_page: Page address loaded by the last read or cache read command, or
+ *              -1 if a cache read cannot be started
+ * @cache_read: Whether a cache read is loading the page after @cache_page
  * @selected: Whether this device is selected
  * @tmp: "Cache" buffer used to store transferred data before committing it
  * @tmp_dirty: Whether @tmp is dirty (modified) or clean (all ones)
@@ -83,8 +86,8 @@ struct sand_nand_chip {
 	u32 err_count, err_step_bits, err_steps, ecc_bits;
 	unsigned int cs;
 	enum sand_nand_state state;
-	int column, page_addr, fd, fd_page_addr;
-	bool selected, tmp_dirty;
+	int column, page_addr, fd, fd_page_addr, cache_page;
+	bool selected, tmp_dirty, cache_read;
 	u8 status;
 	u8 id_len;
 	u8 tmp[NAND_MAX_PAGESIZE + NAND_MAX_OOBSIZE];
@@ -218,6 +221,38 @@ next:
 	return 0;
 }
 
+static enum sand_nand_state sand_nand_cache_read(struct sand_nand_chip *chip,
+						 unsigned int command)
+{
+	if (chip->cache_page < 0 ||
+	    (!chip->cache_read && command == NAND_CMD_READCACHEEND))
+		goto err;
+
+	chip->column = 0;
+	if (chip->cache_read) {
+		chip->page_addr = ++chip->cache_page;
+		if (sand_nand_read(chip))
+			goto err;
+	}
+
+	if (command == NAND_CMD_READCACHEEND) {
+		chip->cache_page = -1;
+		chip->cache_read = false;
+	} else if (chip->cache_page + 1 < chip->pages) {
+		chip->cache_read = true;
+	} else {
+		goto err;
+	}
+
+	return STATE_READ;
+
+err:
+	SAND_DEBUG(chip, "Invalid cache read command %02x\n", command);
+	chip->cache_page = -1;
+	chip->cache_read = false;
+	return STATE_IDLE;
+}
+
 static void sand_nand_command(struct mtd_info *mtd, unsigned int command,
 			      int column, int page_addr)
 {
@@ -274,8 +309,16 @@ static void sand_nand_command(struct mtd_info *mtd, unsigned int command,
 				     chip->pages_per_erase);
 		break;
 	default:
+		if (command == NAND_CMD_READCACHESEQ ||
+		    command == NAND_CMD_READCACHEEND) {
+			new_state = sand_nand_cache_read(chip, command);
+			break;
+		}
+
 		chip->column = column;
 		chip->page_addr = page_addr;
+		chip->cache_page = -1;
+		chip->cache_read = false;
 		switch (command) {
 		case NAND_CMD_READOOB:
 			if (column >= 0)
@@ -293,6 +336,8 @@ static void sand_nand_command(struct mtd_info *mtd, unsigned int command,
 				break;
 
 			chip->page_addr = page_addr;
+			if (command == NAND_CMD_READ0 && !column)
+				chip->cache_page = page_addr;
 			new_state = STATE_READ;
 			break;
 		case NAND_CMD_ERASE1:
@@ -570,6 +615,7 @@ static int sand_nand_probe(struct udevice *dev)
 		chip->pagesize = pagesize;
 		chip->pages = pages;
 		chip->pages_per_erase = erasesize / pagesize;
+		chip->cache_page = -1;
 		memset(chip->tmp, 0xff, chip->chunksize);
 
 		chip->err_count = err_count;
@@ -601,7 +647,10 @@ static int sand_nand_probe(struct udevice *dev)
 		}
 
 		nand = &chip->nand;
-		nand->options = not_xpl() ? 0 : NAND_SKIP_BBTSCAN;
+		nand->options = not_xpl() ||
+			CONFIG_IS_ENABLED(NAND_BBT_HANDOFF) ? 0 :
+			NAND_SKIP_BBTSCAN;
+		nand->options |= NAND_CMDFUNC_CACHE_READ;
 		nand->flash_node = np;
 		nand->dev_ready = sand_nand_dev_ready;
 		nand->cmdfunc = sand_nand_command;
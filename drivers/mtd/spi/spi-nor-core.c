@@ -11,6 +11,7 @@
 
 #include <display_options.h>
 #include <log.h>
+#include <memalign.h>
 #include <watchdog.h>
 #include <dm.h>
 #include <dm/device_compat.h>
@@ -462,6 +463,10 @@ static ssize_t spi_nor_write_data(struct spi_nor *nor, loff_t to, size_t len,
 			return ret;
 	}
 
+	if (CONFIG_IS_ENABLED(SPI_DIRMAP))
+		spi_mem_dirmap_invalidate(nor->dirmap.rdesc, to,
+					  op.data.nbytes);
+
 	return op.data.nbytes;
 }
 
@@ -1180,6 +1185,9 @@ static int spi_nor_erase(struct mtd_info *mtd, struct erase_info *instr)
 
 	addr_known = false;
 erase_err:
+	if (CONFIG_IS_ENABLED(SPI_DIRMAP))
+		spi_mem_dirmap_invalidate(nor->dirmap.rdesc, instr->addr,
+					  instr->len);
 #if CONFIG_IS_ENABLED(SPI_FLASH_BAR)
 	err = clean_bar(nor);
 	if (!ret)
@@ -3523,6 +3531,11 @@ static int spi_nor_select_read(struct spi_nor *nor,
 	read = &params->reads[cmd];
 	nor->read_opcode = read->opcode;
 	nor->read_proto = read->proto;
+#if CONFIG_IS_ENABLED(SPI_FLASH_READ_SELFTEST)
+	memcpy(nor->reads, params->reads, sizeof(nor->reads));
+	nor->read_hwcaps = shared_hwcaps & SNOR_HWCAPS_READ_MASK;
+	nor->read_hwcap = BIT(best_match);
+#endif
 
 	/*
 	 * In the spi-nor framework, we don't need to make the difference
@@ -3538,6 +3551,138 @@ static int spi_nor_select_read(struct spi_nor *nor,
 	return 0;
 }
 
+#if CONFIG_IS_ENABLED(SPI_FLASH_READ_SELFTEST)
+#define SPI_NOR_SELFTEST_LEN	64
+
+static bool spi_nor_read_hwcap_usable(struct spi_nor *nor, u32 hwcap)
+{
+	enum spi_nor_protocol proto;
+	int cmd;
+
+	if (!(nor->read_hwcaps & hwcap))
+		return false;
+
+	cmd = spi_nor_hwcaps_read2cmd(hwcap);
+	if (cmd < 0)
+		return false;
+
+	proto = nor->reads[cmd].proto;
+	if (proto == nor->read_proto)
+		return true;
+
+	/*
+	 * Protocols with a multi-line instruction phase need the flash to be
+	 * switched to another mode, which only spi_nor_init() knows about.
+	 */
+	return spi_nor_get_protocol_inst_nbits(proto) == 1 &&
+	       spi_nor_get_protocol_inst_nbits(nor->read_proto) == 1;
+}
+
+int spi_nor_select_read_hwcap(struct spi_nor *nor, u32 hwcap)
+{
+	const struct spi_nor_read_command *read;
+	u8 opcode;
+	int __maybe_unused cur;
+
+	if (!spi_nor_read_hwcap_usable(nor, hwcap))
+		return -EINVAL;
+
+	read = &nor->reads[spi_nor_hwcaps_read2cmd(hwcap)];
+	opcode = read->opcode;
+
+#if !CONFIG_IS_ENABLED(SPI_FLASH_BAR)
+	/* Keep using 4-byte opcodes if spi_nor_scan() switched to them */
+	cur = spi_nor_hwcaps_read2cmd(nor->read_hwcap);
+	if (cur >= 0 && nor->read_opcode != nor->reads[cur].opcode)
+		opcode = spi_nor_convert_3to4_read(opcode);
+#endif
+
+	nor->read_opcode = opcode;
+	nor->read_proto = read->proto;
+	nor->read_dummy = read->num_mode_clocks + read->num_wait_states;
+	nor->read_hwcap = hwcap;
+
+	return 0;
+}
+
+/*
+ * Read the start of the flash with the (Slow) Read command, which every flash
+ * supports before spi_nor_init() switches it to another mode. This is used as
+ * the reference for checking the read protocol chosen by spi_nor_setup().
+ */
+static int spi_nor_read_reference(struct spi_nor *nor, u8 *buf, size_t *lenp)
+{
+	struct spi_mem_op op =
+		SPI_MEM_OP(SPI_MEM_OP_CMD(SPINOR_OP_READ, 1),
+			   SPI_MEM_OP_ADDR(3, 0, 1),
+			   SPI_MEM_OP_NO_DUMMY,
+			   SPI_MEM_OP_DATA_IN(*lenp, buf, 1));
+	int ret;
+
+	ret = spi_mem_adjust_op_size(nor->spi, &op);
+	if (ret)
+		return ret;
+
+	ret = spi_mem_exec_op(nor->spi, &op);
+	if (ret)
+		return ret;
+
+	*lenp = op.data.nbytes;
+
+	return 0;
+}
+
+/**
+ * spi_nor_read_selftest() - Check the selected read protocol
+ *
+ * @nor:	pointer to a 'struct spi_nor'
+ * @ref:	reference data, as read by spi_nor_read_reference()
+ * @len:	number of bytes in @ref
+ *
+ * Read the start of the flash with the selected read protocol and compare it
+ * with @ref. On mismatch, fall back to the next fastest protocol which passes.
+ * Board-level problems such as a missing pull-up or a too-high clock for the
+ * wider bus are thereby caught before they corrupt a boot image.
+ */
+static void spi_nor_read_selftest(struct spi_nor *nor, const u8 *ref,
+				  size_t len)
+{
+	ALLOC_CACHE_ALIGN_BUFFER(u8, buf, SPI_NOR_SELFTEST_LEN);
+	u32 hwcaps = nor->read_hwcaps;
+	u32 hwcap = nor->read_hwcap;
+	int bit;
+
+	while (nor->read(nor, 0, len, buf) != len || memcmp(buf, ref, len)) {
+		dev_dbg(nor->dev, "read self-test failed for opcode %02x\n",
+			nor->read_opcode);
+		nor->read_hwcaps &= ~nor->read_hwcap;
+
+		for (bit = fls(nor->read_hwcaps) - 1; bit >= 0; bit--) {
+			if (!spi_nor_select_read_hwcap(nor, BIT(bit)))
+				break;
+		}
+		if (bit < 0)
+			goto fail;
+	}
+
+	if (nor->read_hwcap != hwcap)
+		dev_warn(nor->dev, "falling back to read opcode %02x\n",
+			 nor->read_opcode);
+
+	return;
+
+fail:
+	/*
+	 * Nothing matched, so the reference read is probably the culprit (e.g.
+	 * the flash came up in 4-byte address mode). Keep the original choice.
+	 */
+	dev_warn(nor->dev, "read self-test inconclusive\n");
+	nor->read_hwcaps = hwcaps;
+	if (hwcap)
+		spi_nor_select_read_hwcap(nor, hwcap);
+}
+#endif /* SPI_FLASH_READ_SELFTEST */
+
 static int spi_nor_select_pp(struct spi_nor *nor,
 			     const struct spi_nor_flash_parameter *params,
 			     u32 shared_hwcaps)
@@ -4475,6 +4620,11 @@ int spi_nor_scan(struct spi_nor *nor)
 	int ret;
 	int cfi_mtd_nb = 0;
 	bool shift = 0;
+#if CONFIG_IS_ENABLED(SPI_FLASH_READ_SELFTEST)
+	ALLOC_CACHE_ALIGN_BUFFER(u8, ref, SPI_NOR_SELFTEST_LEN);
+	size_t ref_len = SPI_NOR_SELFTEST_LEN;
+	bool selftest;
+#endif
 
 #ifdef CONFIG_FLASH_CFI_MTD
 	cfi_mtd_nb = CFI_FLASH_BANKS;
@@ -4636,11 +4786,21 @@ int spi_nor_scan(struct spi_nor *nor)
 		return -EINVAL;
 	}
 
+#if CONFIG_IS_ENABLED(SPI_FLASH_READ_SELFTEST)
+	selftest = !(nor->flags & (SNOR_F_HAS_PARALLEL | SNOR_F_HAS_STACKED)) &&
+		   !spi_nor_read_reference(nor, ref, &ref_len);
+#endif
+
 	/* Send all the required SPI flash commands to initialize device */
 	ret = spi_nor_init(nor);
 	if (ret)
 		return ret;
 
+#if CONFIG_IS_ENABLED(SPI_FLASH_READ_SELFTEST)
+	if (selftest)
+		spi_nor_read_selftest(nor, ref, ref_len);
+#endif
+
 	if (nor->flags & SNOR_F_HAS_STACKED) {
 		nor->spi->flags |= SPI_XFER_U_PAGE;
 		ret = spi_nor_init(nor);
@@ -1066,15 +1066,31 @@ int ubispl_load_volumes(struct ubispl_info *info, struct ubispl_load *lvols,
 			int nrvols)
 {
 	struct ubi_scan_info *ubi = info->ubi;
-	int res, i, fastmap = info->fastmap;
+	int res, i, fastmap = info->fastmap, rescan = 0;
 	u32 fsize;
 
 retry:
-	/*
-	 * We do a partial initializiation of @ubi. Cleaning fm_buf is
-	 * not necessary.
-	 */
-	memset(ubi, 0, offsetof(struct ubi_scan_info, fm_buf));
+	if (!rescan) {
+		/*
+		 * We do a partial initializiation of @ubi. Cleaning fm_buf is
+		 * not necessary.
+		 */
+		memset(ubi, 0, offsetof(struct ubi_scan_info, fm_buf));
+	} else {
+		/*
+		 * The fastmap was not usable. The VID headers which have been
+		 * read successfully still describe what is on the flash, so
+		 * keep them and the scanned bits for the full scan instead of
+		 * reading them again. Everything derived from the fastmap is
+		 * cleared, including the corrupt bits as those might have
+		 * been set because of stale fastmap data.
+		 */
+		for (i = 0; i < UBI_FM_BM_SIZE; i++)
+			ubi->scanned[i] &= ~ubi->corrupt[i];
+		memset(ubi, 0, offsetof(struct ubi_scan_info, scanned));
+		memset(ubi->corrupt, 0, offsetof(struct ubi_scan_info, blockinfo) -
+		       offsetof(struct ubi_scan_info, corrupt));
+	}
 
 	ubi->read = info->read;
 
@@ -1128,6 +1144,7 @@ retry:
 		if (res < 0) {
 			if (fastmap) {
 				fastmap = 0;
+				rescan = 1;
 				goto retry;
 			}
 			ubi_warn("Failed");
@@ -70,7 +70,9 @@ struct ubi_vol_info {
  * @fm_enabled:		Indicator whether fastmap attachment is enabled.
  * @fm_used:		Bitmap to indicate the PEBS covered by fastmap
  * @scanned:		Bitmap to indicate the PEBS of which the VID header
- *			hase been physically scanned.
+ *			hase been physically scanned. Together with @blockinfo
+ *			it is kept when falling back from fastmap to a full
+ *			scan, so the member order up to @blockinfo matters.
  * @corrupt:		Bitmap to indicate corrupt blocks
  * @toload:		Bitmap to indicate the volumes which should be loaded
  *
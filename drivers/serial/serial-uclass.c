@@ -6,6 +6,7 @@
 #define LOG_CATEGORY UCLASS_SERIAL
 
 #include <config.h>
+#include <cyclic.h>
 #include <dm.h>
 #include <env_internal.h>
 #include <errno.h>
@@ -233,10 +234,137 @@ int serial_initialize(void)
 	return serial_init();
 }
 
+#if CONFIG_IS_ENABLED(SERIAL_TX_BUFFER)
+/* Check whether output for this device goes via the TX buffer */
+static bool serial_tx_buffered(struct udevice *dev)
+{
+	struct serial_dev_priv *upriv = dev_get_uclass_priv(dev);
+
+	/* If re-entered while draining, write directly to the UART */
+	return upriv->tx_dev && !upriv->tx_busy;
+}
+
+/* Send as much of the TX buffer as the UART will take, without waiting */
+static void serial_tx_drain(struct udevice *dev)
+{
+	struct serial_dev_priv *upriv = dev_get_uclass_priv(dev);
+	struct dm_serial_ops *ops = serial_get_ops(dev);
+	uint rd, len;
+	int ret;
+
+	if (upriv->tx_busy)
+		return;
+	upriv->tx_busy = true;
+	while (upriv->tx_rd_ptr != upriv->tx_wr_ptr) {
+		rd = upriv->tx_rd_ptr % CONFIG_SERIAL_TX_BUFFER_SIZE;
+		if (CONFIG_IS_ENABLED(SERIAL_PUTS) && ops->puts) {
+			len = min(upriv->tx_wr_ptr - upriv->tx_rd_ptr,
+				  CONFIG_SERIAL_TX_BUFFER_SIZE - rd);
+			ret = ops->puts(dev, upriv->tx_buf + rd, len);
+		} else {
+			ret = ops->putc(dev, upriv->tx_buf[rd]);
+			if (!ret)
+				ret = 1;
+		}
+		if (!ret || ret == -EAGAIN)
+			break;
+		if (ret < 0) {
+			/* Drop the output, as _serial_puts() does on error */
+			upriv->tx_rd_ptr = upriv->tx_wr_ptr;
+			break;
+		}
+		upriv->tx_rd_ptr += ret;
+	}
+	upriv->tx_busy = false;
+}
+
+static void serial_tx_put(struct udevice *dev, char ch)
+{
+	struct serial_dev_priv *upriv = dev_get_uclass_priv(dev);
+
+	BUILD_BUG_ON_NOT_POWER_OF_2(CONFIG_SERIAL_TX_BUFFER_SIZE);
+
+	/* If the buffer is full, wait for the UART to make room */
+	while (upriv->tx_wr_ptr - upriv->tx_rd_ptr ==
+	       CONFIG_SERIAL_TX_BUFFER_SIZE)
+		serial_tx_drain(dev);
+	upriv->tx_buf[upriv->tx_wr_ptr++ % CONFIG_SERIAL_TX_BUFFER_SIZE] = ch;
+}
+
+/* Send everything in the TX buffer, waiting as needed */
+static void serial_tx_flush(struct udevice *dev)
+{
+	struct serial_dev_priv *upriv = dev_get_uclass_priv(dev);
+
+	while (upriv->tx_rd_ptr != upriv->tx_wr_ptr && !upriv->tx_busy)
+		serial_tx_drain(dev);
+}
+
+static void serial_tx_cyclic(struct cyclic_info *c)
+{
+	struct serial_dev_priv *upriv;
+
+	upriv = container_of(c, struct serial_dev_priv, tx_cyclic);
+	serial_tx_drain(upriv->tx_dev);
+}
+
+static void serial_tx_start(struct udevice *dev)
+{
+	struct serial_dev_priv *upriv = dev_get_uclass_priv(dev);
+
+	/* Devices are probed again after relocation, so start then */
+	if (!(gd->flags & GD_FLG_RELOC))
+		return;
+
+	upriv->tx_dev = dev;
+	/* Drain as often as possible, since this never waits for the UART */
+	cyclic_register(&upriv->tx_cyclic, serial_tx_cyclic, 0, dev->name);
+}
+
+static void serial_tx_stop(struct udevice *dev)
+{
+	struct serial_dev_priv *upriv = dev_get_uclass_priv(dev);
+
+	if (!upriv->tx_dev)
+		return;
+	serial_tx_flush(dev);
+	cyclic_unregister(&upriv->tx_cyclic);
+	upriv->tx_dev = NULL;
+}
+
+#else /* CONFIG_IS_ENABLED(SERIAL_TX_BUFFER) */
+
+static inline bool serial_tx_buffered(struct udevice *dev)
+{
+	return false;
+}
+
+static inline void serial_tx_drain(struct udevice *dev)
+{
+}
+
+static inline void serial_tx_put(struct udevice *dev, char ch)
+{
+}
+
+static inline void serial_tx_flush(struct udevice *dev)
+{
+}
+
+static inline void serial_tx_start(struct udevice *dev)
+{
+}
+
+static inline void serial_tx_stop(struct udevice *dev)
+{
+}
+#endif /* CONFIG_IS_ENABLED(SERIAL_TX_BUFFER) */
+
 static void _serial_flush(struct udevice *dev)
 {
 	struct dm_serial_ops *ops = serial_get_ops(dev);
 
+	serial_tx_flush(dev);
 	if (!ops->pending)
 		return;
 	while (ops->pending(dev, false) > 0)
@@ -251,9 +379,14 @@ static void _serial_putc(struct udevice *dev, char ch)
 	if (ch == '\n')
 		_serial_putc(dev, '\r');
 
-	do {
-		err = ops->putc(dev, ch);
-	} while (err == -EAGAIN);
+	if (serial_tx_buffered(dev)) {
+		serial_tx_put(dev, ch);
+		serial_tx_drain(dev);
+	} else {
+		do {
+			err = ops->putc(dev, ch);
+		} while (err == -EAGAIN);
+	}
 
 	if (IS_ENABLED(CONFIG_CONSOLE_FLUSH_ON_NEWLINE) && ch == '\n')
 		_serial_flush(dev);
@@ -279,6 +412,22 @@ static void _serial_puts(struct udevice *dev, const char *str)
 {
 	struct dm_serial_ops *ops = serial_get_ops(dev);
 
+	if (serial_tx_buffered(dev)) {
+		bool newline = false;
+
+		while (*str) {
+			if (*str == '\n') {
+				serial_tx_put(dev, '\r');
+				newline = true;
+			}
+			serial_tx_put(dev, *str++);
+		}
+		serial_tx_drain(dev);
+		if (IS_ENABLED(CONFIG_CONSOLE_FLUSH_ON_NEWLINE) && newline)
+			_serial_flush(dev);
+		return;
+	}
+
 	if (!CONFIG_IS_ENABLED(SERIAL_PUTS) || !ops->puts) {
 		while (*str)
 			_serial_putc(dev, *str++);
@@ -574,6 +723,7 @@ static int serial_post_probe(struct udevice *dev)
 		if (ret)
 			return ret;
 	}
+	serial_tx_start(dev);
 
 #if CONFIG_IS_ENABLED(DM_STDIO)
 	if (!(gd->flags & GD_FLG_RELOC))
@@ -602,6 +752,7 @@ static int serial_pre_remove(struct udevice *dev)
 	if (stdio_deregister_dev(upriv->sdev, true))
 		return -EPERM;
 #endif
+	serial_tx_stop(dev);
 
 	return 0;
 }
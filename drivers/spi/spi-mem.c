@@ -13,12 +13,17 @@
 #include <linux/pm_runtime.h>
 #include "internals.h"
 #else
+#include <cpu_func.h>
 #include <dm.h>
+#include <dma.h>
 #include <errno.h>
 #include <malloc.h>
+#include <mapmem.h>
 #include <spi.h>
 #include <spi.h>
 #include <spi-mem.h>
+#include <asm/cache.h>
+#include <asm/io.h>
 #include <dm/device_compat.h>
 #include <dm/devres.h>
 #include <linux/bug.h>
@@ -571,6 +576,114 @@ static ssize_t spi_mem_no_dirmap_write(struct spi_mem_dirmap_desc *desc,
 	return op.data.nbytes;
 }
 
+#ifdef __UBOOT__
+/*
+ * Reads shorter than this are copied by the CPU, setting up a DMA transfer
+ * costs more than it saves.
+ */
+#define SPI_MEM_MMAP_DMA_MIN	256
+
+/*
+ * Generic direct mapping for controllers which do not implement
+ * ->mem_ops->dirmap_create() but expose a memory-mapped (XIP) window on the
+ * SPI memory through ->get_mmap(). Only read mappings which fit entirely
+ * within the window are handled.
+ */
+static int spi_mem_mmap_dirmap_create(struct spi_mem_dirmap_desc *desc)
+{
+	const struct spi_mem_dirmap_info *info = &desc->info;
+	ulong map_base;
+	uint map_size, map_offset;
+	int ret;
+
+	if (info->op_tmpl.data.dir != SPI_MEM_DATA_IN)
+		return -EOPNOTSUPP;
+
+	ret = dm_spi_get_mmap(desc->slave->dev, &map_base, &map_size,
+			      &map_offset);
+	if (ret)
+		return -EOPNOTSUPP;
+
+	if (info->offset < map_offset ||
+	    info->offset + info->length > (u64)map_offset + map_size)
+		return -EOPNOTSUPP;
+
+	desc->map = map_sysmem(map_base + (info->offset - map_offset),
+			       info->length);
+	desc->map_op = info->op_tmpl;
+
+	return 0;
+}
+
+/*
+ * Check that the operation template still uses the protocol which the
+ * memory-mapped window was set up with. SPI NOR updates the template on
+ * every read, e.g. when 'sf bench' switches between read protocols.
+ */
+static bool spi_mem_mmap_op_matches(const struct spi_mem_op *a,
+				    const struct spi_mem_op *b)
+{
+	return a->cmd.opcode == b->cmd.opcode &&
+	       a->cmd.nbytes == b->cmd.nbytes &&
+	       a->cmd.buswidth == b->cmd.buswidth &&
+	       a->cmd.dtr == b->cmd.dtr &&
+	       a->addr.nbytes == b->addr.nbytes &&
+	       a->addr.buswidth == b->addr.buswidth &&
+	       a->addr.dtr == b->addr.dtr &&
+	       a->dummy.nbytes == b->dummy.nbytes &&
+	       a->dummy.buswidth == b->dummy.buswidth &&
+	       a->dummy.dtr == b->dummy.dtr &&
+	       a->data.buswidth == b->data.buswidth &&
+	       a->data.dtr == b->data.dtr;
+}
+
+static ssize_t spi_mem_mmap_dirmap_read(struct spi_mem_dirmap_desc *desc,
+					u64 offs, size_t len, void *buf)
+{
+	void *src;
+
+	if (offs >= desc->info.length)
+		return -EINVAL;
+
+	/* the window cannot switch protocol, so use a normal read instead */
+	if (!spi_mem_mmap_op_matches(&desc->info.op_tmpl, &desc->map_op))
+		return spi_mem_no_dirmap_read(desc, offs, len, buf);
+
+	len = min_t(u64, len, desc->info.length - offs);
+	src = desc->map + offs;
+
+	if (!CONFIG_IS_ENABLED(DMA) || len < SPI_MEM_MMAP_DMA_MIN ||
+	    dma_memcpy(buf, src, len) < 0)
+		memcpy_fromio(buf, src, len);
+
+	return len;
+}
+
+/**
+ * spi_mem_dirmap_invalidate() - Drop cached data read through a direct mapping
+ * @desc: direct mapping descriptor, may be NULL
+ * @offs: offset within the direct mapping of the data which changed
+ * @len: length in bytes
+ *
+ * This must be called after the memory is changed by other means, e.g. a
+ * program or erase operation, so that later reads through a memory-mapped
+ * window do not return stale data from the CPU cache.
+ */
+void spi_mem_dirmap_invalidate(struct spi_mem_dirmap_desc *desc, u64 offs,
+			       size_t len)
+{
+	ulong start, end;
+
+	if (!desc || !desc->map || offs >= desc->info.length)
+		return;
+
+	len = min_t(u64, len, desc->info.length - offs);
+	start = ALIGN_DOWN((ulong)desc->map + offs, ARCH_DMA_MINALIGN);
+	end = ALIGN((ulong)desc->map + offs + len, ARCH_DMA_MINALIGN);
+	invalidate_dcache_range(start, end);
+}
+#endif /* __UBOOT__ */
+
 /**
  * spi_mem_dirmap_create() - Create a direct mapping descriptor
  * @mem: SPI mem device this direct mapping should be created for
@@ -579,8 +692,10 @@ static ssize_t spi_mem_no_dirmap_write(struct spi_mem_dirmap_desc *desc,
  * This function is creating a direct mapping descriptor which can then be used
  * to access the memory using spi_mem_dirmap_read() or spi_mem_dirmap_write().
  * If the SPI controller driver does not support direct mapping, this function
- * falls back to an implementation using spi_mem_exec_op(), so that the caller
- * doesn't have to bother implementing a fallback on his own.
+ * uses the memory-mapped window reported by the controller's ->get_mmap(), if
+ * any, and otherwise falls back to an implementation using spi_mem_exec_op(),
+ * so that the caller doesn't have to bother implementing a fallback on his
+ * own.
  *
  * Return: a valid pointer in case of success, and ERR_PTR() otherwise.
  */
@@ -609,6 +724,10 @@ spi_mem_dirmap_create(struct spi_slave *slave,
 	desc->info = *info;
 	if (ops->mem_ops && ops->mem_ops->dirmap_create)
 		ret = ops->mem_ops->dirmap_create(desc);
+#ifdef __UBOOT__
+	else
+		ret = spi_mem_mmap_dirmap_create(desc);
+#endif
 
 	if (ret) {
 		desc->nodirmap = true;
@@ -641,6 +760,10 @@ void spi_mem_dirmap_destroy(struct spi_mem_dirmap_desc *desc)
 
 	if (!desc->nodirmap && ops->mem_ops && ops->mem_ops->dirmap_destroy)
 		ops->mem_ops->dirmap_destroy(desc);
+#ifdef __UBOOT__
+	if (desc->map)
+		unmap_sysmem(desc->map);
+#endif
 
 	kfree(desc);
 }
@@ -748,6 +871,10 @@ ssize_t spi_mem_dirmap_read(struct spi_mem_dirmap_desc *desc,
 
 	if (desc->nodirmap)
 		ret = spi_mem_no_dirmap_read(desc, offs, len, buf);
+#ifdef __UBOOT__
+	else if (desc->map)
+		ret = spi_mem_mmap_dirmap_read(desc, offs, len, buf);
+#endif
 	else if (ops->mem_ops && ops->mem_ops->dirmap_read)
 		ret = ops->mem_ops->dirmap_read(desc, offs, len, buf);
 	else
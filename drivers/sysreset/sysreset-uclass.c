@@ -14,6 +14,7 @@
 #include <log.h>
 #include <regmap.h>
 #include <spl.h>
+#include <stdio.h>
 #include <sysreset.h>
 #include <dm/device-internal.h>
 #include <dm/lists.h>
@@ -57,6 +58,9 @@ int sysreset_walk(enum sysreset_t type)
 	struct udevice *dev;
 	int ret = -ENOSYS;
 
+	/* Send any console output which is still buffered */
+	flush();
+
 	while (ret != -EINPROGRESS && type < SYSRESET_COUNT) {
 		for (uclass_first_device(UCLASS_SYSRESET, &dev);
 		     dev;
@@ -268,8 +268,8 @@ static int sandbox_hub_submit_control_msg(struct udevice *bus,
 					ret = clrset_post_state(bus, port,
 							1 << setup->value, 0);
 				} else {
-					priv->change[port] &= 1 <<
-						(setup->value - 16);
+					priv->change[port] &= ~(1 <<
+						(setup->value - 16));
 				}
 				udev->status = 0;
 				return 0;
@@ -478,6 +478,48 @@ out:
 	return ret;
 }
 
+int usb_rescan(void)
+{
+	struct udevice *bus, *hub;
+	struct uclass *uc;
+	int changes = 0;
+	int ret;
+
+	if (!usb_started)
+		return usb_init();
+
+	uthread_mutex_lock(&mutex);
+
+	ret = uclass_get(UCLASS_USB, &uc);
+	if (ret)
+		goto out;
+
+	uclass_foreach_dev(bus, uc) {
+		if (!device_active(bus))
+			continue;
+
+		device_foreach_child(hub, bus) {
+			if (device_get_uclass_id(hub) != UCLASS_USB_HUB ||
+			    !device_active(hub))
+				continue;
+
+			ret = usb_hub_rescan(hub);
+			if (ret < 0) {
+				printf("Bus %s: rescan failed, error %d\n",
+				       bus->name, ret);
+				continue;
+			}
+			changes += ret;
+		}
+	}
+	ret = changes;
+	log_debug("USB rescan found %d change(s)\n", changes);
+out:
+	uthread_mutex_unlock(&mutex);
+
+	return ret;
+}
+
 int usb_setup_ehci_gadget(struct ehci_ctrl **ctlrp)
 {
 	struct usb_plat *plat;
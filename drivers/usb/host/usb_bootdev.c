@@ -21,6 +21,14 @@ static int usb_bootdev_bind(struct udevice *dev)
 
 static int usb_bootdev_hunt(struct bootdev_hunter *info, bool show)
 {
+	int ret;
+
+	/* Avoid resetting the bus just to pick up newly attached devices */
+	if (IS_ENABLED(CONFIG_USB_RESCAN)) {
+		ret = usb_rescan();
+
+		return ret < 0 ? ret : 0;
+	}
 	if (usb_started)
 		return 0;
 
@@ -12,6 +12,7 @@
 #include <spl.h>
 #include <video.h>
 #include <video_console.h>
+#include <linux/list.h>
 
 /* Functions needed by stb_truetype.h */
 static int tt_floor(double val)
@@ -169,6 +170,8 @@ struct console_tt_metrics {
  *		last character. We record enough characters to go back to the
  *		start of the current command line.
  * @pos_ptr:	Current position in the position history
+ * @cache:	Glyph cache, or NULL if none. This is a pointer so that it is
+ *		not affected by truetype_entry_save/restore()
  */
 struct console_tt_priv {
 	struct console_tt_metrics *cur_met;
@@ -176,6 +179,7 @@ struct console_tt_priv {
 	int num_metrics;
 	struct pos_info pos[POS_HISTORY_SIZE];
 	int pos_ptr;
+	struct tt_glyph_cache *cache;
 };
 
 /**
@@ -189,84 +193,185 @@ struct console_tt_store {
 	struct pos_info cur;
 };
 
-static int console_truetype_set_row(struct udevice *dev, uint row, int clr)
+/* Number of hash buckets in the glyph cache (must be a power of two) */
+#define GLYPH_HASH_SIZE		64
+
+/**
+ * struct tt_glyph - A rendered glyph held in the glyph cache
+ *
+ * Glyphs are keyed by the font data and size (rather than the metrics pointer,
+ * which can be reused after truetype_entry_restore()), the codepoint and the
+ * exact sub-pixel X offset, so that a cached glyph is identical to a freshly
+ * rendered one.
+ *
+ * @hash:	Node in the hash bucket
+ * @sibling:	Node in the LRU list, most-recently used first
+ * @font_data:	Font data used to render the glyph
+ * @font_size:	Font size used to render the glyph
+ * @cp:		Unicode codepoint
+ * @shift:	Sub-pixel X offset, as the raw bits of the double
+ * @width:	Width of bitmap in pixels
+ * @height:	Height of bitmap in pixels
+ * @xoff:	X offset of the bitmap from the cursor position
+ * @yoff:	Y offset of the bitmap from the baseline
+ * @data:	8bpp alpha bitmap, as returned by stbtt, or NULL if the glyph
+ *		is empty (e.g. a space)
+ * @size:	Number of bytes charged to the cache for this glyph
+ */
+struct tt_glyph {
+	struct hlist_node hash;
+	struct list_head sibling;
+	const u8 *font_data;
+	int font_size;
+	int cp;
+	u64 shift;
+	int width;
+	int height;
+	int xoff;
+	int yoff;
+	u8 *data;
+	uint size;
+};
+
+/**
+ * struct tt_glyph_cache - Cache of rendered glyphs
+ *
+ * @hash:	Hash buckets, each a list of struct tt_glyph
+ * @lru:	List of all glyphs, most-recently used first
+ * @used:	Number of bytes in use
+ * @limit:	Maximum number of bytes to use
+ * @hits:	Number of lookups which found a glyph
+ * @misses:	Number of lookups which had to render a glyph
+ */
+struct tt_glyph_cache {
+	struct hlist_head hash[GLYPH_HASH_SIZE];
+	struct list_head lru;
+	uint used;
+	uint limit;
+	uint hits;
+	uint misses;
+};
+
+static uint glyph_hash(const u8 *font_data, int font_size, int cp, u64 shift)
 {
-	struct video_priv *vid_priv = dev_get_uclass_priv(dev->parent);
-	struct vidconsole_priv *vc_priv = dev_get_uclass_priv(dev);
-	struct console_tt_priv *priv = dev_get_priv(dev);
-	struct console_tt_metrics *met = priv->cur_met;
-	void *end, *line;
+	ulong val;
 
-	line = vid_priv->fb + row * met->font_size * vid_priv->line_length;
-	end = line + met->font_size * vid_priv->line_length;
+	val = (ulong)font_data ^ font_size * 31 ^ cp * 2654435761U;
+	val ^= shift ^ shift >> 32;
 
-	switch (vid_priv->bpix) {
-	case VIDEO_BPP8: {
-		u8 *dst;
+	return (val ^ val >> 7 ^ val >> 17) & (GLYPH_HASH_SIZE - 1);
+}
 
-		if (IS_ENABLED(CONFIG_VIDEO_BPP8)) {
-			for (dst = line; dst < (u8 *)end; ++dst)
-				*dst = clr;
-		}
-		break;
-	}
-	case VIDEO_BPP16: {
-		u16 *dst = line;
+static void glyph_free(struct tt_glyph_cache *cache, struct tt_glyph *glyph)
+{
+	hlist_del(&glyph->hash);
+	list_del(&glyph->sibling);
+	cache->used -= glyph->size;
+	free(glyph->data);
+	free(glyph);
+}
 
-		if (IS_ENABLED(CONFIG_VIDEO_BPP16)) {
-			for (dst = line; dst < (u16 *)end; ++dst)
-				*dst = clr;
+/**
+ * glyph_get() - Get a rendered glyph, using the cache if possible
+ *
+ * If the glyph is not in the cache it is rendered and added, evicting the
+ * least-recently used glyphs to make space. If there is no cache, or the glyph
+ * cannot be added, it is returned in @tmp and the caller must free tmp->data
+ *
+ * @priv:	Private data
+ * @met:	Metrics to use to render the glyph
+ * @cp:		Unicode codepoint
+ * @x_shift:	Sub-pixel X offset, 0 <= x_shift < 1
+ * @tmp:	Place to put the glyph if it is not cached
+ * Return: glyph (either in the cache, or @tmp)
+ */
+static struct tt_glyph *glyph_get(struct console_tt_priv *priv,
+				  struct console_tt_metrics *met, int cp,
+				  double x_shift, struct tt_glyph *tmp)
+{
+	struct tt_glyph_cache *cache = priv->cache;
+	struct tt_glyph *glyph;
+	struct hlist_head *head;
+	u64 shift;
+	uint size;
+
+	memcpy(&shift, &x_shift, sizeof(shift));
+	if (cache) {
+		head = &cache->hash[glyph_hash(met->font_data, met->font_size,
+					       cp, shift)];
+		hlist_for_each_entry(glyph, head, hash) {
+			if (glyph->cp == cp && glyph->shift == shift &&
+			    glyph->font_data == met->font_data &&
+			    glyph->font_size == met->font_size) {
+				list_move(&glyph->sibling, &cache->lru);
+				cache->hits++;
+				return glyph;
+			}
 		}
-		break;
+		cache->misses++;
 	}
-	case VIDEO_BPP32: {
-		u32 *dst = line;
 
-		if (IS_ENABLED(CONFIG_VIDEO_BPP32)) {
-			for (dst = line; dst < (u32 *)end; ++dst)
-				*dst = clr;
-		}
-		break;
-	}
-	default:
-		return -ENOSYS;
-	}
+	tmp->data = stbtt_GetCodepointBitmapSubpixel(&met->font, met->scale,
+						     met->scale, x_shift, 0, cp,
+						     &tmp->width, &tmp->height,
+						     &tmp->xoff, &tmp->yoff);
+	if (!cache)
+		return tmp;
+
+	size = sizeof(*glyph);
+	if (tmp->data)
+		size += tmp->width * tmp->height;
+	if (size > cache->limit)
+		return tmp;
+	while (cache->used + size > cache->limit)
+		glyph_free(cache, list_last_entry(&cache->lru, struct tt_glyph,
+						  sibling));
+
+	glyph = malloc(sizeof(*glyph));
+	if (!glyph)
+		return tmp;
+	*glyph = *tmp;
+	glyph->font_data = met->font_data;
+	glyph->font_size = met->font_size;
+	glyph->cp = cp;
+	glyph->shift = shift;
+	glyph->size = size;
+	hlist_add_head(&glyph->hash, head);
+	list_add(&glyph->sibling, &cache->lru);
+	cache->used += size;
+
+	return glyph;
+}
 
-	video_damage(dev->parent,
-		     0,
-		     vc_priv->y_charsize * row,
-		     vid_priv->xsize,
-		     vc_priv->y_charsize);
+static int console_truetype_set_row(struct udevice *dev, uint row, int clr)
+{
+	struct video_priv *vid_priv = dev_get_uclass_priv(dev->parent);
+	struct console_tt_priv *priv = dev_get_priv(dev);
+	struct console_tt_metrics *met = priv->cur_met;
 
-	return 0;
+	return video_fill_rect(dev->parent, 0, row * met->font_size,
+			       vid_priv->xsize, met->font_size, clr);
 }
 
 static int console_truetype_move_rows(struct udevice *dev, uint rowdst,
 				     uint rowsrc, uint count)
 {
 	struct video_priv *vid_priv = dev_get_uclass_priv(dev->parent);
-	struct vidconsole_priv *vc_priv = dev_get_uclass_priv(dev);
 	struct console_tt_priv *priv = dev_get_priv(dev);
 	struct console_tt_metrics *met = priv->cur_met;
-	void *dst;
-	void *src;
-	int i, diff;
+	int i, diff, ret;
 
-	dst = vid_priv->fb + rowdst * met->font_size * vid_priv->line_length;
-	src = vid_priv->fb + rowsrc * met->font_size * vid_priv->line_length;
-	memmove(dst, src, met->font_size * vid_priv->line_length * count);
+	ret = video_copy_rect(dev->parent, 0, rowdst * met->font_size, 0,
+			      rowsrc * met->font_size, vid_priv->xsize,
+			      met->font_size * count);
+	if (ret)
+		return ret;
 
 	/* Scroll up our position history */
 	diff = (rowsrc - rowdst) * met->font_size;
 	for (i = 0; i < priv->pos_ptr; i++)
 		priv->pos[i].ypos -= diff;
 
-	video_damage(dev->parent,
-		     0,
-		     vc_priv->y_charsize * rowdst,
-		     vid_priv->xsize,
-		     vc_priv->y_charsize * count);
-
 	return 0;
 }
 
@@ -275,19 +380,18 @@ static int console_truetype_putc_xy(struct udevice *dev, uint x, uint y,
 {
 	struct vidconsole_priv *vc_priv = dev_get_uclass_priv(dev);
 	struct udevice *vid = dev->parent;
-	struct video_priv *vid_priv = dev_get_uclass_priv(vid);
 	struct console_tt_priv *priv = dev_get_priv(dev);
 	struct console_tt_metrics *met = priv->cur_met;
 	stbtt_fontinfo *font = &met->font;
+	struct tt_glyph *glyph, tmp;
 	int width, height, xoff, yoff;
 	double xpos, x_shift;
 	int lsb;
 	int width_frac, linenum;
 	struct pos_info *pos;
-	u8 *bits, *data;
 	int advance;
-	void *start, *end, *line;
-	int row;
+	u8 *data;
+	int ret;
 
 	/* First get some basic metrics about this character */
 	stbtt_GetCodepointHMetrics(font, cp, &advance, &lsb);
@@ -326,115 +430,29 @@ static int console_truetype_putc_xy(struct udevice *dev, uint x, uint y,
 	 * Figure out how much past the start of a pixel we are, and pass this
 	 * information into the render, which will return a 8-bit-per-pixel
 	 * image of the character. For empty characters, like ' ', data will
-	 * return NULL;
+	 * return NULL. The image comes from the glyph cache if possible.
 	 */
-	data = stbtt_GetCodepointBitmapSubpixel(font, met->scale, met->scale,
-						x_shift, 0, cp, &width, &height,
-						&xoff, &yoff);
+	glyph = glyph_get(priv, met, cp, x_shift, &tmp);
+	data = glyph->data;
 	if (!data)
 		return width_frac;
-
-	/* Figure out where to write the character in the frame buffer */
-	bits = data;
-	start = vid_priv->fb + y * vid_priv->line_length +
-		VID_TO_PIXEL(x) * VNBYTES(vid_priv->bpix);
-	linenum = met->baseline + yoff;
-	if (linenum > 0)
-		start += linenum * vid_priv->line_length;
-	line = start;
+	width = glyph->width;
+	height = glyph->height;
+	xoff = glyph->xoff;
+	yoff = glyph->yoff;
 
 	/*
-	 * Write a row at a time, converting the 8bpp image into the colour
-	 * depth of the display. We only expect white-on-black or the reverse
-	 * so the code only handles this simple case.
+	 * Figure out where to write the character in the frame buffer, then
+	 * combine the 8bpp image with it. We only expect white-on-black or the
+	 * reverse, which is what video_blit_alpha() handles.
 	 */
-	for (row = 0; row < height; row++) {
-		switch (vid_priv->bpix) {
-		case VIDEO_BPP8:
-			if (IS_ENABLED(CONFIG_VIDEO_BPP8)) {
-				u8 *dst = line + xoff;
-				int i;
-
-				for (i = 0; i < width; i++) {
-					int val = *bits;
-					int out;
-
-					if (vid_priv->colour_bg)
-						val = 255 - val;
-					out = val;
-					if (vid_priv->colour_fg)
-						*dst++ |= out;
-					else
-						*dst++ &= out;
-					bits++;
-				}
-				end = dst;
-			}
-			break;
-		case VIDEO_BPP16: {
-			uint16_t *dst = (uint16_t *)line + xoff;
-			int i;
-
-			if (IS_ENABLED(CONFIG_VIDEO_BPP16)) {
-				for (i = 0; i < width; i++) {
-					int val = *bits;
-					int out;
-
-					if (vid_priv->colour_bg)
-						val = 255 - val;
-					out = val >> 3 |
-						(val >> 2) << 5 |
-						(val >> 3) << 11;
-					if (vid_priv->colour_fg)
-						*dst++ |= out;
-					else
-						*dst++ &= out;
-					bits++;
-				}
-				end = dst;
-			}
-			break;
-		}
-		case VIDEO_BPP32: {
-			u32 *dst = (u32 *)line + xoff;
-			int i;
-
-			if (IS_ENABLED(CONFIG_VIDEO_BPP32)) {
-				for (i = 0; i < width; i++) {
-					int val = *bits;
-					int out;
-
-					if (vid_priv->colour_bg)
-						val = 255 - val;
-					if (vid_priv->format == VIDEO_X2R10G10B10)
-						out = val << 2 | val << 12 | val << 22;
-					else
-						out = val | val << 8 | val << 16;
-					if (vid_priv->colour_fg)
-						*dst++ |= out;
-					else
-						*dst++ &= out;
-					bits++;
-				}
-				end = dst;
-			}
-			break;
-		}
-		default:
-			free(data);
-			return -ENOSYS;
-		}
-
-		line += vid_priv->line_length;
-	}
-
-	video_damage(dev->parent,
-		     VID_TO_PIXEL(x) + xoff,
-		     y + met->baseline + yoff,
-		     width,
-		     height);
-
-	free(data);
+	linenum = met->baseline + yoff;
+	ret = video_blit_alpha(vid, VID_TO_PIXEL(x) + xoff,
+			       y + max(linenum, 0), width, height, data, width);
+	if (glyph == &tmp)
+		free(data);
+	if (ret)
+		return ret;
 
 	return width_frac;
 }
@@ -1060,11 +1078,66 @@ static int console_truetype_probe(struct udevice *dev)
 
 	select_metrics(dev, &priv->metrics[ret]);
 
+	if (CONFIG_CONSOLE_TRUETYPE_GLYPH_CACHE) {
+		struct tt_glyph_cache *cache;
+		int i;
+
+		/* The console still works without a cache, just more slowly */
+		cache = malloc(sizeof(*cache));
+		if (cache) {
+			for (i = 0; i < GLYPH_HASH_SIZE; i++)
+				INIT_HLIST_HEAD(&cache->hash[i]);
+			INIT_LIST_HEAD(&cache->lru);
+			cache->used = 0;
+			cache->limit = CONFIG_CONSOLE_TRUETYPE_GLYPH_CACHE * 1024;
+			cache->hits = 0;
+			cache->misses = 0;
+			priv->cache = cache;
+		} else {
+			log_debug("Cannot allocate glyph cache\n");
+		}
+	}
+
 	debug("%s: ready\n", __func__);
 
 	return 0;
 }
 
+static int console_truetype_remove(struct udevice *dev)
+{
+	struct console_tt_priv *priv = dev_get_priv(dev);
+	struct tt_glyph_cache *cache = priv->cache;
+
+	if (cache) {
+		while (!list_empty(&cache->lru))
+			glyph_free(cache, list_first_entry(&cache->lru,
+							   struct tt_glyph,
+							   sibling));
+		free(cache);
+		priv->cache = NULL;
+	}
+
+	return 0;
+}
+
+int console_truetype_glyph_stats(struct udevice *dev,
+				 struct vidconsole_glyph_stats *stats)
+{
+	struct console_tt_priv *priv;
+
+	if (dev->driver != DM_DRIVER_GET(vidconsole_truetype))
+		return -ENOSYS;
+	priv = dev_get_priv(dev);
+	if (!priv->cache)
+		return -ENOSYS;
+	stats->hits = priv->cache->hits;
+	stats->misses = priv->cache->misses;
+	stats->used = priv->cache->used;
+	stats->limit = priv->cache->limit;
+
+	return 0;
+}
+
 struct vidconsole_ops console_truetype_ops = {
 	.putc_xy	= console_truetype_putc_xy,
 	.move_rows	= console_truetype_move_rows,
@@ -1086,5 +1159,6 @@ U_BOOT_DRIVER(vidconsole_truetype) = {
 	.id	= UCLASS_VIDEO_CONSOLE,
 	.ops	= &console_truetype_ops,
 	.probe	= console_truetype_probe,
+	.remove	= console_truetype_remove,
 	.priv_auto	= sizeof(struct console_tt_priv),
 };
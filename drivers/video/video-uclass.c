@@ -166,25 +166,163 @@ ulong video_get_fb(void)
 	return 0;
 }
 
+/* Fill the first row, then copy it to the rest using the (optimised) memcpy */
+static int video_sw_fill_rect(struct video_priv *priv, int x, int y,
+			      int width, int height, u32 colour)
+{
+	int row_bytes = width * VNBYTES(priv->bpix);
+	void *first, *line;
+	int row, i;
+
+	first = priv->fb + y * priv->line_length;
+	first += x * VNBYTES(priv->bpix);
+	switch (priv->bpix) {
+	case VIDEO_BPP8:
+		if (IS_ENABLED(CONFIG_VIDEO_BPP8))
+			memset(first, colour, width);
+		break;
+	case VIDEO_BPP16: {
+		u16 *dst = first;
+
+		if (IS_ENABLED(CONFIG_VIDEO_BPP16)) {
+			for (i = 0; i < width; i++)
+				*dst++ = colour;
+		}
+		break;
+	}
+	case VIDEO_BPP32: {
+		u32 *dst = first;
+
+		if (IS_ENABLED(CONFIG_VIDEO_BPP32)) {
+			for (i = 0; i < width; i++)
+				*dst++ = colour;
+		}
+		break;
+	}
+	default:
+		return -ENOSYS;
+	}
+
+	line = first;
+	for (row = 1; row < height; row++) {
+		line += priv->line_length;
+		memcpy(line, first, row_bytes);
+	}
+
+	return 0;
+}
+
+int video_fill_rect(struct udevice *dev, int x, int y, int width, int height,
+		    u32 colour)
+{
+	struct video_priv *priv = dev_get_uclass_priv(dev);
+	struct video_ops *ops = video_get_ops(dev);
+	int ret = -ENOSYS;
+
+	if (width <= 0 || height <= 0)
+		return 0;
+	if (ops && ops->fill_rect)
+		ret = ops->fill_rect(dev, x, y, width, height, colour);
+	if (ret == -ENOSYS)
+		ret = video_sw_fill_rect(priv, x, y, width, height, colour);
+	if (ret)
+		return ret;
+
+	video_damage(dev, x, y, width, height);
+
+	return 0;
+}
+
 int video_fill_part(struct udevice *dev, int xstart, int ystart, int xend,
 		    int yend, u32 colour)
+{
+	return video_fill_rect(dev, xstart, ystart, xend - xstart,
+			       yend - ystart, colour);
+}
+
+static void video_sw_copy_rect(struct video_priv *priv, int dstx, int dsty,
+			       int srcx, int srcy, int width, int height)
+{
+	int pbytes = VNBYTES(priv->bpix);
+	int row_bytes = width * pbytes;
+	int step = priv->line_length;
+	void *dst, *src;
+	int row;
+
+	dst = priv->fb + dsty * priv->line_length + dstx * pbytes;
+	src = priv->fb + srcy * priv->line_length + srcx * pbytes;
+
+	/* Full-width rows are contiguous, so move them in one go */
+	if (row_bytes == priv->line_length) {
+		memmove(dst, src, row_bytes * height);
+		return;
+	}
+
+	/* Work upwards when moving down, so as not to overwrite the source */
+	if (dsty > srcy) {
+		dst += (height - 1) * priv->line_length;
+		src += (height - 1) * priv->line_length;
+		step = -step;
+	}
+	for (row = 0; row < height; row++) {
+		memmove(dst, src, row_bytes);
+		dst += step;
+		src += step;
+	}
+}
+
+int video_copy_rect(struct udevice *dev, int dstx, int dsty, int srcx, int srcy,
+		    int width, int height)
 {
 	struct video_priv *priv = dev_get_uclass_priv(dev);
-	void *start, *line;
-	int pixels = xend - xstart;
+	struct video_ops *ops = video_get_ops(dev);
+	int ret = -ENOSYS;
+
+	if (width <= 0 || height <= 0)
+		return 0;
+	if (ops && ops->copy_rect)
+		ret = ops->copy_rect(dev, dstx, dsty, srcx, srcy, width, height);
+	if (ret == -ENOSYS) {
+		video_sw_copy_rect(priv, dstx, dsty, srcx, srcy, width, height);
+		ret = 0;
+	}
+	if (ret)
+		return ret;
+
+	video_damage(dev, dstx, dsty, width, height);
+
+	return 0;
+}
+
+static int video_sw_blit_alpha(struct video_priv *priv, int x, int y,
+			       int width, int height, const u8 *alpha,
+			       int stride)
+{
+	bool invert = priv->colour_bg;
+	bool set = priv->colour_fg;
+	void *line;
 	int row, i;
 
-	start = priv->fb + ystart * priv->line_length;
-	start += xstart * VNBYTES(priv->bpix);
-	line = start;
-	for (row = ystart; row < yend; row++) {
+	line = priv->fb + y * priv->line_length;
+	line += x * VNBYTES(priv->bpix);
+	for (row = 0; row < height; row++) {
+		const u8 *bits = alpha;
+
 		switch (priv->bpix) {
 		case VIDEO_BPP8: {
 			u8 *dst = line;
 
 			if (IS_ENABLED(CONFIG_VIDEO_BPP8)) {
-				for (i = 0; i < pixels; i++)
-					*dst++ = colour;
+				for (i = 0; i < width; i++) {
+					int val = *bits++;
+
+					if (invert)
+						val = 255 - val;
+					if (set)
+						*dst++ |= val;
+					else
+						*dst++ &= val;
+				}
 			}
 			break;
 		}
@@ -192,8 +330,20 @@ int video_fill_part(struct udevice *dev, int xstart, int ystart, int xend,
 			u16 *dst = line;
 
 			if (IS_ENABLED(CONFIG_VIDEO_BPP16)) {
-				for (i = 0; i < pixels; i++)
-					*dst++ = colour;
+				for (i = 0; i < width; i++) {
+					int val = *bits++;
+					int out;
+
+					if (invert)
+						val = 255 - val;
+					out = val >> 3 |
+						(val >> 2) << 5 |
+						(val >> 3) << 11;
+					if (set)
+						*dst++ |= out;
+					else
+						*dst++ &= out;
+				}
 			}
 			break;
 		}
@@ -201,18 +351,52 @@ int video_fill_part(struct udevice *dev, int xstart, int ystart, int xend,
 			u32 *dst = line;
 
 			if (IS_ENABLED(CONFIG_VIDEO_BPP32)) {
-				for (i = 0; i < pixels; i++)
-					*dst++ = colour;
+				for (i = 0; i < width; i++) {
+					int val = *bits++;
+					u32 out;
+
+					if (invert)
+						val = 255 - val;
+					if (priv->format == VIDEO_X2R10G10B10)
+						out = val << 2 | val << 12 | val << 22;
+					else
+						out = val | val << 8 | val << 16;
+					if (set)
+						*dst++ |= out;
+					else
+						*dst++ &= out;
+				}
 			}
 			break;
 		}
 		default:
 			return -ENOSYS;
 		}
+		alpha += stride;
 		line += priv->line_length;
 	}
 
-	video_damage(dev, xstart, ystart, xend - xstart, yend - ystart);
+	return 0;
+}
+
+int video_blit_alpha(struct udevice *dev, int x, int y, int width, int height,
+		     const u8 *alpha, int stride)
+{
+	struct video_priv *priv = dev_get_uclass_priv(dev);
+	struct video_ops *ops = video_get_ops(dev);
+	int ret = -ENOSYS;
+
+	if (width <= 0 || height <= 0)
+		return 0;
+	if (ops && ops->blit_alpha)
+		ret = ops->blit_alpha(dev, x, y, width, height, alpha, stride);
+	if (ret == -ENOSYS)
+		ret = video_sw_blit_alpha(priv, x, y, width, height, alpha,
+					  stride);
+	if (ret)
+		return ret;
+
+	video_damage(dev, x, y, width, height);
 
 	return 0;
 }
@@ -267,6 +451,11 @@ int video_reserve_from_bloblist(struct video_handoff *ho)
 int video_fill(struct udevice *dev, u32 colour)
 {
 	struct video_priv *priv = dev_get_uclass_priv(dev);
+	struct video_ops *ops = video_get_ops(dev);
+
+	if (ops && ops->fill_rect &&
+	    !ops->fill_rect(dev, 0, 0, priv->xsize, priv->ysize, colour))
+		goto done;
 
 	switch (priv->bpix) {
 	case VIDEO_BPP16:
@@ -294,6 +483,7 @@ int video_fill(struct udevice *dev, u32 colour)
 		break;
 	}
 
+done:
 	video_damage(dev, 0, 0, priv->xsize, priv->ysize);
 
 	return video_sync(dev, false);
@@ -309,6 +309,20 @@ get_cluster(fsdata *mydata, __u32 clustnum, __u8 *buffer, unsigned long size)
 	return 0;
 }
 
+/**
+ * struct fat_cursor - position within the cluster chain of an open file
+ *
+ * This avoids walking the chain from the start of the file on each read
+ *
+ * @pos:	file offset of the start of @clust, a multiple of the cluster
+ *		size
+ * @clust:	cluster holding the data at @pos, 0 if not known
+ */
+struct fat_cursor {
+	loff_t pos;
+	__u32 clust;
+};
+
 /**
  * get_contents() - read from file
  *
@@ -322,10 +336,13 @@ get_cluster(fsdata *mydata, __u32 clustnum, __u8 *buffer, unsigned long size)
  * @buffer:	buffer into which to read
  * @maxsize:	maximum number of bytes to read
  * @gotsize:	number of bytes actually read
+ * @cursor:	cursor to start the search for the cluster at @pos, updated to
+ *		that cluster, or NULL to search from the start of the file
  * Return:	-1 on error, otherwise 0
  */
 static int get_contents(fsdata *mydata, dir_entry *dentptr, loff_t pos,
-			__u8 *buffer, loff_t maxsize, loff_t *gotsize)
+			__u8 *buffer, loff_t maxsize, loff_t *gotsize,
+			struct fat_cursor *cursor)
 {
 	loff_t filesize = FAT2CPU32(dentptr->size);
 	unsigned int bytesperclust = mydata->clust_size * mydata->sect_size;
@@ -347,6 +364,10 @@ static int get_contents(fsdata *mydata, dir_entry *dentptr, loff_t pos,
 	debug("%llu bytes\n", filesize);
 
 	actsize = bytesperclust;
+	if (cursor && cursor->clust && cursor->pos <= pos) {
+		curclust = cursor->clust;
+		actsize += cursor->pos;
+	}
 
 	/* go to cluster at pos */
 	while (actsize <= pos) {
@@ -358,6 +379,10 @@ static int get_contents(fsdata *mydata, dir_entry *dentptr, loff_t pos,
 		}
 		actsize += bytesperclust;
 	}
+	if (cursor) {
+		cursor->pos = actsize - bytesperclust;
+		cursor->clust = curclust;
+	}
 
 	/* actsize > pos */
 	actsize -= bytesperclust;
@@ -1326,7 +1351,7 @@ int fat_read_file(const char *filename, void *buf, loff_t offset, loff_t len,
 	/* For saving default max clustersize memory allocated to malloc pool */
 	dir_entry *dentptr = itr->dent;
 
-	ret = get_contents(&fsdata, dentptr, offset, buf, len, actread);
+	ret = get_contents(&fsdata, dentptr, offset, buf, len, actread, NULL);
 
 out_free_both:
 	free(fsdata.fatbuf);
@@ -1420,6 +1445,83 @@ void fat_closedir(struct fs_dir_stream *dirs)
 	free(dir);
 }
 
+/**
+ * struct fat_file - A file opened with fat_openfile()
+ *
+ * @parent:	generic part of the open file
+ * @fsdata:	file system parameters, including the FAT buffer
+ * @dent:	copy of the directory entry for the file
+ * @dev:	block device holding the file system
+ * @part_info:	partition holding the file system
+ * @cursor:	position reached by the last read
+ */
+typedef struct {
+	struct fs_file parent;
+	fsdata fsdata;
+	dir_entry dent;
+	struct blk_desc *dev;
+	struct disk_partition part_info;
+	struct fat_cursor cursor;
+} fat_file;
+
+int fat_openfile(const char *filename, struct fs_file **filep)
+{
+	fat_file *file;
+	fat_itr *itr;
+	int ret;
+
+	file = calloc(1, sizeof(*file));
+	itr = malloc_cache_aligned(sizeof(fat_itr));
+	if (!file || !itr) {
+		ret = -ENOMEM;
+		goto fail_free;
+	}
+
+	ret = fat_itr_root(itr, &file->fsdata);
+	if (ret)
+		goto fail_free;
+
+	ret = fat_itr_resolve(itr, filename, TYPE_FILE);
+	if (ret) {
+		free(file->fsdata.fatbuf);
+		goto fail_free;
+	}
+	file->dent = *itr->dent;
+	file->dev = cur_dev;
+	file->part_info = cur_part_info;
+	file->parent.size = FAT2CPU32(file->dent.size);
+	free(itr);
+	*filep = &file->parent;
+
+	return 0;
+
+fail_free:
+	free(itr);
+	free(file);
+	return ret;
+}
+
+int fat_readfile(struct fs_file *fs_file, void *buf, loff_t offset, loff_t len,
+		 loff_t *actread)
+{
+	fat_file *file = (fat_file *)fs_file;
+
+	/* Switch back to this file system, without probing it again */
+	cur_dev = file->dev;
+	cur_part_info = file->part_info;
+
+	return get_contents(&file->fsdata, &file->dent, offset, buf, len,
+			    actread, &file->cursor);
+}
+
+void fat_closefile(struct fs_file *fs_file)
+{
+	fat_file *file = (fat_file *)fs_file;
+
+	free(file->fsdata.fatbuf);
+	free(file);
+}
+
 void fat_close(void)
 {
 }
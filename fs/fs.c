@@ -15,6 +15,7 @@
 #include <malloc.h>
 #include <mapmem.h>
 #include <part.h>
+#include <perf.h>
 #include <ext4fs.h>
 #include <fat.h>
 #include <fs.h>
@@ -40,6 +41,8 @@ static struct blk_desc *fs_dev_desc;
 static int fs_dev_part;
 static struct disk_partition fs_partition;
 static int fs_type = FS_TYPE_ANY;
+/* Changed on every write or delete, so that open files can be invalidated */
+static uint fs_change_seq;
 
 void fs_set_type(int type)
 {
@@ -191,6 +194,18 @@ struct fstype_info {
 	int (*mkdir)(const char *dirname);
 	int (*ln)(const char *filename, const char *target);
 	int (*rename)(const char *old_path, const char *new_path);
+	/*
+	 * Open a file for reading. On success return 0 and the file via
+	 * 'filep', with its size filled in. On error, return -errno. These
+	 * three may be NULL, in which case the file is read by path each time.
+	 * See fs_open_file().
+	 */
+	int (*openfile)(const char *filename, struct fs_file **filep);
+	/* see fs_read_file() */
+	int (*readfile)(struct fs_file *file, void *buf, loff_t offset,
+			loff_t len, loff_t *actread);
+	/* see fs_close_file() */
+	void (*closefile)(struct fs_file *file);
 };
 
 static struct fstype_info fstypes[] = {
@@ -218,6 +233,9 @@ static struct fstype_info fstypes[] = {
 		.opendir = fat_opendir,
 		.readdir = fat_readdir,
 		.closedir = fat_closedir,
+		.openfile = fat_openfile,
+		.readfile = fat_readfile,
+		.closefile = fat_closefile,
 		.ln = fs_ln_unsupported,
 #if CONFIG_IS_ENABLED(FAT_RENAME) && !IS_ENABLED(CONFIG_XPL_BUILD)
 		.rename = fat_rename,
@@ -610,6 +628,7 @@ static int _fs_read(const char *filename, ulong addr, loff_t offset, loff_t len,
 		    int do_lmb_check, loff_t *actread)
 {
 	struct fstype_info *info = fs_get_info(fs_type);
+	u64 perf_start;
 	void *buf;
 	int ret;
 
@@ -626,7 +645,10 @@ static int _fs_read(const char *filename, ulong addr, loff_t offset, loff_t len,
 	 * means read the whole file.
 	 */
 	buf = map_sysmem(addr, len);
+	perf_start = perf_begin();
 	ret = info->read(filename, buf, offset, len, actread);
+	if (!ret)
+		perf_end(PERF_FS_READ + info->fstype, perf_start, *actread);
 	unmap_sysmem(buf);
 
 	/* If we requested a specific number of bytes, check we got it */
@@ -650,6 +672,7 @@ int fs_write(const char *filename, ulong addr, loff_t offset, loff_t len,
 	void *buf;
 	int ret;
 
+	fs_change_seq++;
 	buf = map_sysmem(addr, len);
 	ret = info->write(filename, buf, offset, len, actwrite);
 	unmap_sysmem(buf);
@@ -663,6 +686,87 @@ int fs_write(const char *filename, ulong addr, loff_t offset, loff_t len,
 	return ret;
 }
 
+int fs_open_file(const char *filename, struct fs_file **filep)
+{
+	struct fstype_info *info = fs_get_info(fs_type);
+	struct fs_file *file = NULL;
+	loff_t size;
+	int ret;
+
+	if (info->openfile) {
+		ret = info->openfile(filename, &file);
+	} else {
+		ret = info->size(filename, &size);
+		if (!ret) {
+			file = calloc(1, sizeof(*file));
+			if (file)
+				file->path = strdup(filename);
+			if (!file || !file->path) {
+				free(file);
+				ret = -ENOMEM;
+			} else {
+				file->size = size;
+			}
+		}
+	}
+	if (!ret) {
+		file->desc = fs_dev_desc;
+		file->part = fs_dev_part;
+		file->fstype = fs_type;
+		file->seq = fs_change_seq;
+		*filep = file;
+	}
+	fs_close();
+
+	return ret;
+}
+
+int fs_read_file(struct fs_file *file, void *buf, loff_t offset, loff_t len,
+		 loff_t *actread)
+{
+	struct fstype_info *info = fs_get_info(file->fstype);
+	u64 perf_start;
+	int ret;
+
+	if (fs_file_stale(file))
+		return -ESTALE;
+	perf_start = perf_begin();
+	if (info->readfile) {
+		ret = info->readfile(file, buf, offset, len, actread);
+	} else {
+		ret = fs_set_blk_dev_with_part(file->desc, file->part);
+		if (ret)
+			return ret;
+		ret = info->read(file->path, buf, offset, len, actread);
+		fs_close();
+	}
+	if (!ret)
+		perf_end(PERF_FS_READ + info->fstype, perf_start, *actread);
+
+	return ret;
+}
+
+bool fs_file_stale(const struct fs_file *file)
+{
+	return file->seq != fs_change_seq;
+}
+
+void fs_close_file(struct fs_file *file)
+{
+	struct fstype_info *info;
+
+	if (!file)
+		return;
+
+	info = fs_get_info(file->fstype);
+	if (info->closefile) {
+		info->closefile(file);
+	} else {
+		free(file->path);
+		free(file);
+	}
+}
+
 struct fs_dir_stream *fs_opendir(const char *filename)
 {
 	struct fstype_info *info = fs_get_info(fs_type);
@@ -721,6 +825,7 @@ int fs_unlink(const char *filename)
 
 	struct fstype_info *info = fs_get_info(fs_type);
 
+	fs_change_seq++;
 	ret = info->unlink(filename);
 
 	fs_close();
@@ -734,6 +839,7 @@ int fs_mkdir(const char *dirname)
 
 	struct fstype_info *info = fs_get_info(fs_type);
 
+	fs_change_seq++;
 	ret = info->mkdir(dirname);
 
 	fs_close();
@@ -746,6 +852,7 @@ int fs_ln(const char *fname, const char *target)
 	struct fstype_info *info = fs_get_info(fs_type);
 	int ret;
 
+	fs_change_seq++;
 	ret = info->ln(fname, target);
 
 	if (ret < 0) {
@@ -762,6 +869,7 @@ int fs_rename(const char *old_path, const char *new_path)
 	struct fstype_info *info = fs_get_info(fs_type);
 	int ret;
 
+	fs_change_seq++;
 	ret = info->rename(old_path, new_path);
 
 	if (ret < 0) {
@@ -153,6 +153,9 @@ enum bloblist_tag_t {
 	BLOBLISTT_U_BOOT_SPL_HANDOFF	= 0xfff000, /* Hand-off info from SPL */
 	BLOBLISTT_VBE			= 0xfff001, /* VBE per-phase state */
 	BLOBLISTT_U_BOOT_VIDEO		= 0xfff002, /* Video info from SPL */
+	BLOBLISTT_U_BOOT_NAND_BBT	= 0xfff003, /* NAND bad block table */
+	BLOBLISTT_U_BOOT_LOG		= 0xfff004, /* Binary log records */
+	BLOBLISTT_U_BOOT_PERF		= 0xfff005, /* Performance counters */
 };
 
 /**
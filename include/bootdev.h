@@ -294,6 +294,44 @@ int bootdev_hunt(const char *spec, bool show);
  */
 int bootdev_hunt_prio(enum bootdev_prio_t prio, bool show);
 
+/**
+ * bootdev_hunt_start() - Start hunters in the background
+ *
+ * This starts a uthread for each hunter of priority @prio or lower (i.e. a
+ * numerically higher value) which has not been used yet. The hunters make
+ * progress whenever the caller yields, e.g. while waiting in udelay().
+ * bootdev_hunt() and bootdev_hunt_prio() wait for any background hunter they
+ * need, so bootdevs can be scanned in priority order as usual.
+ *
+ * Without CONFIG_UTHREAD the hunters are run immediately instead.
+ *
+ * @prio: Highest priority to start
+ * Returns: 0 if OK, -ve if a thread could not be created
+ */
+int bootdev_hunt_start(enum bootdev_prio_t prio);
+
+/**
+ * bootdev_hunt_join() - Wait for the hunters running in the background
+ *
+ * This must be called before anything which the hunters could be using goes
+ * away, e.g. before booting an OS or removing the bootstd device.
+ *
+ * @std: bootstd state
+ */
+void bootdev_hunt_join(struct bootstd_priv *std);
+
+/**
+ * bootdev_hunt_abandon() - Stop the hunters running in the background
+ *
+ * Hunters which have not finished are never resumed, so they cannot touch the
+ * hardware again, e.g. once an OS is being booted. Their hunters are not run
+ * again and bootdevs below a device in their uclass are no longer used, since
+ * the media may have been left part-way through being set up.
+ *
+ * @std: bootstd state
+ */
+void bootdev_hunt_abandon(struct bootstd_priv *std);
+
 /**
  * bootdev_unhunt() - Mark a device as needing to be hunted again
  *
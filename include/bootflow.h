@@ -162,6 +162,9 @@ struct bootflow_img {
  * @BOOTFLOWIF_ALL: Return bootflows with errors as well
  * @BOOTFLOWIF_HUNT: Hunt for new bootdevs using the bootdrv hunters
  * @BOOTFLOWIF_ONLY_BOOTABLE: Only consider partitions marked 'bootable'
+ * @BOOTFLOWIF_HUNT_BG: Start all the hunters in the background when the
+ * iteration is set up, rather than running each one when it is needed. This is
+ * set automatically with CONFIG_BOOTSTD_HUNT_UTHREAD
  *
  * Internal flags:
  * @BOOTFLOWIF_SINGLE_DEV: (internal) Just scan one bootdev
@@ -179,6 +182,7 @@ enum bootflow_iter_flags_t {
 	BOOTFLOWIF_ALL			= 1 << 2,
 	BOOTFLOWIF_HUNT			= 1 << 3,
 	BOOTFLOWIF_ONLY_BOOTABLE	= BIT(4),
+	BOOTFLOWIF_HUNT_BG		= BIT(5),
 
 	/*
 	 * flags used internally by standard boot - do not set these when
@@ -410,6 +414,61 @@ int bootflow_boot(struct bootflow *bflow);
  */
 int bootflow_read_all(struct bootflow *bflow);
 
+/* Environment variable holding the last bootflow which booted successfully */
+#define BOOTFLOW_CACHE_VAR	"bootflow_cache"
+
+/* Property in /chosen which tells the OS the bootflow it was booted from */
+#define BOOTFLOW_CACHE_PROP	"u-boot,bootflow-cache"
+
+/* Maximum length of the value of BOOTFLOW_CACHE_VAR */
+#define BOOTFLOW_CACHE_MAX	256
+
+/**
+ * bootflow_cache_set() - Note the bootflow which is about to be booted
+ *
+ * This describes where @bflow came from, as
+ * "<bootdev>:<part> <bootmeth> <fname> <uuid>", e.g.
+ * "mmc1.bootdev:2 extlinux /extlinux/extlinux.conf 5a47...". The UUID is that
+ * of the partition, or "-" if none. Only bootflows on block devices are
+ * recorded.
+ *
+ * The record is held in memory and added to the OS device tree as the
+ * BOOTFLOW_CACHE_PROP property in /chosen. Nothing is written to the
+ * environment: once the OS has booted successfully, it can copy the property
+ * to the BOOTFLOW_CACHE_VAR variable, e.g. with fw_setenv
+ *
+ * @bflow: Bootflow to record, or NULL to remove the record
+ * Return: 0 if OK, -ve on error
+ */
+int bootflow_cache_set(const struct bootflow *bflow);
+
+/**
+ * bootflow_cache_get() - Get the record set by bootflow_cache_set()
+ *
+ * Return: record, or NULL if none
+ */
+const char *bootflow_cache_get(void);
+
+/**
+ * bootflow_cache_find() - Find the bootflow recorded in BOOTFLOW_CACHE_VAR
+ *
+ * This only scans the recorded partition with the recorded bootmeth, so
+ * bootdevs, partitions and bootmeths which come before it are skipped. If the
+ * bootdev does not exist yet and @flags includes BOOTFLOWIF_HUNT, hunters are
+ * run one priority at a time until it appears. The partition UUID is checked
+ * before the bootmeth reads anything. The bootflow is only returned if its
+ * filename matches the record too.
+ *
+ * @iter: Iterator to use. This is left set up if a bootflow is found, so that
+ *	the caller can pass it to bootflow_run_boot() and then uninit it
+ * @flags: Iteration flags (enum bootflow_iter_flags_t)
+ * @bflow: Returns the bootflow, if found
+ * Return: 0 if found, -ENOENT if nothing is recorded, -ESTALE if the record
+ *	does not match the media, other -ve on error
+ */
+int bootflow_cache_find(struct bootflow_iter *iter, int flags,
+			struct bootflow *bflow);
+
 /**
  * bootflow_run_boot() - Try to boot a bootflow
  *
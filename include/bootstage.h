@@ -213,6 +213,7 @@ enum bootstage_id {
 	BOOTSTAGE_ID_ACCUM_FSP_M,
 	BOOTSTAGE_ID_ACCUM_FSP_S,
 	BOOTSTAGE_ID_ACCUM_MMAP_SPI,
+	BOOTSTAGE_ID_ACCUM_UBI,
 
 	/* a few spare for the user, from here */
 	BOOTSTAGE_ID_USER,
@@ -338,6 +339,22 @@ uint32_t bootstage_accum(enum bootstage_id id);
 /* Print a report about boot time */
 void bootstage_report(void);
 
+/**
+ * bootstage_trace_export() - Write bootstage data in Chrome trace format
+ *
+ * This writes a JSON object containing all records and spans, suitable for
+ * loading into Perfetto or chrome://tracing. Marks become instant events and
+ * spans become complete events, so that nesting and overlap can be seen.
+ *
+ * Output stops when the buffer is full, but the full size is still returned,
+ * in the manner of snprintf(). No nul terminator is added.
+ *
+ * @buf: Buffer for output
+ * @size: Size of buffer
+ * Return: number of bytes needed for the output
+ */
+int bootstage_trace_export(char *buf, int size);
+
 /**
  * Add bootstage information to the device tree
  *
@@ -457,6 +474,49 @@ static inline int bootstage_init(bool first)
 
 #endif /* ENABLE_BOOTSTAGE */
 
+/**
+ * enum bootstage_span_flags - Flags for a bootstage span
+ *
+ * @BOOTSTAGE_SPANF_OPEN: Span has not ended yet
+ * @BOOTSTAGE_SPANF_PROBE: Span covers probing a device
+ */
+enum bootstage_span_flags {
+	BOOTSTAGE_SPANF_OPEN	= 1 << 0,
+	BOOTSTAGE_SPANF_PROBE	= 1 << 1,
+};
+
+#if !defined(USE_HOSTCC) && CONFIG_IS_ENABLED(BOOTSTAGE_SPANS)
+/**
+ * bootstage_span_begin() - Start a timing span
+ *
+ * A span records the start and end time of an activity. Spans can be nested:
+ * any span started before this one ends is its child. Each call must be
+ * matched by a call to bootstage_span_end(), even if this function fails.
+ *
+ * @name: Name of span, which is copied and may be truncated
+ * @flags: Flags for the span (enum bootstage_span_flags)
+ * Return: ID of the new span, -EBUSY if bootstage is not ready, or -ENOSPC if
+ *	the span table is full
+ */
+int bootstage_span_begin(const char *name, uint flags);
+
+/**
+ * bootstage_span_end() - End a timing span
+ *
+ * @id: ID returned by bootstage_span_begin(); this does nothing if it is -ve
+ */
+void bootstage_span_end(int id);
+#else
+static inline int bootstage_span_begin(const char *name, uint flags)
+{
+	return 0;
+}
+
+static inline void bootstage_span_end(int id)
+{
+}
+#endif
+
 /* helpers for SPL */
 int _bootstage_stash_default(void);
 int _bootstage_unstash_default(void);
@@ -41,6 +41,13 @@ struct udevice;
  * @theme: Node containing the theme information
  * @hunters_used: Bitmask of used hunters, indexed by their position in the
  * linker list. The bit is set if the hunter has been used already
+ * @hunters_busy: Bitmask of hunters which are running or waiting to run, e.g.
+ * in the background, indexed like @hunters_used
+ * @hunters_abandoned: Bitmask of hunters which were stopped part-way through
+ * by bootdev_hunt_abandon(), indexed like @hunters_used
+ * @hunt_grp: uthread group of the hunters started in the background, 0 if none
+ * @cache_pending: Record of the bootflow being booted, as set by
+ *	bootflow_cache_set(), or NULL if none. Allocated
  */
 struct bootstd_priv {
 	const char **prefixes;
@@ -54,6 +61,10 @@ struct bootstd_priv {
 	struct udevice *vbe_bootmeth;
 	ofnode theme;
 	uint hunters_used;
+	uint hunters_busy;
+	uint hunters_abandoned;
+	uint hunt_grp;
+	char *cache_pending;
 };
 
 /**
@@ -1075,11 +1075,16 @@ struct efi_sig_data {
  * @next:		Pointer to next entry
  * @sig_type:		Signature type
  * @sig_data_list:	Pointer to signature list
+ * @sig_index:		Entries of @sig_data_list sorted by their data, so that
+ *			a digest can be found by binary search
+ * @sig_count:		Number of entries in @sig_data_list
  */
 struct efi_signature_store {
 	struct efi_signature_store *next;
 	efi_guid_t sig_type;
 	struct efi_sig_data *sig_data_list;
+	struct efi_sig_data **sig_index;
+	size_t sig_count;
 };
 
 struct x509_certificate;
@@ -1127,6 +1132,7 @@ void efi_sigstore_free(struct efi_signature_store *sigstore);
 struct efi_signature_store *efi_build_signature_store(void *sig_list,
 						      efi_uintn_t size);
 struct efi_signature_store *efi_sigstore_parse_sigdb(u16 *name);
+struct efi_signature_store *efi_sigstore_get_sigdb(const u16 *name);
 
 bool efi_secure_boot_enabled(void);
 
@@ -94,6 +94,13 @@ efi_status_t efi_query_variable_info_int(u32 attributes,
 
 #define EFI_VAR_FILE_NAME "ubootefi.var"
 
+/*
+ * Changes made since ubootefi.var was written are appended to this file, each
+ * as a struct efi_var_file holding one variable. A variable of zero length
+ * records that the variable was deleted.
+ */
+#define EFI_VAR_JOURNAL_NAME "ubootefi.jnl"
+
 #define EFI_VAR_BUF_SIZE CONFIG_EFI_VAR_BUF_SIZE
 
 /*
@@ -145,6 +152,21 @@ struct efi_var_file {
  */
 efi_status_t efi_var_to_file(void);
 
+/**
+ * efi_var_log_to_file() - save a change to a non-volatile variable
+ *
+ * The variable is appended to the journal file ubootefi.jnl on the EFI system
+ * partition. If the journal is full or its state is not known, all variables
+ * are saved with efi_var_to_file() instead.
+ *
+ * @name:	name of the variable which has changed
+ * @guid:	GUID of the variable
+ * @attr:	attributes of the variable, used if it has been deleted
+ * Return:	status code
+ */
+efi_status_t efi_var_log_to_file(const u16 *name, const efi_guid_t *guid,
+				 u32 attr);
+
 /**
  * efi_var_collect() - collect variables in buffer
  *
@@ -176,7 +198,8 @@ efi_status_t efi_var_restore(struct efi_var_file *buf, bool safe);
  * efi_var_from_file() - read variables from file
  *
  * File ubootefi.var is read from the EFI system partitions and the variables
- * stored in the file are created.
+ * stored in the file are created. Then the changes recorded in ubootefi.jnl
+ * are applied.
  *
  * In case the file does not exist yet or a variable cannot be set EFI_SUCCESS
  * is returned.
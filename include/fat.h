@@ -204,6 +204,10 @@ int fat_read_file(const char *filename, void *buf, loff_t offset, loff_t len,
 int fat_opendir(const char *filename, struct fs_dir_stream **dirsp);
 int fat_readdir(struct fs_dir_stream *dirs, struct fs_dirent **dentp);
 void fat_closedir(struct fs_dir_stream *dirs);
+int fat_openfile(const char *filename, struct fs_file **filep);
+int fat_readfile(struct fs_file *file, void *buf, loff_t offset, loff_t len,
+		 loff_t *actread);
+void fat_closefile(struct fs_file *file);
 int fat_unlink(const char *filename);
 int fat_rename(const char *old_path, const char *new_path);
 int fat_mkdir(const char *dirname);
@@ -253,6 +253,80 @@ struct fs_dirent *fs_readdir(struct fs_dir_stream *dirs);
  */
 void fs_closedir(struct fs_dir_stream *dirs);
 
+/**
+ * struct fs_file - Structure representing a file opened for reading
+ *
+ * Struct fs_file should be treated opaque to the user of fs layer, apart
+ * from @size. File system drivers which support open files pass additional
+ * private fields with the pointers to this structure. For other file systems
+ * the fs layer reads the file by @path each time.
+ *
+ * @desc:	block device descriptor
+ * @part:	partition number
+ * @fstype:	file system type (FS_TYPE_...)
+ * @size:	size of the file in bytes
+ * @path:	path of the file, if the file system cannot keep it open
+ * @seq:	change sequence number when the file was opened, see
+ *		fs_file_stale()
+ */
+struct fs_file {
+	struct blk_desc *desc;
+	int part;
+	int fstype;
+	loff_t size;
+	char *path;
+	uint seq;
+};
+
+/**
+ * fs_open_file - Open a file for reading
+ *
+ * The file can then be read repeatedly with fs_read_file(). For file systems
+ * which support it, the file system stays mounted and the file is not looked
+ * up again, so there is no need to call fs_set_blk_dev() before each read.
+ *
+ * This implicitly calls fs_close().
+ *
+ * @filename: Name of file to open
+ * @filep: Returns the open file
+ * Return: 0 on success, -ve on error
+ */
+int fs_open_file(const char *filename, struct fs_file **filep);
+
+/**
+ * fs_read_file - Read from a file opened by fs_open_file()
+ *
+ * @file: the open file
+ * @buf: buffer to read into
+ * @offset: offset in the file from which to start reading
+ * @len: number of bytes to read, 0 to read to the end of the file
+ * @actread: returns the number of bytes actually read
+ * Return: 0 on success, -ESTALE if the file is stale (see fs_file_stale()),
+ *	other -ve on error
+ */
+int fs_read_file(struct fs_file *file, void *buf, loff_t offset, loff_t len,
+		 loff_t *actread);
+
+/**
+ * fs_file_stale - Check whether an open file is out of date
+ *
+ * An open file holds information about the file and the file system, such as
+ * its size and location. This becomes out of date when any file system is
+ * written to, or a file is deleted or renamed, through the fs layer. The file
+ * must then be closed and opened again.
+ *
+ * @file: the open file
+ * Return: true if something has been written since the file was opened
+ */
+bool fs_file_stale(const struct fs_file *file);
+
+/**
+ * fs_close_file - Close a file opened by fs_open_file()
+ *
+ * @file: the open file, or NULL to do nothing
+ */
+void fs_close_file(struct fs_file *file);
+
 /**
  * fs_unlink - delete a file or directory
  *
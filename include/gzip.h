@@ -65,6 +65,24 @@ void gzwrite_progress(int iteration, ulong bytes_written, ulong total_bytes);
 void gzwrite_progress_finish(int retcode, ulong totalwritten, ulong totalsize,
 			     u32 expected_crc, u32 calculated_crc);
 
+/**
+ * enum gzwrite_zeros - how gzwrite() handles output which is all zero
+ *
+ * Each write buffer is checked and a run of buffers which are all zero is
+ * handled in one go
+ *
+ * @GZWRITE_ZEROS_WRITE:	write the zeros like any other data
+ * @GZWRITE_ZEROS_SKIP:		skip them, for media which is already zeroed
+ * @GZWRITE_ZEROS_ERASE:	erase the blocks instead, for media which reads
+ *				as zero after an erase. Blocks which do not
+ *				fill an erase group are written as zeros
+ */
+enum gzwrite_zeros {
+	GZWRITE_ZEROS_WRITE,
+	GZWRITE_ZEROS_SKIP,
+	GZWRITE_ZEROS_ERASE,
+};
+
 /**
  * gzwrite() - decompress and write gzipped image from memory to block device
  *
@@ -75,10 +93,13 @@ void gzwrite_progress_finish(int retcode, ulong totalwritten, ulong totalsize,
  * @startoffs:	offset in bytes of first write
  * @szexpected:	expected uncompressed length, may be zero to use gzip trailer
  *		for files under 4GiB
+ * @zeros:	how to handle write buffers which are all zero. With
+ *		GZWRITE_ZEROS_ERASE, only whole erase groups are erased and
+ *		zeros are written to the rest
  * Return: 0 if OK, -1 on error
  */
 int gzwrite(unsigned char *src, int len, struct blk_desc *dev, ulong szwritebuf,
-	    ulong startoffs, ulong szexpected);
+	    ulong startoffs, ulong szexpected, enum gzwrite_zeros zeros);
 
 /**
  * gzip()- Compress data into a buffer using the gzip algorithm
@@ -98,6 +98,8 @@ void nand_wait_ready(struct mtd_info *mtd);
 
 /* Extended commands for large page devices */
 #define NAND_CMD_READSTART	0x30
+#define NAND_CMD_READCACHESEQ	0x31
+#define NAND_CMD_READCACHEEND	0x3f
 #define NAND_CMD_RNDOUTSTART	0xE0
 #define NAND_CMD_CACHEDPROG	0x15
 
@@ -258,6 +260,12 @@ enum nand_ecc_algo {
  * kmap'ed, vmalloc'ed highmem buffers being passed from upper layers
  */
 #define NAND_USE_BOUNCE_BUFFER	0x00100000
+/*
+ * The controller passes NAND_CMD_READCACHESEQ and NAND_CMD_READCACHEEND on
+ * to the chip through its cmdfunc. This is set automatically when the
+ * default large page cmdfunc is used.
+ */
+#define NAND_CMDFUNC_CACHE_READ	0x00200000
 /*
  * Whether the NAND chip is a boot medium. Drivers might use this information
  * to select ECC algorithms supported by the boot ROM or similar restrictions.
@@ -304,7 +312,8 @@ enum nand_ecc_algo {
 /* ONFI subfeature parameters length */
 #define ONFI_SUBFEATURE_PARAM_LEN	4
 
-/* ONFI optional commands SET/GET FEATURES supported? */
+/* ONFI optional commands READ CACHE and SET/GET FEATURES supported? */
+#define ONFI_OPT_CMD_READ_CACHE		(1 << 1)
 #define ONFI_OPT_CMD_SET_GET_FEATURES	(1 << 2)
 
 struct nand_onfi_params {
@@ -520,6 +529,29 @@ struct nand_id {
 	int len;
 };
 
+/**
+ * struct nand_bbt_handoff - In-memory bad block table passed to the next phase
+ *
+ * This is stored in a bloblist record with the tag BLOBLISTT_U_BOOT_NAND_BBT
+ * so that a later phase can use it instead of scanning the whole chip again.
+ *
+ * @gen: Generation of the table, incremented on every change. Zero means that
+ *	the table is not complete and must not be used
+ * @erase_shift: Number of address bits covered by one table entry
+ * @size: Size of the device in bytes
+ * @id_len: Number of valid bytes in @id
+ * @id: ID of the chip the table belongs to
+ * @bbt: Table, in the format of &nand_chip.bbt
+ */
+struct nand_bbt_handoff {
+	u32 gen;
+	u32 erase_shift;
+	u64 size;
+	u8 id_len;
+	u8 id[NAND_MAX_ID_LEN];
+	u8 bbt[];
+};
+
 /**
  * struct nand_ecc_step_info - ECC step information of ECC engine
  * @stepsize: data bytes per ECC step
@@ -891,6 +923,8 @@ struct nand_manufacturer_ops {
  * @jedec_params:	[INTERN] holds the JEDEC parameter page when JEDEC is
  *			supported, 0 otherwise.
  * @read_retries:	[INTERN] the number of read retry modes supported
+ * @cont_read:		[INTERN] state of an ongoing sequential cache read,
+ *			covering the pages @first_page to @last_page
  * @onfi_set_features:	[REPLACEABLE] set the features for ONFI nand
  * @onfi_get_features:	[REPLACEABLE] get the features for ONFI nand
  * @setup_data_interface: [OPTIONAL] setup the data interface and timing. If
@@ -976,6 +1010,12 @@ struct nand_chip {
 
 	int read_retries;
 
+	struct {
+		bool ongoing;
+		unsigned int first_page;
+		unsigned int last_page;
+	} cont_read;
+
 	flstate_t state;
 
 	uint8_t *oob_poi;
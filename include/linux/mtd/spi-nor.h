@@ -552,6 +552,10 @@ struct spi_flash {
  * @octal_dtr_enable:	[FLASH-SPECIFIC] enables SPI NOR octal DTR mode.
  * @ready:		[FLASH-SPECIFIC] check if the flash is ready
  * @dirmap:		pointers to struct spi_mem_dirmap_desc for reads/writes.
+ * @read_hwcaps:	(Fast) Read capabilities supported by both the controller
+ *			and the flash, which passed the read self-test
+ * @read_hwcap:		(Fast) Read capability currently in use
+ * @reads:		(Fast) Read commands, indexed by spi_nor_read_command_index
  * @priv:		the private data
  */
 struct spi_nor {
@@ -609,6 +613,12 @@ struct spi_nor {
 		struct spi_mem_dirmap_desc *wdesc;
 	} dirmap;
 
+#if CONFIG_IS_ENABLED(SPI_FLASH_READ_SELFTEST)
+	u32			read_hwcaps;
+	u32			read_hwcap;
+	struct spi_nor_read_command reads[SNOR_CMD_READ_MAX];
+#endif
+
 	void *priv;
 	char mtd_name[MTD_NAME_SIZE(MTD_DEV_TYPE_NOR)];
 /* Compatibility for spi_flash, remove once sf layer is merged with mtd */
@@ -655,6 +665,18 @@ void spi_nor_setup_op(const struct spi_nor *nor,
  */
 int spi_nor_scan(struct spi_nor *nor);
 
+/**
+ * spi_nor_select_read_hwcap() - switch to another (Fast) Read command
+ * @nor:	the spi_nor structure
+ * @hwcap:	one of the SNOR_HWCAPS_READ_* capabilities in @nor->read_hwcaps
+ *
+ * Only commands which do not need the flash to change mode can be selected,
+ * e.g. 1-1-1, 1-1-4 and 1-4-4 while in 1-1-4 mode, but not 8D-8D-8D.
+ *
+ * Return: 0 for success, -EINVAL if @hwcap cannot be used.
+ */
+int spi_nor_select_read_hwcap(struct spi_nor *nor, u32 hwcap);
+
 #if CONFIG_IS_ENABLED(SPI_FLASH_TINY)
 static inline int spi_nor_remove(struct spi_nor *nor)
 {
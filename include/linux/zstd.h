@@ -449,10 +449,68 @@ struct abuf;
 /**
  * zstd_decompress() - Decompress Zstandard data
  *
+ * The data may consist of several frames, which are decompressed one after
+ * the other. Anything after the last frame is ignored.
+ *
  * @in: Input buffer to decompress
  * @out: Output buffer to hold the results (must be large enough)
  * Return: size of the decompressed data, or -ve on error
  */
 int zstd_decompress(struct abuf *in, struct abuf *out);
 
+/**
+ * struct zstd_stream - state for streaming Zstandard decompression
+ *
+ * This allows compressed data to be decompressed as it is read, e.g. from a
+ * filesystem, instead of reading the whole of it first. The data may consist
+ * of several frames, including skippable ones, and may be followed by junk,
+ * which is ignored.
+ *
+ * @dstream: Decompression context, or NULL before any data is seen
+ * @out: Output buffer, with the number of bytes written so far
+ * @done: true if the data seen so far ends at the end of a frame
+ * @trailing: true if the data after the last frame is being ignored
+ */
+struct zstd_stream {
+	zstd_dstream *dstream;
+	zstd_out_buffer out;
+	bool done;
+	bool trailing;
+};
+
+/**
+ * zstd_stream_init() - start streaming decompression
+ *
+ * Only one stream may be in progress at a time, since they share a workspace
+ *
+ * @zs: Stream state to init
+ * @out: Output buffer to hold the results (must be large enough)
+ */
+void zstd_stream_init(struct zstd_stream *zs, struct abuf *out);
+
+/**
+ * zstd_stream_decompress() - decompress the next chunk of a stream
+ *
+ * The data is written straight to the output buffer, which also serves as the
+ * window, so the memory needed does not depend on the window size.
+ *
+ * @zs: Stream state
+ * @in: Next chunk of compressed data
+ * @size: Size of chunk in bytes
+ * Return: 0 if OK, -ENOSPC if the output buffer is full, -ENOMEM if out of
+ *	memory, -EINVAL if the data is invalid
+ */
+int zstd_stream_decompress(struct zstd_stream *zs, const void *in,
+			   size_t size);
+
+/**
+ * zstd_stream_finish() - finish streaming decompression
+ *
+ * @zs: Stream state
+ * Return: size of the decompressed data, -ENOSPC if the output buffer filled
+ *	up before the end of the frame, or -EINVAL if the data does not end at
+ *	the end of a frame
+ */
+int zstd_stream_finish(struct zstd_stream *zs);
+
 #endif  /* LINUX_ZSTD_H */
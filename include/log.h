@@ -407,7 +407,11 @@ enum log_rec_flags {
  * @flags: Flags for log record (enum log_rec_flags)
  * @file: Name of file where the log record was generated (not allocated)
  * @func: Function where the log record was generated (not allocated)
- * @msg: Log message (allocated)
+ * @msg: Log message (allocated). This is NULL when passed to a driver with
+ *	%LOGDF_RAW, unless another driver has already needed it
+ * @fmt: printf()-style format string for the message (not allocated)
+ * @args: Arguments for @fmt. This is only valid during the call to the
+ *	driver's emit() method, which must use va_copy() to read it
  */
 struct log_rec {
 	enum log_category_t cat;
@@ -417,12 +421,15 @@ struct log_rec {
 	const char *file;
 	const char *func;
 	const char *msg;
+	const char *fmt;
+	va_list args;
 };
 
 struct log_device;
 
 enum log_device_flags {
 	LOGDF_ENABLE		= BIT(0),	/* Device is enabled */
+	LOGDF_RAW		= BIT(1),	/* Uses fmt/args, not msg */
 };
 
 /**
@@ -659,6 +666,21 @@ int log_remove_filter(const char *drv_name, int filter_num);
  */
 int log_device_set_enable(struct log_driver *drv, bool enable);
 
+/**
+ * log_bin_dump() - Show the records in the binary log
+ *
+ * Each record is formatted and shown on the console, with its timestamp, in the
+ * same way as the console log driver. Records are not removed from the log.
+ *
+ * Return: number of records shown, or -%ENOENT if there is no binary log
+ */
+int log_bin_dump(void);
+
+/**
+ * log_bin_reset() - Discard all records in the binary log
+ */
+void log_bin_reset(void);
+
 #if CONFIG_IS_ENABLED(LOG)
 /**
  * log_init() - Set up the log system ready for use
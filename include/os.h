@@ -530,6 +530,28 @@ int os_setup_signal_handlers(void);
  */
 void os_signal_action(int sig, unsigned long pc);
 
+/**
+ * os_prof_start() - start the profiling timer
+ *
+ * This calls @handler from a SIGPROF handler, @rate times per second of CPU
+ * time used by sandbox. It is only supported on x86_64 and arm64 hosts.
+ *
+ * @rate:	number of samples per second
+ * @handler:	function to call with the program counter, frame pointer and
+ *		stack pointer when the signal happened, along with the top of
+ *		the stack
+ * Return:	0 if OK, -ENOSYS if not supported on this host, other -ve on
+ *		error
+ */
+int os_prof_start(unsigned int rate,
+		  void (*handler)(unsigned long pc, unsigned long fp,
+				  unsigned long sp, unsigned long stack_top));
+
+/**
+ * os_prof_stop() - stop the profiling timer
+ */
+void os_prof_stop(void);
+
 /**
  * os_get_time_offset() - get time offset
  *
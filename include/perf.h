@@ -0,0 +1,188 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Performance counters for block, network, filesystem and other hot paths
+ *
+ * Each counter records the number of operations, the number of bytes and,
+ * for operations which are timed, the total time and a histogram of the time
+ * taken by each operation. Counters are only updated after relocation.
+ */
+
+#ifndef __PERF_H
+#define __PERF_H
+
+#include <linux/types.h>
+#ifdef USE_HOSTCC
+#include <linux/kconfig.h>
+#endif
+
+enum {
+	PERF_FS_TYPES		= 10,	/* FS_TYPE_... values in fs.h */
+	PERF_HIST_BUCKETS	= 16,
+	PERF_NAME_LEN		= 16,
+	PERF_VERSION		= 1,
+};
+
+/**
+ * enum perf_id - Performance counters
+ *
+ * The values are passed on in the bloblist, so new counters must be added
+ * just before PERF_COUNT
+ *
+ * @PERF_BLK_READ: Block-device reads (not satisfied by the block cache)
+ * @PERF_BLK_WRITE: Block-device writes
+ * @PERF_BLK_ERASE: Block-device erases
+ * @PERF_NET_RX: Network packets received
+ * @PERF_NET_TX: Network packets sent
+ * @PERF_NET_RETRANSMIT: Network packets sent again after a timeout
+ * @PERF_FS_READ: Filesystem reads, add FS_TYPE_... to get the counter for a
+ *	particular filesystem type
+ * @PERF_FS_READ_LAST: Last filesystem counter
+ * @PERF_HASH: Hashing (e.g. for FIT verification)
+ * @PERF_DECOMP: Decompression of images, counting the output bytes
+ * @PERF_MALLOC: Allocations from the heap, including those made internally by
+ *	calloc(), memalign() and realloc()
+ * @PERF_FREE: Calls to free()
+ */
+enum perf_id {
+	PERF_BLK_READ,
+	PERF_BLK_WRITE,
+	PERF_BLK_ERASE,
+	PERF_NET_RX,
+	PERF_NET_TX,
+	PERF_NET_RETRANSMIT,
+	PERF_FS_READ,
+	PERF_FS_READ_LAST = PERF_FS_READ + PERF_FS_TYPES - 1,
+	PERF_HASH,
+	PERF_DECOMP,
+	PERF_MALLOC,
+	PERF_FREE,
+
+	PERF_COUNT,
+};
+
+/**
+ * struct perf_rec - A performance counter, as passed on in the bloblist
+ *
+ * Only counters with at least one operation are included. Times are in
+ * nanoseconds. Bucket n of the histogram counts operations which took less
+ * than 2^n microseconds (and at least 2^(n - 1)), except that the last bucket
+ * also counts anything longer.
+ *
+ * @name: Name of the counter, e.g. "blk.read", nul-terminated
+ * @id: Counter ID (enum perf_id)
+ * @spare: Reserved, set to 0
+ * @ops: Number of operations
+ * @bytes: Number of bytes transferred
+ * @time_ns: Total time taken, or 0 if not timed
+ * @hist: Histogram of time per operation
+ */
+struct perf_rec {
+	char name[PERF_NAME_LEN];
+	uint32_t id;
+	uint32_t spare;
+	uint64_t ops;
+	uint64_t bytes;
+	uint64_t time_ns;
+	uint32_t hist[PERF_HIST_BUCKETS];
+};
+
+/**
+ * struct perf_hdr - Header for performance counters in the bloblist
+ *
+ * This is followed by @count records
+ *
+ * @version: PERF_VERSION
+ * @count: Number of records which follow
+ * @rec_size: Size of each record (struct perf_rec)
+ * @spare: Reserved, set to 0
+ */
+struct perf_hdr {
+	uint32_t version;
+	uint32_t count;
+	uint32_t rec_size;
+	uint32_t spare;
+};
+
+#if !defined(USE_HOSTCC) && CONFIG_IS_ENABLED(PERF)
+
+/**
+ * perf_begin() - Get the start time for a timed operation
+ *
+ * Return: timer ticks, for passing to perf_end()
+ */
+uint64_t perf_begin(void);
+
+/**
+ * perf_end() - Record a timed operation
+ *
+ * @id: Counter to update
+ * @start: Value returned by perf_begin() at the start of the operation
+ * @bytes: Number of bytes transferred
+ */
+void perf_end(enum perf_id id, uint64_t start, uint64_t bytes);
+
+/**
+ * perf_add() - Record an operation which is not timed
+ *
+ * @id: Counter to update
+ * @bytes: Number of bytes transferred
+ */
+void perf_add(enum perf_id id, uint64_t bytes);
+
+/**
+ * perf_get() - Get the value of a counter
+ *
+ * @id: Counter to read
+ * @rec: Returns the counter, with times converted to nanoseconds
+ * Return: 0 if OK, -EINVAL if @id is invalid
+ */
+int perf_get(enum perf_id id, struct perf_rec *rec);
+
+/**
+ * perf_get_name() - Get the name of a counter
+ *
+ * @id: Counter ID
+ * Return: name, or "invalid" if @id is invalid
+ */
+const char *perf_get_name(enum perf_id id);
+
+/* Clear all counters */
+void perf_reset(void);
+
+/**
+ * perf_show() - Print the counters which have recorded any operations
+ *
+ * @hist: true to show the histogram for timed counters
+ */
+void perf_show(bool hist);
+
+/**
+ * perf_stash() - Write the counters to the bloblist
+ *
+ * This adds a BLOBLISTT_U_BOOT_PERF record, with a struct perf_hdr followed by
+ * a struct perf_rec for each counter which has recorded any operations. Any
+ * existing record is replaced.
+ *
+ * Return: 0 if OK, -ENOSPC if there is not enough space in the bloblist,
+ *	-ENOSYS if bloblist support is not enabled
+ */
+int perf_stash(void);
+
+#else
+
+static inline uint64_t perf_begin(void)
+{
+	return 0;
+}
+
+static inline void perf_end(enum perf_id id, uint64_t start, uint64_t bytes)
+{
+}
+
+static inline void perf_add(enum perf_id id, uint64_t bytes)
+{
+}
+
+#endif
+
+#endif
@@ -0,0 +1,85 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Sampling profiler
+ */
+
+#ifndef __PROF_H
+#define __PROF_H
+
+#include <linux/types.h>
+
+/**
+ * prof_start() - Start sampling
+ *
+ * This allocates the sample buffer the first time it is called. Samples are
+ * added to any already in the buffer.
+ *
+ * @rate: Number of samples to take per second, or 0 for the default
+ * Return: 0 if OK, -EALREADY if already running, -ENOMEM if there is no memory
+ *	for the buffer, -ENOSYS if the architecture does not support sampling
+ */
+int prof_start(uint rate);
+
+/**
+ * prof_stop() - Stop sampling
+ *
+ * The samples are kept until prof_wipe() is called.
+ */
+void prof_stop(void);
+
+/**
+ * prof_wipe() - Discard all samples
+ */
+void prof_wipe(void);
+
+/* Print statistics about the samples recorded */
+void prof_print_stats(void);
+
+/**
+ * prof_sample() - Record a sample
+ *
+ * This is called by the architecture from its timer interrupt. It records the
+ * program counter and, if frame pointers are available, walks the stack to
+ * record the callers.
+ *
+ * Each frame record is expected to hold the previous frame pointer followed by
+ * the return address, as on x86_64 and arm64. Only frame records between @sp
+ * and @stack_top are used.
+ *
+ * @pc: Program counter when the interrupt happened
+ * @fp: Frame pointer when the interrupt happened
+ * @sp: Stack pointer when the interrupt happened
+ * @stack_top: Address of the top of the stack
+ */
+void prof_sample(ulong pc, ulong fp, ulong sp, ulong stack_top);
+
+/**
+ * prof_list_samples() - Write the samples to a buffer for use by proftool
+ *
+ * This writes a struct trace_output_hdr with type TRACE_CHUNK_SAMPLES, then
+ * the samples. See struct trace_sample for the format.
+ *
+ * @buff: Buffer in which to place data, or NULL to count size
+ * @buff_size: Size of buffer
+ * @needed: Returns number of bytes used / needed
+ * Return: 0 if OK, -ENOSPC if the buffer is too small
+ */
+int prof_list_samples(void *buff, size_t buff_size, size_t *needed);
+
+/**
+ * arch_prof_start() - Start the sampling timer
+ *
+ * The architecture should call prof_sample() @rate times a second, from an
+ * interrupt, until arch_prof_stop() is called.
+ *
+ * @rate: Number of samples to take per second
+ * Return: 0 if OK, -ve on error
+ */
+int arch_prof_start(uint rate);
+
+/**
+ * arch_prof_stop() - Stop the sampling timer
+ */
+void arch_prof_stop(void);
+
+#endif
@@ -1,6 +1,7 @@
 #ifndef __SERIAL_H__
 #define __SERIAL_H__
 
+#include <cyclic.h>
 #include <post.h>
 
 struct serial_device {
@@ -275,6 +276,14 @@ struct dm_serial_ops {
  * @buf:	Pointer to the RX buffer
  * @rd_ptr:	Read pointer in the RX buffer
  * @wr_ptr:	Write pointer in the RX buffer
+ *
+ * @tx_buf:	TX buffer, holding characters not yet accepted by the UART
+ * @tx_rd_ptr:	Read pointer in the TX buffer
+ * @tx_wr_ptr:	Write pointer in the TX buffer
+ * @tx_dev:	Device which owns this buffer, or NULL if output is not being
+ *		buffered (e.g. before relocation)
+ * @tx_busy:	true while the TX buffer is being drained, to avoid recursion
+ * @tx_cyclic:	Cyclic function which drains the TX buffer
  */
 struct serial_dev_priv {
 	struct stdio_dev *sdev;
@@ -284,6 +293,14 @@ struct serial_dev_priv {
 	uint rd_ptr;
 	uint wr_ptr;
 #endif
+#if CONFIG_IS_ENABLED(SERIAL_TX_BUFFER)
+	char tx_buf[CONFIG_SERIAL_TX_BUFFER_SIZE];
+	uint tx_rd_ptr;
+	uint tx_wr_ptr;
+	struct udevice *tx_dev;
+	bool tx_busy;
+	struct cyclic_info tx_cyclic;
+#endif
 };
 
 /* Access the serial operations for a device */
@@ -0,0 +1,106 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Slab front-end for small heap allocations
+ *
+ * With CONFIG_SYS_MALLOC_SLAB, malloc() serves small requests from per-size
+ * pools of fixed-size objects, each pool being made of 4KiB pages obtained
+ * from dlmalloc. This avoids the per-chunk overhead and bin searching of
+ * dlmalloc for the many small objects allocated by driver model, the live
+ * tree and the like. Objects are released with free() as normal.
+ *
+ * Subsystems which allocate many objects of one type can declare a typed pool
+ * with SLAB_POOL(), so that those objects are packed together and can be seen
+ * separately in the statistics shown by the 'meminfo' command.
+ */
+
+#ifndef __SLAB_H
+#define __SLAB_H
+
+#include <malloc.h>
+#include <linux/list.h>
+#include <linux/types.h>
+
+enum {
+	SLAB_PAGE_SIZE	= 4096,
+	SLAB_MAX_SIZE	= 256,	/* largest malloc() request using the slab */
+};
+
+/**
+ * struct slab_cache - A pool of objects of the same size
+ *
+ * @name: Name of the pool, for statistics
+ * @size: Size of each object in bytes
+ * @partial: List of pages with at least one free object
+ * @sibling: Node in the list of all pools
+ * @pages: Number of pages in the pool
+ * @inuse: Number of objects allocated
+ * @allocs: Total number of allocations from the pool
+ * @ready: true once the pool has been added to the list of pools
+ */
+struct slab_cache {
+	const char *name;
+	uint size;
+	struct list_head partial;
+	struct list_head sibling;
+	uint pages;
+	uint inuse;
+	ulong allocs;
+	bool ready;
+};
+
+/**
+ * SLAB_POOL() - Declare a typed pool
+ *
+ * @_var: Name of the pool variable
+ * @_type: Type of the objects in the pool
+ */
+#define SLAB_POOL(_var, _type)				\
+	struct slab_cache _var = {			\
+		.name	= #_type,			\
+		.size	= sizeof(_type),		\
+	}
+
+#if !defined(USE_HOSTCC) && CONFIG_IS_ENABLED(SYS_MALLOC_SLAB)
+
+/**
+ * slab_pool_alloc() - Allocate a zeroed object from a typed pool
+ *
+ * This falls back to calloc() if the slab is not available, e.g. before
+ * relocation, or if the objects are too large for the slab. The object can be
+ * freed with free().
+ *
+ * @pool: Pool to allocate from
+ * Return: pointer to the object, or NULL if out of memory
+ */
+void *slab_pool_alloc(struct slab_cache *pool);
+
+/**
+ * slab_owns() - Check whether a pointer was allocated from the slab
+ *
+ * @ptr: Pointer returned by malloc(), etc.
+ * Return: true if @ptr is a slab object, false if it is a dlmalloc chunk
+ */
+bool slab_owns(const void *ptr);
+
+/* Show statistics for each pool which has any pages */
+void slab_show_stats(void);
+
+#else
+
+static inline void *slab_pool_alloc(struct slab_cache *pool)
+{
+	return calloc(1, pool->size);
+}
+
+static inline bool slab_owns(const void *ptr)
+{
+	return false;
+}
+
+static inline void slab_show_stats(void)
+{
+}
+
+#endif
+
+#endif
@@ -226,6 +226,11 @@ struct spi_mem_dirmap_info {
  *            calls will use spi_mem_exec_op() to access the memory. This is a
  *            degraded mode that allows spi_mem drivers to use the same code
  *            no matter whether the controller supports direct mapping or not
+ * @map: CPU address of the mapping when the controller does not implement
+ *	 ->mem_ops->dirmap_create() but exposes a memory-mapped window through
+ *	 ->get_mmap(). Reads are then served from this window
+ * @map_op: operation template which @map was set up for. Reads fall back to
+ *	    spi_mem_exec_op() if ->info.op_tmpl no longer matches it
  * @priv: field pointing to controller specific data
  *
  * Common part of a direct mapping descriptor. This object is created by
@@ -237,6 +242,8 @@ struct spi_mem_dirmap_desc {
 	struct spi_slave *slave;
 	struct spi_mem_dirmap_info info;
 	unsigned int nodirmap;
+	void *map;
+	struct spi_mem_op map_op;
 	void *priv;
 };
 
@@ -411,6 +418,8 @@ ssize_t spi_mem_dirmap_read(struct spi_mem_dirmap_desc *desc,
 			    u64 offs, size_t len, void *buf);
 ssize_t spi_mem_dirmap_write(struct spi_mem_dirmap_desc *desc,
 			     u64 offs, size_t len, const void *buf);
+void spi_mem_dirmap_invalidate(struct spi_mem_dirmap_desc *desc, u64 offs,
+			       size_t len);
 #ifndef __UBOOT__
 int spi_mem_driver_register_with_owner(struct spi_mem_driver *drv,
 				       struct module *owner);
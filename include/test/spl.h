@@ -31,6 +31,7 @@ void generate_data(char *data, size_t size, const char *test_name);
  * @IMX8: i.MX8 Container images
  * @FIT_INTERNAL: FITs with internal data
  * @FIT_EXTERNAL: FITs with external data
+ * @FIT_EXTERNAL_HASH: FITs with external data and a SHA256 hash node
  */
 enum spl_test_image {
 	LEGACY,
@@ -38,6 +39,7 @@ enum spl_test_image {
 	IMX8,
 	FIT_INTERNAL,
 	FIT_EXTERNAL,
+	FIT_EXTERNAL_HASH,
 };
 
 /**
@@ -131,6 +133,10 @@ static inline bool image_supported(enum spl_test_image type)
 		return IS_ENABLED(CONFIG_SPL_LEGACY_IMAGE_FORMAT);
 	case IMX8:
 		return IS_ENABLED(CONFIG_SPL_LOAD_IMX_CONTAINER);
+	case FIT_EXTERNAL_HASH:
+		if (!IS_ENABLED(CONFIG_SPL_SHA256))
+			return false;
+		fallthrough;
 	case FIT_INTERNAL:
 	case FIT_EXTERNAL:
 		return IS_ENABLED(CONFIG_SPL_LOAD_FIT);
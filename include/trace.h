@@ -34,6 +34,7 @@ enum {
 enum trace_chunk_type {
 	TRACE_CHUNK_FUNCS,
 	TRACE_CHUNK_CALLS,
+	TRACE_CHUNK_SAMPLES,
 };
 
 /* A trace record for a function, as written to the profile output file */
@@ -89,6 +90,24 @@ struct trace_call {
 
 int trace_list_calls(void *buff, size_t buff_size, size_t *needed);
 
+/**
+ * struct trace_sample - A sample from the sampling profiler
+ *
+ * In a TRACE_CHUNK_SAMPLES chunk, each sample has this header followed by
+ * @depth offsets, each a uint32_t. The first is the program counter and the
+ * others are return addresses, moving outwards through the call stack. Each is
+ * an offset from the start of the code, as with struct trace_call. The program
+ * counter is TRACE_SAMPLE_OUTSIDE if it was not within U-Boot's code
+ *
+ * @depth: Number of offsets which follow
+ */
+struct trace_sample {
+	uint32_t depth;
+	uint32_t offset[];
+};
+
+#define TRACE_SAMPLE_OUTSIDE	0xffffffff
+
 /**
  * Turn function tracing on and off
  *
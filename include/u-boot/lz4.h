@@ -9,6 +9,9 @@
 /**
  * ulz4fn() - Decompress LZ4 data
  *
+ * With CONFIG_LZ4_CHECKSUM the frame's header, block and content checksums
+ * are verified. The block checksums are checked before any data is written.
+ *
  * @src: Source data to decompress
  * @srcn: Length of source data
  * @dst: Destination for uncompressed data
@@ -17,7 +20,7 @@
  *	not recognised or independent blocks are used, -EINVAL if the reserved
  *	fields are non-zero, or input is overrun, -EENOBUFS if the destination
  *	buffer is overrun, -EEPROTO if the compressed data causes an error in
- *	the decompression algorithm
+ *	the decompression algorithm, -EBADMSG if a checksum does not match
  */
 int ulz4fn(const void *src, size_t srcn, void *dst, size_t *dstn);
 
@@ -264,6 +264,16 @@ int usb_host_eth_scan(int mode);
 int usb_init(void);
 
 int usb_stop(void); /* stop the USB Controller */
+
+/*
+ * usb_rescan() - pick up USB devices plugged or unplugged since usb_init()
+ *
+ * The controllers are not reset and devices which are still present are not
+ * enumerated again. If USB is not started yet, this calls usb_init().
+ *
+ * Returns: number of ports which changed, or -ve on error
+ */
+int usb_rescan(void);
 int usb_detect_change(void); /* detect if a USB device has been (un)plugged */
 
 int usb_set_protocol(struct usb_device *dev, int ifnum, int protocol);
@@ -843,6 +853,19 @@ bool usb_hub_is_root_hub(struct udevice *hub);
  */
 int usb_hub_scan(struct udevice *hub);
 
+/**
+ * usb_hub_rescan() - Look for changes on the ports of an active hub
+ *
+ * Unlike usb_hub_scan(), this does not power-cycle the hub or wait for its
+ * ports to settle. Devices which are still connected are left alone (child
+ * hubs are rescanned in turn), devices which went away are removed and newly
+ * connected devices are enumerated.
+ *
+ * @hub:	Hub device to rescan
+ * Return: number of ports which changed, or -ve on error
+ */
+int usb_hub_rescan(struct udevice *hub);
+
 /**
  * usb_scan_device() - Scan a device on a bus
  *
@@ -115,6 +115,18 @@ unsigned int uthread_grp_new_id(void);
  * thread which entry point has not returned yet), true otherwise
  */
 bool uthread_grp_done(unsigned int grp_id);
+/**
+ * uthread_grp_abandon() - stop all the threads in a group without resuming them
+ *
+ * Each thread in the group which has not finished yet is removed from the
+ * scheduler and freed, without running any more of its code. Nothing that
+ * the threads allocated or locked is released, so the caller must make sure
+ * that none of it is used afterwards. This must be called from a thread
+ * outside the group.
+ *
+ * @grp_id: the ID of the thread group that should be abandoned
+ */
+void uthread_grp_abandon(unsigned int grp_id);
 
 /**
  * uthread_mutex_lock() - lock a mutex
@@ -179,6 +191,10 @@ static inline bool uthread_grp_done(unsigned int grp_id)
 	return true;
 }
 
+static inline void uthread_grp_abandon(unsigned int grp_id)
+{
+}
+
 /* These are macros for convenience on the caller side */
 #define uthread_mutex_lock(_mutex) ({ 0; })
 #define uthread_mutex_trylock(_mutex) ({ 0 })
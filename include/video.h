@@ -142,9 +142,27 @@ struct video_priv {
  *		For these devices implement video_sync hook to call a sync
  *		function. vid is pointer to video device udevice. Function
  *		should return 0 on success video_sync and error code otherwise
+ *
+ * The following 2D operations are optional. They allow a driver with a
+ * blitter to accelerate drawing. Each must finish updating the frame buffer
+ * before returning. They may return -ENOSYS to fall back to the software
+ * implementation, e.g. for an unsupported depth. The caller takes care of
+ * calling video_damage()
+ *
+ * @fill_rect: Fill a rectangle with a colour in the frame buffer's format
+ * @copy_rect: Copy a rectangle within the frame buffer. The source and
+ *		destination may overlap
+ * @blit_alpha: Combine an 8bpp alpha mask with the frame buffer, as done
+ *		by video_blit_alpha()
  */
 struct video_ops {
 	int (*video_sync)(struct udevice *vid);
+	int (*fill_rect)(struct udevice *vid, int x, int y, int width,
+			 int height, u32 colour);
+	int (*copy_rect)(struct udevice *vid, int dstx, int dsty, int srcx,
+			 int srcy, int width, int height);
+	int (*blit_alpha)(struct udevice *vid, int x, int y, int width,
+			  int height, const u8 *alpha, int stride);
 };
 
 #define video_get_ops(dev)        ((struct video_ops *)(dev)->driver->ops)
@@ -262,6 +280,61 @@ int video_fill(struct udevice *dev, u32 colour);
 int video_fill_part(struct udevice *dev, int xstart, int ystart, int xend,
 		    int yend, u32 colour);
 
+/**
+ * video_fill_rect() - Fill a rectangle with a colour
+ *
+ * This uses the driver's fill_rect() operation if it has one
+ *
+ * @dev:	Device to update
+ * @x:		X position in pixels from the left
+ * @y:		Y position in pixels from the top
+ * @width:	Width of rectangle in pixels
+ * @height:	Height of rectangle in pixels
+ * @colour:	Colour to use, in the frame buffer's format
+ * Return: 0 if OK, -ENOSYS if the display depth is not supported
+ */
+int video_fill_rect(struct udevice *dev, int x, int y, int width, int height,
+		    u32 colour);
+
+/**
+ * video_copy_rect() - Copy a rectangle within the frame buffer
+ *
+ * This is used for scrolling. The source and destination may overlap. It uses
+ * the driver's copy_rect() operation if it has one
+ *
+ * @dev:	Device to update
+ * @dstx:	Destination X position in pixels from the left
+ * @dsty:	Destination Y position in pixels from the top
+ * @srcx:	Source X position in pixels from the left
+ * @srcy:	Source Y position in pixels from the top
+ * @width:	Width of rectangle in pixels
+ * @height:	Height of rectangle in pixels
+ * Return: 0 if OK, -ve on error
+ */
+int video_copy_rect(struct udevice *dev, int dstx, int dsty, int srcx, int srcy,
+		    int width, int height);
+
+/**
+ * video_blit_alpha() - Combine an alpha mask with the frame buffer
+ *
+ * This is used to draw anti-aliased text. Each alpha value is inverted if the
+ * background colour is not black, then converted to a grey level. This is
+ * ORed into the frame buffer if the foreground colour is not black, otherwise
+ * ANDed, so only white-on-black and black-on-white are handled. It uses the
+ * driver's blit_alpha() operation if it has one
+ *
+ * @dev:	Device to update
+ * @x:		X position in pixels from the left
+ * @y:		Y position in pixels from the top
+ * @width:	Width of mask in pixels
+ * @height:	Height of mask in pixels
+ * @alpha:	Mask, one byte per pixel
+ * @stride:	Number of bytes between rows in @alpha
+ * Return: 0 if OK, -ENOSYS if the display depth is not supported
+ */
+int video_blit_alpha(struct udevice *dev, int x, int y, int width, int height,
+		     const u8 *alpha, int stride);
+
 /**
  * video_draw_box() - Draw a box
  *
@@ -594,4 +594,38 @@ int vidconsole_get_font_size(struct udevice *dev, const char **name, uint *sizep
  */
 void vidconsole_set_quiet(struct udevice *dev, bool quiet);
 
+/**
+ * struct vidconsole_glyph_stats - Statistics for a console's glyph cache
+ *
+ * @hits: Number of glyphs drawn from the cache
+ * @misses: Number of glyphs which had to be rendered
+ * @used: Number of bytes in use by the cache
+ * @limit: Maximum number of bytes the cache can use
+ */
+struct vidconsole_glyph_stats {
+	uint hits;
+	uint misses;
+	uint used;
+	uint limit;
+};
+
+/**
+ * console_truetype_glyph_stats() - Get statistics for the glyph cache
+ *
+ * @dev: vidconsole device
+ * @stats: Returns the statistics
+ * Return: 0 if OK, -ENOSYS if @dev is not a TrueType console or it has no
+ *	glyph cache
+ */
+#ifdef CONFIG_CONSOLE_TRUETYPE
+int console_truetype_glyph_stats(struct udevice *dev,
+				 struct vidconsole_glyph_stats *stats);
+#else
+static inline int console_truetype_glyph_stats(struct udevice *dev,
+					struct vidconsole_glyph_stats *stats)
+{
+	return -ENOSYS;
+}
+#endif
+
 #endif
@@ -2237,6 +2237,8 @@ static efi_status_t EFIAPI efi_exit_boot_services(efi_handle_t image_handle,
 	}
 
 	if (!efi_st_keep_devices) {
+		/* Nothing drains buffered console output after this */
+		flush();
 		bootm_disable_interrupts();
 		if (IS_ENABLED(CONFIG_DM_ETH))
 			eth_halt();
@@ -40,6 +40,9 @@ struct file_handle {
 	struct fs_dir_stream *dirs;
 	struct fs_dirent *dent;
 
+	/* for reading a file, kept open between reads: */
+	struct fs_file *file;
+
 	char *path;
 };
 #define to_fh(x) container_of(x, struct file_handle, base)
@@ -59,6 +62,23 @@ static int set_blk_dev(struct file_handle *fh)
 	return fs_set_blk_dev_with_part(fh->fs->desc, fh->fs->part);
 }
 
+/**
+ * drop_stale_file() - close the open file of a handle if it is out of date
+ *
+ * Any write to a file system, whether through this handle, another handle or
+ * a command such as 'fatwrite', makes the open file stale. It is then opened
+ * again on the next read.
+ *
+ * @fh:	file handle
+ */
+static void drop_stale_file(struct file_handle *fh)
+{
+	if (fh->file && fs_file_stale(fh->file)) {
+		fs_close_file(fh->file);
+		fh->file = NULL;
+	}
+}
+
 /**
  * is_dir() - check if file handle points to directory
  *
@@ -372,6 +392,7 @@ out:
 static efi_status_t file_close(struct file_handle *fh)
 {
 	fs_closedir(fh->dirs);
+	fs_close_file(fh->file);
 	free(fh->path);
 	free(fh);
 	return EFI_SUCCESS;
@@ -414,6 +435,11 @@ static efi_status_t EFIAPI efi_file_delete(struct efi_file_handle *file)
 static efi_status_t efi_get_file_size(struct file_handle *fh,
 				      loff_t *file_size)
 {
+	drop_stale_file(fh);
+	if (fh->file) {
+		*file_size = fh->file->size;
+		return EFI_SUCCESS;
+	}
 	if (set_blk_dev(fh))
 		return EFI_DEVICE_ERROR;
 
@@ -462,30 +488,42 @@ out:
 	return ret;
 }
 
+/**
+ * file_read() - read from a file
+ *
+ * The file is opened on the first read and kept open, so that later reads
+ * neither probe the file system again nor look up the path.
+ *
+ * @fh:			file handle
+ * @buffer_size:	number of bytes to read, updated with the number read
+ * @buffer:		read buffer
+ * Return:		status code
+ */
 static efi_status_t file_read(struct file_handle *fh, u64 *buffer_size,
 		void *buffer)
 {
 	loff_t actread;
 	efi_status_t ret;
-	loff_t file_size;
 
 	if (!buffer) {
 		ret = EFI_INVALID_PARAMETER;
 		return ret;
 	}
 
-	ret = efi_get_file_size(fh, &file_size);
-	if (ret != EFI_SUCCESS)
-		return ret;
-	if (file_size < fh->offset) {
+	drop_stale_file(fh);
+	if (!fh->file &&
+	    (set_blk_dev(fh) || fs_open_file(fh->path, &fh->file)))
+		return EFI_DEVICE_ERROR;
+	if (fh->file->size < fh->offset) {
 		ret = EFI_DEVICE_ERROR;
 		return ret;
 	}
 
-	if (set_blk_dev(fh))
-		return EFI_DEVICE_ERROR;
-	if (fs_read(fh->path, map_to_sysmem(buffer), fh->offset,
-		    *buffer_size, &actread))
+	/* A length of 0 would read to the end of the file */
+	if (!*buffer_size)
+		return EFI_SUCCESS;
+	if (fs_read_file(fh->file, buffer, fh->offset, *buffer_size,
+			 &actread))
 		return EFI_DEVICE_ERROR;
 
 	*buffer_size = actread;
@@ -17,7 +17,7 @@
 #include <asm/cache.h>
 #include <asm/global_data.h>
 #include <asm/sections.h>
-#include <linux/list_sort.h>
+#include <linux/rbtree.h>
 #include <linux/sizes.h>
 
 DECLARE_GLOBAL_DATA_PTR;
@@ -28,17 +28,26 @@ DECLARE_GLOBAL_DATA_PTR;
 efi_uintn_t efi_memory_map_key;
 
 struct efi_mem_list {
-	struct list_head link;
+	struct rb_node node;
 	struct efi_mem_desc desc;
 };
 
-#define EFI_CARVE_NO_OVERLAP		-1
-#define EFI_CARVE_LOOP_AGAIN		-2
-#define EFI_CARVE_OVERLAPS_NONRAM	-3
-#define EFI_CARVE_OUT_OF_RESOURCES	-4
+/*
+ * This tree contains all memory map items, ordered by address. Items never
+ * overlap and adjacent items of the same type and attributes are merged.
+ */
+static struct rb_root efi_mem = RB_ROOT;
 
-/* This list contains all memory map items */
-static LIST_HEAD(efi_mem);
+/* Number of items in efi_mem */
+static size_t efi_mem_count;
+
+/*
+ * Copy of the memory map as returned by GetMemoryMap(), which is valid until
+ * the map next changes
+ */
+static struct efi_mem_desc *efi_mem_cache;
+static size_t efi_mem_cache_max;
+static bool efi_mem_cache_valid;
 
 #ifdef CONFIG_EFI_LOADER_BOUNCE_BUFFER
 void *efi_bounce_buffer;
@@ -84,177 +93,226 @@ static u64 checksum(struct efi_pool_allocation *alloc)
 }
 
 /**
- * efi_mem_cmp() - comparator function for sorting memory map
- *
- * Sorts the memory list from highest address to lowest address
+ * desc_get_end() - get end address of memory area
  *
- * When allocating memory we should always start from the highest
- * address chunk, so sort the memory list such that the first list
- * iterator gets the highest address and goes lower from there.
+ * @desc:	memory descriptor
+ * Return:	end address + 1
+ */
+static uint64_t desc_get_end(struct efi_mem_desc *desc)
+{
+	return desc->physical_start + (desc->num_pages << EFI_PAGE_SHIFT);
+}
+
+/**
+ * efi_mem_next() - get the next memory area in ascending address order
  *
- * @priv:	unused
- * @a:		first memory area
- * @b:		second memory area
- * Return:	1 if @a is before @b, -1 if @b is before @a, 0 if equal
+ * @item:	memory area
+ * Return:	next memory area or NULL if @item is the last one
  */
-static int efi_mem_cmp(void *priv, struct list_head *a, struct list_head *b)
+static struct efi_mem_list *efi_mem_next(struct efi_mem_list *item)
 {
-	struct efi_mem_list *mema = list_entry(a, struct efi_mem_list, link);
-	struct efi_mem_list *memb = list_entry(b, struct efi_mem_list, link);
+	struct rb_node *node = rb_next(&item->node);
 
-	if (mema->desc.physical_start == memb->desc.physical_start)
-		return 0;
-	else if (mema->desc.physical_start < memb->desc.physical_start)
-		return 1;
-	else
-		return -1;
+	return node ? rb_entry(node, struct efi_mem_list, node) : NULL;
 }
 
 /**
- * desc_get_end() - get end address of memory area
+ * efi_mem_prev() - get the previous memory area in ascending address order
  *
- * @desc:	memory descriptor
- * Return:	end address + 1
+ * @item:	memory area
+ * Return:	previous memory area or NULL if @item is the first one
  */
-static uint64_t desc_get_end(struct efi_mem_desc *desc)
+static struct efi_mem_list *efi_mem_prev(struct efi_mem_list *item)
 {
-	return desc->physical_start + (desc->num_pages << EFI_PAGE_SHIFT);
+	struct rb_node *node = rb_prev(&item->node);
+
+	return node ? rb_entry(node, struct efi_mem_list, node) : NULL;
 }
 
 /**
- * efi_mem_sort() - sort memory map
+ * efi_mem_find() - find the memory area containing an address
  *
- * Sort the memory map and then try to merge adjacent memory areas.
+ * @addr:	address to look up
+ * Return:	memory area containing @addr, else the lowest memory area
+ *		above @addr, or NULL if there is none
  */
-static void efi_mem_sort(void)
+static struct efi_mem_list *efi_mem_find(u64 addr)
 {
-	struct efi_mem_list *lmem;
-	struct efi_mem_list *prevmem = NULL;
-	bool merge_again = true;
-
-	list_sort(NULL, &efi_mem, efi_mem_cmp);
-
-	/* Now merge entries that can be merged */
-	while (merge_again) {
-		merge_again = false;
-		list_for_each_entry(lmem, &efi_mem, link) {
-			struct efi_mem_desc *prev;
-			struct efi_mem_desc *cur;
-			uint64_t pages;
-
-			if (!prevmem) {
-				prevmem = lmem;
-				continue;
-			}
-
-			cur = &lmem->desc;
-			prev = &prevmem->desc;
-
-			if ((desc_get_end(cur) == prev->physical_start) &&
-			    (prev->type == cur->type) &&
-			    (prev->attribute == cur->attribute)) {
-				/* There is an existing map before, reuse it */
-				pages = cur->num_pages;
-				prev->num_pages += pages;
-				prev->physical_start -= pages << EFI_PAGE_SHIFT;
-				prev->virtual_start -= pages << EFI_PAGE_SHIFT;
-				list_del(&lmem->link);
-				free(lmem);
-
-				merge_again = true;
-				break;
-			}
-
-			prevmem = lmem;
+	struct rb_node *node = efi_mem.rb_node;
+	struct efi_mem_list *above = NULL;
+
+	while (node) {
+		struct efi_mem_list *item;
+
+		item = rb_entry(node, struct efi_mem_list, node);
+		if (addr < item->desc.physical_start) {
+			above = item;
+			node = node->rb_left;
+		} else if (addr >= desc_get_end(&item->desc)) {
+			node = node->rb_right;
+		} else {
+			return item;
 		}
 	}
+
+	return above;
+}
+
+/**
+ * efi_mem_insert() - add a memory area to the memory map
+ *
+ * The memory area must not overlap any area already in the map.
+ *
+ * @item:	memory area to add
+ */
+static void efi_mem_insert(struct efi_mem_list *item)
+{
+	struct rb_node **link = &efi_mem.rb_node;
+	struct rb_node *parent = NULL;
+
+	while (*link) {
+		struct efi_mem_list *cur;
+
+		parent = *link;
+		cur = rb_entry(parent, struct efi_mem_list, node);
+		if (item->desc.physical_start < cur->desc.physical_start)
+			link = &parent->rb_left;
+		else
+			link = &parent->rb_right;
+	}
+	rb_link_node(&item->node, parent, link);
+	rb_insert_color(&item->node, &efi_mem);
+	efi_mem_count++;
+}
+
+/**
+ * efi_mem_remove() - remove a memory area from the memory map and free it
+ *
+ * @item:	memory area to remove
+ */
+static void efi_mem_remove(struct efi_mem_list *item)
+{
+	rb_erase(&item->node, &efi_mem);
+	efi_mem_count--;
+	free(item);
+}
+
+/**
+ * efi_mem_can_merge() - check whether two memory areas can be merged
+ *
+ * @lower:	lower memory area
+ * @upper:	upper memory area
+ * Return:	true if @upper follows directly on from @lower and both have
+ *		the same type and attributes
+ */
+static bool efi_mem_can_merge(struct efi_mem_desc *lower,
+			      struct efi_mem_desc *upper)
+{
+	return desc_get_end(lower) == upper->physical_start &&
+	       lower->type == upper->type &&
+	       lower->attribute == upper->attribute;
+}
+
+/**
+ * efi_mem_merge() - merge a memory area with its neighbours
+ *
+ * Since the memory map is kept merged, only the neighbours of a newly added
+ * area need to be checked.
+ *
+ * @item:	memory area which has been added
+ */
+static void efi_mem_merge(struct efi_mem_list *item)
+{
+	struct efi_mem_list *prev = efi_mem_prev(item);
+	struct efi_mem_list *next = efi_mem_next(item);
+
+	if (prev && efi_mem_can_merge(&prev->desc, &item->desc)) {
+		prev->desc.num_pages += item->desc.num_pages;
+		efi_mem_remove(item);
+		item = prev;
+	}
+	if (next && efi_mem_can_merge(&item->desc, &next->desc)) {
+		item->desc.num_pages += next->desc.num_pages;
+		efi_mem_remove(next);
+	}
+}
+
+/**
+ * efi_mem_check_conventional() - check that a region is conventional memory
+ *
+ * @start:	start address of the region
+ * @end:	end address + 1 of the region
+ * Return:	true if the whole region is mapped as EFI_CONVENTIONAL_MEMORY
+ */
+static bool efi_mem_check_conventional(u64 start, u64 end)
+{
+	struct efi_mem_list *item;
+	u64 addr = start;
+
+	for (item = efi_mem_find(start); item && addr < end;
+	     item = efi_mem_next(item)) {
+		if (item->desc.physical_start > addr ||
+		    item->desc.type != EFI_CONVENTIONAL_MEMORY)
+			return false;
+		addr = desc_get_end(&item->desc);
+	}
+
+	return addr >= end;
 }
 
 /**
  * efi_mem_carve_out() - unmap memory region
  *
- * @map:			memory map
- * @carve_desc:			memory region to unmap
- * @overlap_conventional:	the carved out region may only overlap free,
- *				or conventional memory
- * Return:			the number of overlapping pages which have been
- *				removed from the map,
- *				EFI_CARVE_NO_OVERLAP, if the regions don't
- *				overlap, EFI_CARVE_OVERLAPS_NONRAM, if the carve
- *				and map overlap, and the map contains anything
- *				but free ram(only when overlap_conventional is
- *				true),
- *				EFI_CARVE_LOOP_AGAIN, if the mapping list should
- *				be traversed again, as it has been altered.
- *
- * Unmaps all memory occupied by the carve_desc region from the list entry
- * pointed to by map.
- *
- * In case of EFI_CARVE_OVERLAPS_NONRAM it is the callers responsibility
- * to re-add the already carved out pages to the mapping.
+ * Removes the region from all memory areas which overlap it, splitting an
+ * area which extends beyond the region on both sides.
+ *
+ * @start:	start address of the region
+ * @end:	end address + 1 of the region
+ * Return:	status code
  */
-static s64 efi_mem_carve_out(struct efi_mem_list *map,
-			     struct efi_mem_desc *carve_desc,
-			     bool overlap_conventional)
+static efi_status_t efi_mem_carve_out(u64 start, u64 end)
 {
-	struct efi_mem_list *newmap;
-	struct efi_mem_desc *map_desc = &map->desc;
-	uint64_t map_start = map_desc->physical_start;
-	uint64_t map_end = map_start + (map_desc->num_pages << EFI_PAGE_SHIFT);
-	uint64_t carve_start = carve_desc->physical_start;
-	uint64_t carve_end = carve_start +
-			     (carve_desc->num_pages << EFI_PAGE_SHIFT);
-
-	/* check whether we're overlapping */
-	if ((carve_end <= map_start) || (carve_start >= map_end))
-		return EFI_CARVE_NO_OVERLAP;
-
-	/* We're overlapping with non-RAM, warn the caller if desired */
-	if (overlap_conventional && (map_desc->type != EFI_CONVENTIONAL_MEMORY))
-		return EFI_CARVE_OVERLAPS_NONRAM;
-
-	/* Sanitize carve_start and carve_end to lie within our bounds */
-	carve_start = max(carve_start, map_start);
-	carve_end = min(carve_end, map_end);
-
-	/* Carving at the beginning of our map? Just move it! */
-	if (carve_start == map_start) {
-		if (map_end == carve_end) {
-			/* Full overlap, just remove map */
-			list_del(&map->link);
-			free(map);
-		} else {
-			map->desc.physical_start = carve_end;
-			map->desc.virtual_start = carve_end;
-			map->desc.num_pages = (map_end - carve_end)
-					      >> EFI_PAGE_SHIFT;
+	struct efi_mem_list *item, *next;
+	u64 item_end;
+
+	item = efi_mem_find(start);
+	if (item && item->desc.physical_start < start) {
+		item_end = desc_get_end(&item->desc);
+
+		/* Split off the part above the region */
+		if (item_end > end) {
+			next = calloc(1, sizeof(*next));
+			if (!next)
+				return EFI_OUT_OF_RESOURCES;
+			next->desc = item->desc;
+			next->desc.physical_start = end;
+			next->desc.virtual_start = end;
+			next->desc.num_pages = (item_end - end) >> EFI_PAGE_SHIFT;
+			efi_mem_insert(next);
 		}
 
-		return (carve_end - carve_start) >> EFI_PAGE_SHIFT;
+		/* Shrink the area to [ physical_start ... start ] */
+		item->desc.num_pages = (start - item->desc.physical_start) >>
+				       EFI_PAGE_SHIFT;
+		item = efi_mem_next(item);
 	}
 
-	/*
-	 * Overlapping maps, just split the list map at carve_start,
-	 * it will get moved or removed in the next iteration.
-	 *
-	 * [ map_desc |__carve_start__| newmap ]
-	 */
+	while (item && item->desc.physical_start < end) {
+		next = efi_mem_next(item);
+		item_end = desc_get_end(&item->desc);
+		if (item_end <= end) {
+			/* Full overlap, just remove the area */
+			efi_mem_remove(item);
+		} else {
+			/* Move the start of the area to the end of the region */
+			item->desc.physical_start = end;
+			item->desc.virtual_start = end;
+			item->desc.num_pages = (item_end - end) >> EFI_PAGE_SHIFT;
+		}
+		item = next;
+	}
 
-	/* Create a new map from [ carve_start ... map_end ] */
-	newmap = calloc(1, sizeof(*newmap));
-	if (!newmap)
-		return EFI_CARVE_OUT_OF_RESOURCES;
-	newmap->desc = map->desc;
-	newmap->desc.physical_start = carve_start;
-	newmap->desc.virtual_start = carve_start;
-	newmap->desc.num_pages = (map_end - carve_start) >> EFI_PAGE_SHIFT;
-	/* Insert before current entry (descending address order) */
-	list_add_tail(&newmap->link, &map->link);
-
-	/* Shrink the map to [ map_start ... carve_start ] */
-	map_desc->num_pages = (carve_start - map_start) >> EFI_PAGE_SHIFT;
-
-	return EFI_CARVE_LOOP_AGAIN;
+	return EFI_SUCCESS;
 }
 
 /**
@@ -272,11 +330,10 @@ static s64 efi_mem_carve_out(struct efi_mem_list *map,
 efi_status_t efi_update_memory_map(u64 start, u64 pages, int memory_type,
 				   bool overlap_conventional, bool remove)
 {
-	struct efi_mem_list *lmem;
 	struct efi_mem_list *newlist;
-	bool carve_again;
-	uint64_t carved_pages = 0;
 	struct efi_event *evt;
+	efi_status_t ret;
+	u64 end;
 
 	EFI_PRINT("%s: 0x%llx 0x%llx %d %s %s\n", __func__,
 		  start, pages, memory_type, overlap_conventional ?
@@ -289,6 +346,15 @@ efi_status_t efi_update_memory_map(u64 start, u64 pages, int memory_type,
 		return EFI_SUCCESS;
 
 	++efi_memory_map_key;
+	end = start + (pages << EFI_PAGE_SHIFT);
+
+	/*
+	 * The payload wants to have RAM overlaps only. Check this before
+	 * changing anything, so that the map is left alone on failure.
+	 */
+	if (overlap_conventional && !efi_mem_check_conventional(start, end))
+		return EFI_NO_MAPPING;
+
 	newlist = calloc(1, sizeof(*newlist));
 	if (!newlist)
 		return EFI_OUT_OF_RESOURCES;
@@ -310,66 +376,20 @@ efi_status_t efi_update_memory_map(u64 start, u64 pages, int memory_type,
 		break;
 	}
 
-	/* Add our new map */
-	do {
-		carve_again = false;
-		list_for_each_entry(lmem, &efi_mem, link) {
-			s64 r;
-
-			r = efi_mem_carve_out(lmem, &newlist->desc,
-					      overlap_conventional);
-			switch (r) {
-			case EFI_CARVE_OUT_OF_RESOURCES:
-				free(newlist);
-				return EFI_OUT_OF_RESOURCES;
-			case EFI_CARVE_OVERLAPS_NONRAM:
-				/*
-				 * The user requested to only have RAM overlaps,
-				 * but we hit a non-RAM region. Error out.
-				 */
-				free(newlist);
-				return EFI_NO_MAPPING;
-			case EFI_CARVE_NO_OVERLAP:
-				/* Just ignore this list entry */
-				break;
-			case EFI_CARVE_LOOP_AGAIN:
-				/*
-				 * We split an entry, but need to loop through
-				 * the list again to actually carve it.
-				 */
-				carve_again = true;
-				break;
-			default:
-				/* We carved a number of pages */
-				carved_pages += r;
-				carve_again = true;
-				break;
-			}
-
-			if (carve_again) {
-				/* The list changed, we need to start over */
-				break;
-			}
-		}
-	} while (carve_again);
-
-	if (overlap_conventional && (carved_pages != pages)) {
-		/*
-		 * The payload wanted to have RAM overlaps, but we overlapped
-		 * with an unallocated region. Error out.
-		 */
+	ret = efi_mem_carve_out(start, end);
+	if (ret != EFI_SUCCESS) {
 		free(newlist);
-		return EFI_NO_MAPPING;
+		return ret;
 	}
+	efi_mem_cache_valid = false;
 
-	/* Add our new map */
-	if (!remove)
-		list_add_tail(&newlist->link, &efi_mem);
-	else
+	/* Add our new map, merging it with its neighbours */
+	if (!remove) {
+		efi_mem_insert(newlist);
+		efi_mem_merge(newlist);
+	} else {
 		free(newlist);
-
-	/* And make sure memory is listed in descending order */
-	efi_mem_sort();
+	}
 
 	/* Notify that the memory map was changed */
 	list_for_each_entry(evt, &efi_events, link) {
@@ -423,20 +443,12 @@ efi_status_t efi_add_memory_map(u64 start, u64 size, int memory_type)
  */
 static efi_status_t efi_check_allocated(u64 addr, bool must_be_allocated)
 {
-	struct efi_mem_list *item;
-
-	list_for_each_entry(item, &efi_mem, link) {
-		u64 start = item->desc.physical_start;
-		u64 end = start + (item->desc.num_pages << EFI_PAGE_SHIFT);
+	struct efi_mem_list *item = efi_mem_find(addr);
 
-		if (addr >= start && addr < end) {
-			if (must_be_allocated ^
-			    (item->desc.type == EFI_CONVENTIONAL_MEMORY))
-				return EFI_SUCCESS;
-			else
-				return EFI_NOT_FOUND;
-		}
-	}
+	if (!item || addr < item->desc.physical_start)
+		return EFI_NOT_FOUND;
+	if (must_be_allocated ^ (item->desc.type == EFI_CONVENTIONAL_MEMORY))
+		return EFI_SUCCESS;
 
 	return EFI_NOT_FOUND;
 }
@@ -762,6 +774,51 @@ efi_status_t efi_free_pool(void *buffer)
 	return ret;
 }
 
+/**
+ * efi_mem_copy_map() - copy the memory map into an array
+ *
+ * @memory_map:	array to fill, with space for efi_mem_count entries
+ */
+static void efi_mem_copy_map(struct efi_mem_desc *memory_map)
+{
+	struct rb_node *node;
+
+	/* Return the map in ascending order */
+	for (node = rb_first(&efi_mem); node; node = rb_next(node))
+		*memory_map++ = rb_entry(node, struct efi_mem_list, node)->desc;
+}
+
+/**
+ * efi_mem_update_cache() - bring the cached copy of the memory map up to date
+ *
+ * Boot loaders usually call GetMemoryMap() repeatedly, e.g. first to find
+ * its size and then around ExitBootServices(), so the map is only walked when
+ * it has changed.
+ *
+ * Return:	true if efi_mem_cache is valid, false if out of memory
+ */
+static bool efi_mem_update_cache(void)
+{
+	struct efi_mem_desc *cache;
+	size_t max;
+
+	if (efi_mem_cache_valid)
+		return true;
+	if (efi_mem_count > efi_mem_cache_max) {
+		/* Leave some room, since the map usually grows */
+		max = efi_mem_count + efi_mem_count / 4 + 8;
+		cache = realloc(efi_mem_cache, max * sizeof(*cache));
+		if (!cache)
+			return false;
+		efi_mem_cache = cache;
+		efi_mem_cache_max = max;
+	}
+	efi_mem_copy_map(efi_mem_cache);
+	efi_mem_cache_valid = true;
+
+	return true;
+}
+
 /**
  * efi_get_memory_map() - get map describing memory usage.
  *
@@ -779,9 +836,7 @@ efi_status_t efi_get_memory_map(efi_uintn_t *memory_map_size,
 				efi_uintn_t *descriptor_size,
 				uint32_t *descriptor_version)
 {
-	size_t map_entries;
 	efi_uintn_t map_size = 0;
-	struct efi_mem_list *lmem;
 	efi_uintn_t provided_map_size;
 
 	if (!memory_map_size)
@@ -789,9 +844,7 @@ efi_status_t efi_get_memory_map(efi_uintn_t *memory_map_size,
 
 	provided_map_size = *memory_map_size;
 
-	map_entries = list_count_nodes(&efi_mem);
-
-	map_size = map_entries * sizeof(struct efi_mem_desc);
+	map_size = efi_mem_count * sizeof(struct efi_mem_desc);
 
 	*memory_map_size = map_size;
 
@@ -807,13 +860,10 @@ efi_status_t efi_get_memory_map(efi_uintn_t *memory_map_size,
 	if (!memory_map)
 		return EFI_INVALID_PARAMETER;
 
-	/* Copy list into array */
-	/* Return the list in ascending order */
-	memory_map = &memory_map[map_entries - 1];
-	list_for_each_entry(lmem, &efi_mem, link) {
-		*memory_map = lmem->desc;
-		memory_map--;
-	}
+	if (efi_mem_update_cache())
+		memcpy(memory_map, efi_mem_cache, map_size);
+	else
+		efi_mem_copy_map(memory_map);
 
 	if (map_key)
 		*map_key = efi_memory_map_key;
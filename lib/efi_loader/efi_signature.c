@@ -12,10 +12,12 @@
 #include <image.h>
 #include <hexdump.h>
 #include <malloc.h>
+#include <sort.h>
 #include <crypto/pkcs7.h>
 #include <crypto/pkcs7_parser.h>
 #include <crypto/public_key.h>
 #include <linux/compat.h>
+#include <linux/err.h>
 #include <linux/oid_registry.h>
 #include <u-boot/hash-checksum.h>
 #include <u-boot/rsa.h>
@@ -172,8 +174,6 @@ static bool hash_algo_supported(const efi_guid_t guid)
 	const efi_guid_t unsupported_hashes[] = {
 		 EFI_CERT_SHA1_GUID,
 		 EFI_CERT_SHA224_GUID,
-		 EFI_CERT_SHA384_GUID,
-		 EFI_CERT_SHA512_GUID,
 	};
 
 	for (i = 0; i < ARRAY_SIZE(unsupported_hashes); i++) {
@@ -184,6 +184,100 @@ static bool hash_algo_supported(const efi_guid_t guid)
 	return true;
 }
 
+/**
+ * efi_sigstore_find_digest - find an entry starting with a digest
+ * @siglist:	Signature list
+ * @digest:	Digest to search for
+ * @len:	Length of @digest, no more than the size of the entries
+ *
+ * All entries of a signature list have the same size, so they can be
+ * searched in the sorted index.
+ *
+ * Return:	matching entry or NULL if not found
+ */
+static struct efi_sig_data *
+efi_sigstore_find_digest(struct efi_signature_store *siglist,
+			 const void *digest, size_t len)
+{
+	size_t low = 0, high = siglist->sig_count;
+
+	while (low < high) {
+		size_t mid = low + (high - low) / 2;
+		struct efi_sig_data *sig_data = siglist->sig_index[mid];
+		int cmp = memcmp(sig_data->data, digest, len);
+
+		if (!cmp)
+			return sig_data;
+		if (cmp < 0)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+
+	return NULL;
+}
+
+/* Types of signature list holding image digests, with their hash algorithms */
+static const struct {
+	efi_guid_t guid;
+	const char *algo;
+} efi_digest_types[] = {
+	{ EFI_CERT_SHA256_GUID, "sha256" },
+	{ EFI_CERT_SHA384_GUID, "sha384" },
+	{ EFI_CERT_SHA512_GUID, "sha512" },
+};
+
+/**
+ * struct efi_image_digest - digest of an image with one hash algorithm
+ *
+ * @hash:	Digest, NULL if not calculated yet
+ * @len:	Length of @hash in bytes, 0 if not calculated yet, -1 if it
+ *		could not be calculated
+ */
+struct efi_image_digest {
+	void *hash;
+	int len;
+};
+
+/**
+ * efi_get_image_digest - get the digest of an image for a signature list type
+ * @regs:	List of regions to be authenticated
+ * @digests:	Digests calculated so far, one for each of efi_digest_types[]
+ * @type:	Type of the signature list
+ *
+ * Each digest is calculated when a list of its type is first seen, then
+ * reused for later lists of the same type.
+ *
+ * Return:	digest, NULL if @type does not hold image digests, or
+ *		ERR_PTR(-EIO) if the digest cannot be calculated
+ */
+static struct efi_image_digest *
+efi_get_image_digest(struct efi_image_regions *regs,
+		     struct efi_image_digest *digests, const efi_guid_t *type)
+{
+	struct efi_image_digest *digest;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(efi_digest_types); i++) {
+		if (!guidcmp(type, &efi_digest_types[i].guid))
+			break;
+	}
+	if (i == ARRAY_SIZE(efi_digest_types))
+		return NULL;
+
+	digest = &digests[i];
+	if (!digest->len &&
+	    !efi_hash_regions(regs->reg, regs->num, &digest->hash,
+			      efi_digest_types[i].algo, &digest->len)) {
+		EFI_PRINT("Digesting an image failed\n");
+		digest->len = -1;
+	}
+	if (digest->len < 0)
+		return ERR_PTR(-EIO);
+
+	return digest;
+}
+
 /**
  * efi_signature_lookup_digest - search for an image's digest in sigdb
  * @regs:	List of regions to be authenticated
@@ -192,7 +286,8 @@ static bool hash_algo_supported(const efi_guid_t guid)
  *
  * A message digest of image pointed to by @regs is calculated and
  * its hash value is compared to entries in signature database pointed
- * to by @db.
+ * to by @db. Each signature list is checked against a digest calculated
+ * with its own hash algorithm.
  *
  * Return:	true if found, false if not
  */
@@ -201,11 +296,11 @@ bool efi_signature_lookup_digest(struct efi_image_regions *regs,
 				 bool dbx)
 
 {
+	struct efi_image_digest digests[ARRAY_SIZE(efi_digest_types)] = {};
 	struct efi_signature_store *siglist;
-	struct efi_sig_data *sig_data;
-	void *hash = NULL;
+	struct efi_image_digest *digest;
 	bool found = false;
-	bool hash_done = false;
+	int i;
 
 	EFI_PRINT("%s: Enter, %p, %p\n", __func__, regs, db);
 
@@ -213,8 +308,6 @@ bool efi_signature_lookup_digest(struct efi_image_regions *regs,
 		goto out;
 
 	for (siglist = db; siglist; siglist = siglist->next) {
-		int len = 0;
-		const char *hash_algo = NULL;
 		/*
 		 * if the hash algorithm is unsupported and we get an entry in
 		 * dbx reject the image
@@ -223,46 +316,31 @@ bool efi_signature_lookup_digest(struct efi_image_regions *regs,
 			found = true;
 			continue;
 		};
-		/*
-		 * Only support sha256 for now, that's what
-		 * hash-to-efi-sig-list produces
-		 */
-		if (guidcmp(&siglist->sig_type, &efi_guid_sha256))
-			continue;
-
-		hash_algo = guid_to_sha_str(&efi_guid_sha256);
-		/*
-		 * We could check size and hash_algo but efi_hash_regions()
-		 * will do that for us
-		 */
-		if (!hash_done &&
-		    !efi_hash_regions(regs->reg, regs->num, &hash, hash_algo,
-				      &len)) {
-			EFI_PRINT("Digesting an image failed\n");
-			break;
-		}
-		hash_done = true;
 
-		for (sig_data = siglist->sig_data_list; sig_data;
-		     sig_data = sig_data->next) {
-#ifdef DEBUG
-			EFI_PRINT("Msg digest in database:\n");
-			print_hex_dump("    ", DUMP_PREFIX_OFFSET, 16, 1,
-				       sig_data->data, sig_data->size, false);
-#endif
-			if (sig_data->size == len &&
-			    !memcmp(sig_data->data, hash, len)) {
+		digest = efi_get_image_digest(regs, digests,
+					      &siglist->sig_type);
+		if (!digest)
+			continue;
+		if (IS_ERR(digest)) {
+			/* likewise if the dbx entry cannot be checked */
+			if (dbx)
 				found = true;
-				free(hash);
-				goto out;
-			}
+			continue;
 		}
 
-		free(hash);
-		hash = NULL;
+		if (!siglist->sig_count ||
+		    siglist->sig_index[0]->size != digest->len)
+			continue;
+		if (efi_sigstore_find_digest(siglist, digest->hash,
+					     digest->len)) {
+			found = true;
+			goto out;
+		}
 	}
 
 out:
+	for (i = 0; i < ARRAY_SIZE(digests); i++)
+		free(digests[i].hash);
 	EFI_PRINT("%s: Exit, found: %d\n", __func__, found);
 	return found;
 }
@@ -448,40 +526,30 @@ static bool efi_signature_check_revocation(struct pkcs7_signed_info *sinfo,
 		if (!efi_hash_regions(reg, 1, &hash, hash_algo, &len))
 			goto out;
 
-		for (sig_data = siglist->sig_data_list; sig_data;
-		     sig_data = sig_data->next) {
-			/*
-			 * struct efi_cert_x509_sha256 {
-			 *	u8 tbs_hash[256/8];
-			 *	time64_t revocation_time;
-			 * };
-			 */
-#ifdef DEBUG
-			if (sig_data->size >= len) {
-				EFI_PRINT("hash in db:\n");
-				print_hex_dump("    ", DUMP_PREFIX_OFFSET,
-					       16, 1,
-					       sig_data->data, len, false);
-			}
-#endif
-			if ((sig_data->size < len + sizeof(time64_t)) ||
-			    memcmp(sig_data->data, hash, len))
-				continue;
-
-			memcpy(&revoc_time, sig_data->data + len,
-			       sizeof(revoc_time));
-			EFI_PRINT("revocation time: 0x%llx\n", revoc_time);
-			/*
-			 * TODO: compare signing timestamp in sinfo
-			 * with revocation time
-			 */
-
-			revoked = true;
-			free(hash);
-			goto out;
-		}
+		/*
+		 * struct efi_cert_x509_sha256 {
+		 *	u8 tbs_hash[256/8];
+		 *	time64_t revocation_time;
+		 * };
+		 */
+		sig_data = NULL;
+		if (siglist->sig_count &&
+		    siglist->sig_index[0]->size >= len + sizeof(time64_t))
+			sig_data = efi_sigstore_find_digest(siglist, hash, len);
 		free(hash);
 		hash = NULL;
+		if (!sig_data)
+			continue;
+
+		memcpy(&revoc_time, sig_data->data + len, sizeof(revoc_time));
+		EFI_PRINT("revocation time: 0x%llx\n", revoc_time);
+		/*
+		 * TODO: compare signing timestamp in sinfo
+		 * with revocation time
+		 */
+
+		revoked = true;
+		goto out;
 	}
 out:
 	EFI_PRINT("%s: Exit, revoked: %d\n", __func__, revoked);
@@ -628,11 +696,27 @@ void efi_sigstore_free(struct efi_signature_store *sigstore)
 			sig_data = sig_data_next;
 		}
 
+		free(sigstore->sig_index);
 		free(sigstore);
 		sigstore = sigstore_next;
 	}
 }
 
+/**
+ * efi_sig_data_cmp - compare the data of two signature entries
+ * @a:		Pointer to first entry
+ * @b:		Pointer to second entry
+ *
+ * Return:	negative, zero or positive as for memcmp()
+ */
+static int efi_sig_data_cmp(const void *a, const void *b)
+{
+	const struct efi_sig_data *sig_a = *(const struct efi_sig_data **)a;
+	const struct efi_sig_data *sig_b = *(const struct efi_sig_data **)b;
+
+	return memcmp(sig_a->data, sig_b->data, sig_a->size);
+}
+
 /**
  * efi_sigstore_parse_siglist - parse a signature list
  * @name:	Pointer to signature list
@@ -649,7 +733,7 @@ efi_sigstore_parse_siglist(struct efi_signature_list *esl)
 	struct efi_signature_store *siglist = NULL;
 	struct efi_sig_data *sig_data, *sig_data_next;
 	struct efi_signature_data *esd;
-	size_t left;
+	size_t left, i;
 
 	/*
 	 * UEFI specification defines certificate types:
@@ -729,9 +813,23 @@ efi_sigstore_parse_siglist(struct efi_signature_list *esl)
 		esd = (struct efi_signature_data *)
 				((u8 *)esd + esl->signature_size);
 		left -= esl->signature_size;
+		siglist->sig_count++;
 	}
 	siglist->sig_data_list = sig_data_next;
 
+	/* Sort the entries, so digests can be looked up quickly */
+	siglist->sig_index = malloc(siglist->sig_count *
+				    sizeof(*siglist->sig_index));
+	if (!siglist->sig_index) {
+		EFI_PRINT("Out of memory\n");
+		goto err;
+	}
+	for (i = 0, sig_data = sig_data_next; sig_data;
+	     sig_data = sig_data->next)
+		siglist->sig_index[i++] = sig_data;
+	qsort(siglist->sig_index, siglist->sig_count,
+	      sizeof(*siglist->sig_index), efi_sig_data_cmp);
+
 	return siglist;
 
 err:
@@ -741,18 +839,15 @@ err:
 }
 
 /**
- * efi_sigstore_parse_sigdb - parse the signature list and populate
- * the signature store
+ * efi_sigstore_build - parse the signature list and populate the signature
+ * store
  *
  * @sig_list:	Pointer to the signature list
  * @size:	Size of the signature list
  *
- * Parse the efi signature list and instantiate a signature store
- * structure.
- *
  * Return:	Pointer to signature store on success, NULL on error
  */
-struct efi_signature_store *efi_build_signature_store(void *sig_list,
+static struct efi_signature_store *efi_sigstore_build(void *sig_list,
 						      efi_uintn_t size)
 {
 	struct efi_signature_list *esl;
@@ -786,17 +881,38 @@ struct efi_signature_store *efi_build_signature_store(void *sig_list,
 		size -= esl->signature_list_size;
 		esl = (void *)esl + esl->signature_list_size;
 	}
-	free(sig_list);
 
 	return sigstore;
 
 err:
 	efi_sigstore_free(sigstore);
-	free(sig_list);
 
 	return NULL;
 }
 
+/**
+ * efi_sigstore_parse_sigdb - parse the signature list and populate
+ * the signature store
+ *
+ * @sig_list:	Pointer to the signature list
+ * @size:	Size of the signature list
+ *
+ * Parse the efi signature list and instantiate a signature store
+ * structure. @sig_list is freed.
+ *
+ * Return:	Pointer to signature store on success, NULL on error
+ */
+struct efi_signature_store *efi_build_signature_store(void *sig_list,
+						      efi_uintn_t size)
+{
+	struct efi_signature_store *sigstore;
+
+	sigstore = efi_sigstore_build(sig_list, size);
+	free(sig_list);
+
+	return sigstore;
+}
+
 /**
  * efi_sigstore_parse_sigdb - parse a signature database variable
  * @name:	Variable's name
@@ -821,3 +937,75 @@ struct efi_signature_store *efi_sigstore_parse_sigdb(u16 *name)
 
 	return efi_build_signature_store(db, db_size);
 }
+
+/**
+ * struct efi_sigdb_cache - signature database kept between image loads
+ *
+ * @name:	Variable's name
+ * @value:	Value of the variable from which @store was built, NULL if
+ *		the variable did not exist
+ * @size:	Size of @value
+ * @store:	Signature store, NULL if not built yet
+ */
+static struct efi_sigdb_cache {
+	const u16 *name;
+	void *value;
+	efi_uintn_t size;
+	struct efi_signature_store *store;
+} efi_sigdb_cache[] = {
+	{ .name = u"db" },
+	{ .name = u"dbx" },
+};
+
+/**
+ * efi_sigstore_get_sigdb - get the signature store for db or dbx
+ * @name:	Variable's name, "db" or "dbx"
+ *
+ * Parsing the database and sorting its digests is only done again if the
+ * variable has changed since the last call, so that loading each image
+ * does not cost time in proportion to the size of dbx. The store is owned
+ * by the cache and must not be freed by the caller.
+ *
+ * Return:	Pointer to signature store on success, NULL on error
+ */
+struct efi_signature_store *efi_sigstore_get_sigdb(const u16 *name)
+{
+	struct efi_sigdb_cache *cache = NULL;
+	struct efi_signature_store *store;
+	efi_uintn_t size = 0;
+	void *value;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(efi_sigdb_cache); i++) {
+		if (!u16_strcmp(name, efi_sigdb_cache[i].name))
+			cache = &efi_sigdb_cache[i];
+	}
+	if (!cache)
+		return NULL;
+
+	value = efi_get_var(name, efi_auth_var_get_guid(name), &size);
+	if (!value)
+		size = 0;
+	if (cache->store && size == cache->size &&
+	    (!size || !memcmp(value, cache->value, size))) {
+		free(value);
+		return cache->store;
+	}
+
+	if (value)
+		store = efi_sigstore_build(value, size);
+	else
+		store = calloc(sizeof(struct efi_signature_store), 1);
+	if (!store) {
+		free(value);
+		return NULL;
+	}
+
+	efi_sigstore_free(cache->store);
+	free(cache->value);
+	cache->store = store;
+	cache->value = value;
+	cache->size = size;
+
+	return store;
+}
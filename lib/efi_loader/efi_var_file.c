@@ -25,6 +25,26 @@
 
 static const efi_guid_t shim_lock_guid = SHIM_LOCK_GUID;
 
+/*
+ * CRC32 of the variables in ubootefi.var. Each journal record holds this in
+ * its reserved field, so that records written against an older ubootefi.var
+ * are ignored.
+ */
+static u32 __maybe_unused efi_var_file_crc;
+
+/*
+ * Length of ubootefi.jnl, or -1 if it is not known to match ubootefi.var, in
+ * which case the next change is saved by rewriting ubootefi.var
+ */
+static loff_t __maybe_unused efi_var_journal_len = -1;
+
+/*
+ * Set if appending to ubootefi.jnl failed, e.g. because the file system
+ * cannot write at an offset, as with ext4. Changes are then saved by
+ * rewriting ubootefi.var.
+ */
+static bool __maybe_unused efi_var_journal_off;
+
 /**
  * efi_set_blk_dev_to_system_partition() - select EFI system partition
  *
@@ -82,8 +102,17 @@ efi_status_t efi_var_to_file(void)
 	once = false;
 
 	r = fs_write(EFI_VAR_FILE_NAME, map_to_sysmem(buf), 0, len, &actlen);
-	if (r || len != actlen)
+	if (r || len != actlen) {
 		ret = EFI_DEVICE_ERROR;
+		goto error;
+	}
+	efi_var_file_crc = buf->crc32;
+
+	/* All changes are now in ubootefi.var, so empty the journal */
+	efi_var_journal_len = -1;
+	if (efi_set_blk_dev_to_system_partition() == EFI_SUCCESS &&
+	    !fs_write(EFI_VAR_JOURNAL_NAME, map_to_sysmem(buf), 0, 0, &actlen))
+		efi_var_journal_len = 0;
 
 error:
 	if (ret != EFI_SUCCESS)
@@ -96,18 +125,94 @@ out:
 #endif
 }
 
-efi_status_t efi_var_restore(struct efi_var_file *buf, bool safe)
+/**
+ * efi_var_log_to_file() - save a change to a non-volatile variable
+ *
+ * @name:	name of the variable which has changed
+ * @guid:	GUID of the variable
+ * @attr:	attributes of the variable, used if it has been deleted
+ * Return:	status code
+ */
+efi_status_t efi_var_log_to_file(const u16 *name, const efi_guid_t *guid,
+				 u32 attr)
 {
-	struct efi_var_entry *var, *last_var;
-	u16 *data;
+#ifdef CONFIG_EFI_VARIABLE_FILE_STORE
+	struct efi_var_entry *var;
+	struct efi_var_file *rec;
 	efi_status_t ret;
+	loff_t actlen;
+	u32 len;
+	int r;
 
-	if (buf->reserved || buf->magic != EFI_VAR_FILE_MAGIC ||
-	    buf->crc32 != crc32(0, (u8 *)buf->var,
-				buf->length - sizeof(struct efi_var_file))) {
-		log_err("Invalid EFI variables file\n");
-		return EFI_INVALID_PARAMETER;
+	if (efi_var_journal_off || efi_var_journal_len < 0)
+		return efi_var_to_file();
+
+	var = efi_var_mem_find(guid, name, NULL);
+	if (var)
+		len = efi_var_entry_len(var);
+	else
+		len = ALIGN(sizeof(*var) + sizeof(u16) * (u16_strlen(name) + 1),
+			    8);
+	len += sizeof(*rec);
+
+	/* Keep the journal small enough to be read back in one go */
+	if (efi_var_journal_len + len > EFI_VAR_BUF_SIZE)
+		return efi_var_to_file();
+
+	rec = calloc(1, len);
+	if (!rec)
+		return EFI_OUT_OF_RESOURCES;
+	if (var) {
+		memcpy(rec->var, var, len - sizeof(*rec));
+	} else {
+		/* A deleted variable is recorded with no data */
+		rec->var->attr = attr;
+		memcpy(&rec->var->guid, guid, sizeof(efi_guid_t));
+		u16_strcpy(rec->var->name, name);
+	}
+	rec->reserved = efi_var_file_crc;
+	rec->magic = EFI_VAR_FILE_MAGIC;
+	rec->length = len;
+	rec->crc32 = crc32(0, (u8 *)rec->var, len - sizeof(*rec));
+
+	ret = efi_set_blk_dev_to_system_partition();
+	if (ret == EFI_SUCCESS) {
+		r = fs_write(EFI_VAR_JOURNAL_NAME, map_to_sysmem(rec),
+			     efi_var_journal_len, len, &actlen);
+		if (r || actlen != len)
+			ret = EFI_DEVICE_ERROR;
+	}
+	free(rec);
+
+	/* Try writing everything instead, which also resets the journal */
+	if (ret != EFI_SUCCESS) {
+		if (efi_var_journal_len) {
+			log_warning("Cannot append to %s, saving all EFI variables instead\n",
+				    EFI_VAR_JOURNAL_NAME);
+			efi_var_journal_off = true;
+		}
+		efi_var_journal_len = -1;
+		return efi_var_to_file();
 	}
+	efi_var_journal_len += len;
+#endif
+	return EFI_SUCCESS;
+}
+
+/**
+ * efi_var_restore_entries() - create the variables held in a buffer
+ *
+ * @buf:	buffer holding the variables
+ * @safe:	restoring from tamper-resistant storage
+ * @replace:	replace existing variables, deleting those for which the
+ *		buffer holds an entry with no data
+ */
+static void efi_var_restore_entries(struct efi_var_file *buf, bool safe,
+				    bool replace)
+{
+	struct efi_var_entry *var, *last_var, *old;
+	u16 *data;
+	efi_status_t ret;
 
 	last_var = (struct efi_var_entry *)((u8 *)buf + buf->length);
 	for (var = buf->var; var < last_var;
@@ -126,19 +231,78 @@ efi_status_t efi_var_restore(struct efi_var_file *buf, bool safe)
 		     !guidcmp(&var->guid, &shim_lock_guid) ||
 		     !(var->attr & EFI_VARIABLE_NON_VOLATILE)))
 			continue;
-		if (!var->length)
+		if (!var->length && !replace)
 			continue;
-		if (efi_var_mem_find(&var->guid, var->name, NULL))
+		old = efi_var_mem_find(&var->guid, var->name, NULL);
+		if (old && !replace)
 			continue;
-		ret = efi_var_mem_ins(var->name, &var->guid, var->attr,
-				      var->length, data, 0, NULL,
-				      var->time);
-		if (ret != EFI_SUCCESS)
-			log_err("Failed to set EFI variable %ls\n", var->name);
+		if (var->length) {
+			ret = efi_var_mem_ins(var->name, &var->guid, var->attr,
+					      var->length, data, 0, NULL,
+					      var->time);
+			if (ret != EFI_SUCCESS) {
+				log_err("Failed to set EFI variable %ls\n",
+					var->name);
+				continue;
+			}
+		}
+		efi_var_mem_del(old);
+	}
+}
+
+efi_status_t efi_var_restore(struct efi_var_file *buf, bool safe)
+{
+	if (buf->reserved || buf->magic != EFI_VAR_FILE_MAGIC ||
+	    buf->crc32 != crc32(0, (u8 *)buf->var,
+				buf->length - sizeof(struct efi_var_file))) {
+		log_err("Invalid EFI variables file\n");
+		return EFI_INVALID_PARAMETER;
 	}
+	efi_var_restore_entries(buf, safe, false);
+
 	return EFI_SUCCESS;
 }
 
+/**
+ * efi_var_journal_from_file() - apply the changes recorded in the journal
+ *
+ * The journal is read from ubootefi.jnl on the EFI system partition. Reading
+ * stops at the first record which is not valid, e.g. if writing it was
+ * interrupted. In that case, or if the journal does not match ubootefi.var,
+ * the next change rewrites ubootefi.var and empties the journal.
+ *
+ * @buf:	buffer of EFI_VAR_BUF_SIZE bytes to use
+ */
+static void __maybe_unused efi_var_journal_from_file(void *buf)
+{
+	struct efi_var_file *rec;
+	loff_t len, pos;
+
+	if (efi_set_blk_dev_to_system_partition() != EFI_SUCCESS)
+		return;
+	if (fs_read(EFI_VAR_JOURNAL_NAME, map_to_sysmem(buf), 0,
+		    EFI_VAR_BUF_SIZE, &len)) {
+		/* There is no journal yet */
+		efi_var_journal_len = 0;
+		return;
+	}
+
+	for (pos = 0; pos + sizeof(*rec) <= len; pos += rec->length) {
+		rec = buf + pos;
+		if (rec->magic != EFI_VAR_FILE_MAGIC ||
+		    rec->length < sizeof(*rec) || rec->length > len - pos ||
+		    rec->reserved != efi_var_file_crc ||
+		    rec->crc32 != crc32(0, (u8 *)rec->var,
+					rec->length - sizeof(*rec)))
+			break;
+		efi_var_restore_entries(rec, false, true);
+	}
+	if (pos == len)
+		efi_var_journal_len = len;
+	else
+		log_warning("Ignoring invalid EFI variables journal\n");
+}
+
 /**
  * efi_var_from_file() - read variables from file
  *
@@ -176,8 +340,12 @@ efi_status_t efi_var_from_file(void)
 		log_err("Failed to load EFI variables\n");
 		goto error;
 	}
-	if (buf->length != len || efi_var_restore(buf, false) != EFI_SUCCESS)
+	if (buf->length != len || efi_var_restore(buf, false) != EFI_SUCCESS) {
 		log_err("Invalid EFI variables file\n");
+		goto error;
+	}
+	efi_var_file_crc = buf->crc32;
+	efi_var_journal_from_file(buf);
 error:
 	free(buf);
 #endif
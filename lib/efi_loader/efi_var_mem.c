@@ -10,6 +10,18 @@
 #include <efi_loader.h>
 #include <efi_variable.h>
 #include <u-boot/crc.h>
+#include <linux/log2.h>
+
+/*
+ * Variables are found through a hash table of offsets into efi_var_buf, which
+ * follows the buffer in the same runtime memory. The table has room for the
+ * largest number of variables which can fit in the buffer, so it never fills.
+ * It uses linear probing and an empty slot holds 0.
+ */
+#define EFI_VAR_INDEX_SLOTS	roundup_pow_of_two(EFI_VAR_BUF_SIZE / 32)
+#define EFI_VAR_INDEX_OFFSET	ALIGN(EFI_VAR_BUF_SIZE, 8)
+#define EFI_VAR_MEM_SIZE	(EFI_VAR_INDEX_OFFSET + \
+				 EFI_VAR_INDEX_SLOTS * sizeof(u32))
 
 /*
  * The variables efi_var_file and efi_var_entry must be static to avoid
@@ -18,50 +30,140 @@
  * relocation during SetVirtualAddressMap().
  */
 static struct efi_var_file __efi_runtime_data *efi_var_buf;
-static struct efi_var_entry __efi_runtime_data *efi_current_var;
 static const u16 __efi_runtime_rodata vtf[] = u"VarToFile";
 
+/**
+ * efi_var_index() - get the hash table of variables
+ *
+ * Return:	hash table, which follows efi_var_buf
+ */
+static u32 __efi_runtime *efi_var_index(void)
+{
+	return (u32 *)((uintptr_t)efi_var_buf + EFI_VAR_INDEX_OFFSET);
+}
+
+/**
+ * efi_var_hash() - calculate the hash of a variable's GUID and name
+ *
+ * This uses the FNV-1a hash.
+ *
+ * @guid:	GUID of the variable
+ * @name:	name of the variable
+ * Return:	index of the first slot to check in the hash table
+ */
+static u32 __efi_runtime efi_var_hash(const efi_guid_t *guid, const u16 *name)
+{
+	const u8 *data = (const u8 *)guid;
+	u32 hash = 2166136261U;
+	int i;
+
+	for (i = 0; i < sizeof(efi_guid_t); i++)
+		hash = (hash ^ data[i]) * 16777619;
+	for (; *name; name++)
+		hash = (hash ^ *name) * 16777619;
+
+	return hash & (EFI_VAR_INDEX_SLOTS - 1);
+}
+
 /**
  * efi_var_mem_compare() - compare GUID and name with a variable
  *
  * @var:	variable to compare
  * @guid:	GUID to compare
  * @name:	variable name to compare
- * @next:	pointer to next variable
  * Return:	true if match
  */
 static bool __efi_runtime
 efi_var_mem_compare(struct efi_var_entry *var, const efi_guid_t *guid,
-		    const u16 *name, struct efi_var_entry **next)
+		    const u16 *name)
 {
+	const u8 *guid1 = (u8 *)&var->guid, *guid2 = (u8 *)guid;
+	const u16 *data;
 	int i;
-	u8 *guid1, *guid2;
-	const u16 *data, *var_name;
-	bool match = true;
-
-	for (guid1 = (u8 *)&var->guid, guid2 = (u8 *)guid, i = 0;
-	     i < sizeof(efi_guid_t) && match; ++i)
-		match = (guid1[i] == guid2[i]);
 
-	for (data = var->name, var_name = name;; ++data) {
-		if (match)
-			match = (*data == *var_name);
+	for (i = 0; i < sizeof(efi_guid_t); ++i) {
+		if (guid1[i] != guid2[i])
+			return false;
+	}
+	for (data = var->name; *data == *name; ++data, ++name) {
 		if (!*data)
-			break;
-		if (*var_name)
-			++var_name;
+			return true;
 	}
 
-	++data;
+	return false;
+}
 
-	if (next)
-		*next = (struct efi_var_entry *)
-			ALIGN((uintptr_t)data + var->length, 8);
+/**
+ * efi_var_index_add() - add a variable to the hash table
+ *
+ * @var:	variable in efi_var_buf
+ */
+static void __efi_runtime efi_var_index_add(struct efi_var_entry *var)
+{
+	u32 *index = efi_var_index();
+	u32 slot;
 
-	if (match)
-		efi_current_var = var;
+	slot = efi_var_hash(&var->guid, var->name);
+	while (index[slot])
+		slot = (slot + 1) & (EFI_VAR_INDEX_SLOTS - 1);
+	index[slot] = (uintptr_t)var - (uintptr_t)efi_var_buf;
+}
+
+/**
+ * efi_var_index_del() - remove a variable from the hash table
+ *
+ * Later entries in the same run of slots are moved back as needed, so that
+ * no tombstones are needed. Offsets of variables above @var are reduced by
+ * @len, since those variables are about to be moved down over @var.
+ *
+ * @var:	variable in efi_var_buf
+ * @len:	length of the entry for @var
+ */
+static void __efi_runtime efi_var_index_del(struct efi_var_entry *var, u32 len)
+{
+	u32 offset = (uintptr_t)var - (uintptr_t)efi_var_buf;
+	u32 mask = EFI_VAR_INDEX_SLOTS - 1;
+	u32 *index = efi_var_index();
+	u32 slot, next, home;
+
+	slot = efi_var_hash(&var->guid, var->name);
+	while (index[slot] != offset)
+		slot = (slot + 1) & mask;
+	index[slot] = 0;
+
+	for (next = (slot + 1) & mask; index[next]; next = (next + 1) & mask) {
+		struct efi_var_entry *cur;
+
+		cur = (void *)efi_var_buf + index[next];
+		home = efi_var_hash(&cur->guid, cur->name);
+
+		/* Move the entry back unless its home is in (slot, next] */
+		if (((next - home) & mask) >= ((next - slot) & mask)) {
+			index[slot] = index[next];
+			index[next] = 0;
+			slot = next;
+		}
+	}
+
+	for (slot = 0; slot < EFI_VAR_INDEX_SLOTS; slot++) {
+		if (index[slot] > offset)
+			index[slot] -= len;
+	}
+}
+
+/**
+ * efi_var_index_rebuild() - add all variables in efi_var_buf to the hash table
+ */
+static void efi_var_index_rebuild(void)
+{
+	struct efi_var_entry *var, *last;
 
-	return match;
+	memset(efi_var_index(), '\0', EFI_VAR_INDEX_SLOTS * sizeof(u32));
+	last = (struct efi_var_entry *)
+	       ((uintptr_t)efi_var_buf + efi_var_buf->length);
+	for (var = efi_var_buf->var; var < last;
+	     var = (void *)var + efi_var_entry_len(var))
+		efi_var_index_add(var);
 }
 
 /**
@@ -86,6 +188,8 @@ struct efi_var_entry __efi_runtime
 		  struct efi_var_entry **next)
 {
 	struct efi_var_entry *var, *last;
+	u32 *index = efi_var_index();
+	u32 slot;
 
 	last = (struct efi_var_entry *)
 	       ((uintptr_t)efi_var_buf + efi_var_buf->length);
@@ -98,28 +202,17 @@ struct efi_var_entry __efi_runtime
 		}
 		return NULL;
 	}
-	if (efi_current_var &&
-	    efi_var_mem_compare(efi_current_var, guid, name, next)) {
-		if (next && *next >= last)
-			*next = NULL;
-		return efi_current_var;
-	}
 
-	var = efi_var_buf->var;
-	if (var < last) {
-		for (; var;) {
-			struct efi_var_entry *pos;
-			bool match;
-
-			match = efi_var_mem_compare(var, guid, name, &pos);
-			if (pos >= last)
-				pos = NULL;
-			if (match) {
-				if (next)
-					*next = pos;
-				return var;
+	for (slot = efi_var_hash(guid, name); index[slot];
+	     slot = (slot + 1) & (EFI_VAR_INDEX_SLOTS - 1)) {
+		var = (void *)efi_var_buf + index[slot];
+		if (efi_var_mem_compare(var, guid, name)) {
+			if (next) {
+				*next = (void *)var + efi_var_entry_len(var);
+				if (*next >= last)
+					*next = NULL;
 			}
-			var = pos;
+			return var;
 		}
 	}
 	if (next)
@@ -129,23 +222,18 @@ struct efi_var_entry __efi_runtime
 
 void __efi_runtime efi_var_mem_del(struct efi_var_entry *var)
 {
-	u16 *data;
 	struct efi_var_entry *next, *last;
+	u32 len;
 
 	if (!var)
 		return;
 
 	last = (struct efi_var_entry *)
 	       ((uintptr_t)efi_var_buf + efi_var_buf->length);
-	if (var <= efi_current_var)
-		efi_current_var = NULL;
-
-	for (data = var->name; *data; ++data)
-		;
-	++data;
-	next = (struct efi_var_entry *)
-	       ALIGN((uintptr_t)data + var->length, 8);
-	efi_var_buf->length -= (uintptr_t)next - (uintptr_t)var;
+	len = efi_var_entry_len(var);
+	efi_var_index_del(var, len);
+	next = (void *)var + len;
+	efi_var_buf->length -= len;
 
 	/* efi_memcpy_runtime() can be used because next >= var. */
 	efi_memcpy_runtime(var, next, (uintptr_t)last - (uintptr_t)next);
@@ -162,7 +250,7 @@ efi_status_t __efi_runtime efi_var_mem_ins(
 				const u64 time)
 {
 	u16 *data;
-	struct efi_var_entry *var;
+	struct efi_var_entry *var, *new;
 	u32 var_name_len;
 
 	var = (struct efi_var_entry *)
@@ -183,10 +271,11 @@ efi_status_t __efi_runtime efi_var_mem_ins(
 			   sizeof(u16) * var_name_len);
 	efi_memcpy_runtime(data, data1, size1);
 	efi_memcpy_runtime((u8 *)data + size1, data2, size2);
+	efi_var_index_add(var);
 
-	var = (struct efi_var_entry *)
+	new = (struct efi_var_entry *)
 	      ALIGN((uintptr_t)data + var->length, 8);
-	efi_var_buf->length = (uintptr_t)var - (uintptr_t)efi_var_buf;
+	efi_var_buf->length = (uintptr_t)new - (uintptr_t)efi_var_buf;
 	efi_var_buf->crc32 = crc32(0, (u8 *)efi_var_buf->var,
 				   efi_var_buf->length -
 				   sizeof(struct efi_var_file));
@@ -214,7 +303,6 @@ static void EFIAPI __efi_runtime
 efi_var_mem_notify_virtual_address_map(struct efi_event *event, void *context)
 {
 	efi_convert_pointer(0, (void **)&efi_var_buf);
-	efi_current_var = NULL;
 }
 
 efi_status_t efi_var_mem_init(void)
@@ -225,12 +313,12 @@ efi_status_t efi_var_mem_init(void)
 
 	ret = efi_allocate_pages(EFI_ALLOCATE_ANY_PAGES,
 				 EFI_RUNTIME_SERVICES_DATA,
-				 efi_size_in_pages(EFI_VAR_BUF_SIZE),
+				 efi_size_in_pages(EFI_VAR_MEM_SIZE),
 				 &memory);
 	if (ret != EFI_SUCCESS)
 		return ret;
 	efi_var_buf = (struct efi_var_file *)(uintptr_t)memory;
-	memset(efi_var_buf, 0, EFI_VAR_BUF_SIZE);
+	memset(efi_var_buf, 0, EFI_VAR_MEM_SIZE);
 	efi_var_buf->magic = EFI_VAR_FILE_MAGIC;
 	efi_var_buf->length = (uintptr_t)efi_var_buf->var -
 			      (uintptr_t)efi_var_buf;
@@ -399,4 +487,5 @@ skip:
 void efi_var_buf_update(struct efi_var_file *var_buf)
 {
 	memcpy(efi_var_buf, var_buf, EFI_VAR_BUF_SIZE);
+	efi_var_index_rebuild();
 }
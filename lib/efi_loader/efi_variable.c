@@ -401,7 +401,7 @@ efi_status_t efi_set_variable_int(const u16 *variable_name,
 	 * TODO: check if a value change has occured to avoid superfluous writes
 	 */
 	if (attributes & EFI_VARIABLE_NON_VOLATILE)
-		efi_var_to_file();
+		efi_var_log_to_file(variable_name, vendor, attributes);
 
 	return EFI_SUCCESS;
 }
@@ -0,0 +1,175 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * filebench.efi reads a file in 4 KiB chunks through the EFI_FILE_PROTOCOL,
+ * as boot loaders such as GRUB and systemd-boot do when loading a kernel.
+ * The file name is taken from the load options, defaulting to 'bench.bin' on
+ * the partition the app was loaded from. The time taken can be seen with the
+ * U-Boot 'perf' command. Finally it seeks back to just after the middle of the
+ * file and reads one chunk again.
+ */
+
+#include <efi_api.h>
+
+/* Size of each Read() request */
+#define CHUNK_SIZE	4096
+
+static struct efi_simple_text_output_protocol *cout;
+static struct efi_boot_services *bs;
+static efi_handle_t handle;
+
+static const efi_guid_t loaded_image_guid = EFI_LOADED_IMAGE_PROTOCOL_GUID;
+static const efi_guid_t guid_simple_file_system_protocol =
+					EFI_SIMPLE_FILE_SYSTEM_PROTOCOL_GUID;
+
+/* Aligned so that the file system can read straight into it */
+static u8 buf[CHUNK_SIZE] __aligned(64);
+
+/**
+ * print() - print string
+ *
+ * @string:	text
+ */
+static void print(u16 *string)
+{
+	cout->output_string(cout, string);
+}
+
+/**
+ * printx() - print 32-bit hexadecimal value
+ *
+ * @val:	value to print
+ */
+static void printx(u32 val)
+{
+	u16 str[11] = u"0x";
+	u16 *ptr = &str[2];
+	u16 ch;
+	int i;
+
+	for (i = 28; i >= 0; i -= 4) {
+		ch = (val >> i & 0xf) + '0';
+		if (ch > '9')
+			ch += 'a' - '9' - 1;
+		*ptr++ = ch;
+	}
+	*ptr = 0;
+	print(str);
+}
+
+/**
+ * checksum() - add the contents of the buffer to a checksum
+ *
+ * @sum:	checksum so far
+ * @size:	number of bytes in the buffer
+ * Return:	updated checksum
+ */
+static u32 checksum(u32 sum, efi_uintn_t size)
+{
+	efi_uintn_t i;
+
+	for (i = 0; i < size; i++)
+		sum = (sum << 1 | sum >> 31) + buf[i];
+
+	return sum;
+}
+
+/**
+ * efi_main() - entry point of the EFI application.
+ *
+ * @image_handle:	handle of the loaded image
+ * @systab:		system table
+ * Return:		status code
+ */
+efi_status_t EFIAPI efi_main(efi_handle_t image_handle,
+			     struct efi_system_table *systab)
+{
+	struct efi_simple_file_system_protocol *file_system;
+	struct efi_file_handle *root = NULL, *file = NULL;
+	struct efi_loaded_image *loaded_image;
+	u16 *filename = u"bench.bin";
+	u32 total = 0, chunks = 0, pos;
+	efi_uintn_t size;
+	efi_status_t ret;
+	u32 sum = 0;
+
+	handle = image_handle;
+	cout = systab->con_out;
+	bs = systab->boottime;
+
+	ret = bs->open_protocol(handle, &loaded_image_guid,
+				(void **)&loaded_image, NULL, NULL,
+				EFI_OPEN_PROTOCOL_GET_PROTOCOL);
+	if (ret != EFI_SUCCESS) {
+		print(u"Loaded image protocol not found\r\n");
+		return ret;
+	}
+	if (loaded_image->load_options_size && loaded_image->load_options)
+		filename = loaded_image->load_options;
+
+	ret = bs->open_protocol(loaded_image->device_handle,
+				&guid_simple_file_system_protocol,
+				(void **)&file_system, NULL, NULL,
+				EFI_OPEN_PROTOCOL_GET_PROTOCOL);
+	if (ret != EFI_SUCCESS) {
+		print(u"Failed to open simple file system protocol\r\n");
+		return ret;
+	}
+	ret = file_system->open_volume(file_system, &root);
+	if (ret != EFI_SUCCESS) {
+		print(u"Failed to open volume\r\n");
+		return ret;
+	}
+	ret = root->open(root, &file, filename, EFI_FILE_MODE_READ, 0);
+	if (ret != EFI_SUCCESS) {
+		print(u"File not found\r\n");
+		goto out;
+	}
+
+	do {
+		size = CHUNK_SIZE;
+		ret = file->read(file, &size, buf);
+		if (ret != EFI_SUCCESS) {
+			print(u"Read failed\r\n");
+			goto out;
+		}
+		sum = checksum(sum, size);
+		total += size;
+		chunks++;
+	} while (size == CHUNK_SIZE);
+
+	print(u"Read ");
+	printx(total);
+	print(u" bytes in ");
+	printx(chunks);
+	print(u" chunks, checksum ");
+	printx(sum);
+	print(u"\r\n");
+
+	/* Go back to a position which is not aligned to a cluster */
+	pos = total / 2 + 100;
+	ret = file->setpos(file, pos);
+	if (ret != EFI_SUCCESS) {
+		print(u"Seek failed\r\n");
+		goto out;
+	}
+	size = CHUNK_SIZE;
+	ret = file->read(file, &size, buf);
+	if (ret != EFI_SUCCESS) {
+		print(u"Read failed\r\n");
+		goto out;
+	}
+	print(u"Re-read ");
+	printx(size);
+	print(u" bytes at ");
+	printx(pos);
+	print(u", checksum ");
+	printx(checksum(0, size));
+	print(u"\r\n");
+
+out:
+	if (file)
+		file->close(file);
+	root->close(root);
+
+	return ret;
+}
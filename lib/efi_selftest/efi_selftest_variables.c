@@ -12,6 +12,7 @@
 
 #define EFI_ST_MAX_DATA_SIZE 16
 #define EFI_ST_MAX_VARNAME_SIZE 80
+#define EFI_ST_MANY_VARS 300
 
 static struct efi_boot_services *boottime;
 static struct efi_runtime_services *runtime;
@@ -37,6 +38,127 @@ static int setup(const efi_handle_t img_handle,
 	return EFI_ST_SUCCESS;
 }
 
+/*
+ * Set the name of one of many variables, efi_st_many000 to efi_st_many299
+ *
+ * @varname:	buffer for the name
+ * @i:		number of the variable
+ */
+static void many_name(u16 *varname, int i)
+{
+	const char *prefix = "efi_st_many";
+	int j;
+
+	for (j = 0; prefix[j]; j++)
+		varname[j] = prefix[j];
+	varname[j++] = '0' + i / 100;
+	varname[j++] = '0' + i / 10 % 10;
+	varname[j++] = '0' + i % 10;
+	varname[j] = 0;
+}
+
+/*
+ * Create many variables, replace and delete some, then check that they can
+ * all be found and enumerated.
+ */
+static int test_many_variables(void)
+{
+	u16 varname[EFI_ST_MAX_VARNAME_SIZE];
+	efi_uintn_t len;
+	efi_status_t ret;
+	efi_guid_t guid;
+	int count, i;
+	u32 val;
+
+	for (i = 0; i < EFI_ST_MANY_VARS; i++) {
+		many_name(varname, i);
+		val = i;
+		ret = runtime->set_variable(varname, &guid_vendor1,
+					    EFI_VARIABLE_BOOTSERVICE_ACCESS,
+					    sizeof(val), &val);
+		if (ret != EFI_SUCCESS) {
+			efi_st_error("SetVariable failed for %d\n", i);
+			return EFI_ST_FAILURE;
+		}
+		/* Replace every third variable, moving it to the end */
+		if (i % 3 == 1) {
+			val = i * 2;
+			ret = runtime->set_variable(
+					varname, &guid_vendor1,
+					EFI_VARIABLE_BOOTSERVICE_ACCESS,
+					sizeof(val), &val);
+			if (ret != EFI_SUCCESS) {
+				efi_st_error("SetVariable failed\n");
+				return EFI_ST_FAILURE;
+			}
+		}
+	}
+	/* Delete every third variable */
+	for (i = 0; i < EFI_ST_MANY_VARS; i += 3) {
+		many_name(varname, i);
+		ret = runtime->set_variable(varname, &guid_vendor1, 0, 0, NULL);
+		if (ret != EFI_SUCCESS) {
+			efi_st_error("SetVariable failed\n");
+			return EFI_ST_FAILURE;
+		}
+	}
+
+	for (i = 0; i < EFI_ST_MANY_VARS; i++) {
+		many_name(varname, i);
+		len = sizeof(val);
+		ret = runtime->get_variable(varname, &guid_vendor1, NULL, &len,
+					    &val);
+		if (i % 3 == 0) {
+			if (ret != EFI_NOT_FOUND) {
+				efi_st_error("Variable %d was not deleted\n",
+					     i);
+				return EFI_ST_FAILURE;
+			}
+			continue;
+		}
+		if (ret != EFI_SUCCESS || val != (i % 3 == 1 ? i * 2 : i)) {
+			efi_st_error("GetVariable failed for %d\n", i);
+			return EFI_ST_FAILURE;
+		}
+	}
+
+	boottime->set_mem(&guid, 16, 0);
+	*varname = 0;
+	count = 0;
+	for (;;) {
+		len = EFI_ST_MAX_VARNAME_SIZE;
+		ret = runtime->get_next_variable_name(&len, varname, &guid);
+		if (ret == EFI_NOT_FOUND)
+			break;
+		if (ret != EFI_SUCCESS) {
+			efi_st_error("GetNextVariableName failed (%u)\n",
+				     (unsigned int)ret);
+			return EFI_ST_FAILURE;
+		}
+		if (!memcmp(&guid, &guid_vendor1, sizeof(efi_guid_t)) &&
+		    !memcmp(varname, u"efi_st_many", 11 * sizeof(u16)))
+			count++;
+	}
+	if (count != EFI_ST_MANY_VARS - EFI_ST_MANY_VARS / 3) {
+		efi_st_error("GetNextVariableName found %d variables\n",
+			     count);
+		return EFI_ST_FAILURE;
+	}
+
+	for (i = 0; i < EFI_ST_MANY_VARS; i++) {
+		if (i % 3 == 0)
+			continue;
+		many_name(varname, i);
+		ret = runtime->set_variable(varname, &guid_vendor1, 0, 0, NULL);
+		if (ret != EFI_SUCCESS) {
+			efi_st_error("SetVariable failed\n");
+			return EFI_ST_FAILURE;
+		}
+	}
+
+	return EFI_ST_SUCCESS;
+}
+
 /*
  * Execute unit test.
  */
@@ -277,7 +399,7 @@ static int execute(void)
 		return EFI_ST_FAILURE;
 	}
 
-	return EFI_ST_SUCCESS;
+	return test_many_variables();
 }
 
 EFI_UNIT_TEST(variables) = {
@@ -12,6 +12,7 @@
 #include <image.h>
 #include <malloc.h>
 #include <memalign.h>
+#include <mmc.h>
 #include <u-boot/crc.h>
 #include <watchdog.h>
 #include <u-boot/zlib.h>
@@ -116,19 +117,113 @@ void gzwrite_progress_finish(int returnval,
 	}
 }
 
+/**
+ * gzwrite_erase_size() - get the number of blocks erased together
+ *
+ * Without trim, an MMC device erases whole erase groups, so erasing part of
+ * a group destroys the rest of it
+ *
+ * @dev:	block device descriptor
+ * Return: number of blocks in each erase unit, a power of two
+ */
+static lbaint_t gzwrite_erase_size(struct blk_desc *dev)
+{
+	struct mmc *mmc;
+
+	if (!CONFIG_IS_ENABLED(MMC) || dev->uclass_id != UCLASS_MMC)
+		return 1;
+	mmc = find_mmc_device(dev->devnum);
+	if (!mmc || mmc->can_trim || !mmc->erase_grp_size)
+		return 1;
+
+	return mmc->erase_grp_size;
+}
+
+/**
+ * gzwrite_zero_fill() - write zeros to a range of blocks
+ *
+ * @dev:	block device descriptor
+ * @start:	first block to write
+ * @count:	number of blocks to write
+ * @zerobuf:	buffer of zeros
+ * @bufblks:	size of @zerobuf in blocks
+ * Return: 0 if OK, -EIO if the blocks could not be written
+ */
+static int gzwrite_zero_fill(struct blk_desc *dev, lbaint_t start,
+			     lbaint_t count, const void *zerobuf,
+			     lbaint_t bufblks)
+{
+	lbaint_t n;
+
+	for (; count; start += n, count -= n) {
+		n = min(count, bufblks);
+		if (blk_dwrite(dev, start, n, zerobuf) != n) {
+			printf("%s: failed to write " LBAF " blocks at " LBAF "\n",
+			       __func__, n, start);
+			return -EIO;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * gzwrite_zero_run() - handle a run of blocks which are all zero
+ *
+ * When erasing, only the whole erase units within the run are erased. The
+ * blocks at either end are written with zeros instead, so that the data
+ * sharing an erase unit with them is kept.
+ *
+ * @dev:	block device descriptor
+ * @zeros:	how to handle the blocks
+ * @start:	first block of the run
+ * @count:	number of blocks in the run
+ * @zerobuf:	buffer of zeros, used with GZWRITE_ZEROS_ERASE
+ * @bufblks:	size of @zerobuf in blocks
+ * Return: 0 if OK, -EIO if the blocks could not be erased or written
+ */
+static int gzwrite_zero_run(struct blk_desc *dev, enum gzwrite_zeros zeros,
+			    lbaint_t start, lbaint_t count,
+			    const void *zerobuf, lbaint_t bufblks)
+{
+	lbaint_t grp, first, end;
+
+	if (!count || zeros != GZWRITE_ZEROS_ERASE)
+		return 0;
+
+	grp = gzwrite_erase_size(dev);
+	first = ALIGN(start, grp);
+	end = ALIGN_DOWN(start + count, grp);
+	if (first >= end)
+		return gzwrite_zero_fill(dev, start, count, zerobuf, bufblks);
+
+	if (blk_derase(dev, first, end - first) != end - first) {
+		printf("%s: failed to erase " LBAF " blocks at " LBAF "\n",
+		       __func__, end - first, first);
+		return -EIO;
+	}
+	if (gzwrite_zero_fill(dev, start, first - start, zerobuf, bufblks))
+		return -EIO;
+
+	return gzwrite_zero_fill(dev, end, start + count - end, zerobuf,
+				 bufblks);
+}
+
 int gzwrite(unsigned char *src, int len,
 	    struct blk_desc *dev,
 	    unsigned long szwritebuf,
 	    ulong startoffs,
-	    ulong szexpected)
+	    ulong szexpected,
+	    enum gzwrite_zeros zeros)
 {
 	int i, flags;
 	z_stream s;
 	int r = 0;
-	unsigned char *writebuf;
+	unsigned char *writebuf, *zerobuf = NULL;
 	unsigned crc = 0;
 	ulong totalfilled = 0;
 	lbaint_t blksperbuf, outblock;
+	lbaint_t zero_start = 0, zero_blocks = 0;
 	u32 expected_crc;
 	u32 payload_size;
 	int iteration = 0;
@@ -206,6 +301,15 @@ int gzwrite(unsigned char *src, int len,
 	s.next_in = src + i;
 	s.avail_in = payload_size+8;
 	writebuf = (unsigned char *)malloc_cache_aligned(szwritebuf);
+	if (zeros == GZWRITE_ZEROS_ERASE) {
+		zerobuf = malloc_cache_aligned(szwritebuf);
+		if (!zerobuf) {
+			puts("Error: out of memory\n");
+			r = -1;
+			goto out;
+		}
+		memset(zerobuf, '\0', szwritebuf);
+	}
 
 	/* decompress until deflate stream ends or end of file */
 	do {
@@ -244,8 +348,26 @@ int gzwrite(unsigned char *src, int len,
 			gzwrite_progress(iteration++,
 					 totalfilled,
 					 szexpected);
-			blocks_written = blk_dwrite(dev, outblock,
-						    writeblocks, writebuf);
+			if (zeros != GZWRITE_ZEROS_WRITE &&
+			    !memchr_inv(writebuf, '\0',
+					writeblocks * dev->blksz)) {
+				/* add to the current run of zero blocks */
+				if (!zero_blocks)
+					zero_start = outblock;
+				zero_blocks += writeblocks;
+				blocks_written = writeblocks;
+			} else {
+				if (gzwrite_zero_run(dev, zeros, zero_start,
+						     zero_blocks, zerobuf,
+						     blksperbuf)) {
+					r = -1;
+					goto out;
+				}
+				zero_blocks = 0;
+				blocks_written = blk_dwrite(dev, outblock,
+							    writeblocks,
+							    writebuf);
+			}
 			outblock += blocks_written;
 			if (ctrlc()) {
 				puts("abort\n");
@@ -256,7 +378,10 @@ int gzwrite(unsigned char *src, int len,
 		/* done when inflate() says it's done */
 	} while (r != Z_STREAM_END);
 
-	if ((szexpected != totalfilled) ||
+	if (gzwrite_zero_run(dev, zeros, zero_start, zero_blocks, zerobuf,
+			     blksperbuf))
+		r = -1;
+	else if ((szexpected != totalfilled) ||
 	    (crc != expected_crc))
 		r = -1;
 	else
@@ -265,6 +390,7 @@ int gzwrite(unsigned char *src, int len,
 out:
 	gzwrite_progress_finish(r, totalfilled, szexpected,
 				expected_crc, crc);
+	free(zerobuf);
 	free(writebuf);
 	inflateEnd(&s);
 
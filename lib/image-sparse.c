@@ -37,11 +37,13 @@
 #include <config.h>
 #include <blk.h>
 #include <image-sparse.h>
+#include <display_options.h>
 #include <div64.h>
 #include <log.h>
 #include <malloc.h>
 #include <part.h>
 #include <sparse_format.h>
+#include <time.h>
 #include <asm/cache.h>
 
 #include <linux/math64.h>
@@ -49,66 +51,248 @@
 
 static void default_log(const char *ignored, char *response) {}
 
+/* Types of data handled while writing an image, for statistics */
+enum sparse_stat {
+	SPARSE_STAT_RAW,
+	SPARSE_STAT_FILL,
+	SPARSE_STAT_ERASE,
+	SPARSE_STAT_SKIP,
+
+	SPARSE_STAT_COUNT,
+};
+
+static const char *const sparse_stat_name[SPARSE_STAT_COUNT] = {
+	"raw", "fill", "erase", "skip",
+};
+
+/**
+ * struct sparse_ctx - state while writing a sparse image
+ *
+ * @raw_buf: DMA-aligned buffer of FASTBOOT_MAX_BLK_WRITE blocks, gathering
+ *	consecutive raw chunks so that they are written together
+ * @raw_blks: number of blocks waiting to be written from @raw_buf
+ * @fill_buf: DMA-aligned buffer for fill chunks, NULL until needed
+ * @fill_val: value which @fill_buf is filled with
+ * @bytes: number of bytes handled for each enum sparse_stat
+ * @us: time taken in microseconds for each enum sparse_stat
+ */
+struct sparse_ctx {
+	void *raw_buf;
+	lbaint_t raw_blks;
+	uint32_t *fill_buf;
+	uint32_t fill_val;
+	u64 bytes[SPARSE_STAT_COUNT];
+	u64 us[SPARSE_STAT_COUNT];
+};
+
+/**
+ * write_sparse_fail() - report a failed write
+ *
+ * @write_blks: value returned by the write, -ve or less than @n
+ * @blk: first block of the write
+ * @n: number of blocks in the write
+ * @info: storage which was written to
+ * @response: response buffer for error messages
+ * Return: -ve error code
+ */
+static lbaint_t write_sparse_fail(lbaint_t write_blks, lbaint_t blk,
+				  lbaint_t n, struct sparse_storage *info,
+				  char *response)
+{
+	if (IS_ERR_VALUE(write_blks)) {
+		printf("%s: Write failed, block #" LBAFU " [" LBAFU "] (%lld)\n",
+		       __func__, blk, n, (long long)write_blks);
+		info->mssg("flash write failure", response);
+		return write_blks;
+	}
+
+	/* write_blks < n */
+	printf("%s: Write failed, block #" LBAFU " [" LBAFU "]\n",
+	       __func__, blk, n);
+	info->mssg("flash write failure(incomplete)", response);
+	return -1;
+}
+
+/**
+ * flush_sparse_raw() - write out the raw chunk data waiting in the buffer
+ *
+ * @info: storage to write to
+ * @ctx: sparse-image state
+ * @blk: block to write the data to
+ * @response: response buffer for error messages
+ * Return: number of blocks used on the storage, which may be more than were
+ *	written (e.g. due to NAND bad blocks), or -ve on error
+ */
+static lbaint_t flush_sparse_raw(struct sparse_storage *info,
+				 struct sparse_ctx *ctx, lbaint_t blk,
+				 char *response)
+{
+	lbaint_t n = ctx->raw_blks, write_blks;
+
+	if (!n)
+		return 0;
+	ctx->raw_blks = 0;
+
+	/* write_blks might be > n due to NAND bad-blocks */
+	write_blks = info->write(info, blk, n, ctx->raw_buf);
+	if (IS_ERR_VALUE(write_blks) || write_blks < n)
+		return write_sparse_fail(write_blks, blk, n, info, response);
+
+	return write_blks;
+}
+
+/**
+ * write_sparse_chunk_raw() - write a raw chunk
+ *
+ * The data is copied to a DMA-aligned buffer, where it is held until the
+ * buffer is full or a chunk of another type comes along. The caller must
+ * call flush_sparse_raw() to write out what is left.
+ *
+ * @info: storage to write to
+ * @ctx: sparse-image state
+ * @blk: block to write the buffer to, i.e. the first block not yet written
+ * @blkcnt: number of blocks in the chunk
+ * @data: chunk data
+ * @response: response buffer for error messages
+ * Return: number of blocks used on the storage by writes done in this call,
+ *	or -ve on error
+ */
 static lbaint_t write_sparse_chunk_raw(struct sparse_storage *info,
-				       lbaint_t blk, lbaint_t blkcnt,
-				       void *data,
+				       struct sparse_ctx *ctx, lbaint_t blk,
+				       lbaint_t blkcnt, void *data,
 				       char *response)
 {
-	lbaint_t n = blkcnt, write_blks, blks = 0;
-	lbaint_t aligned_buf_blks = FASTBOOT_MAX_BLK_WRITE;
-	uint32_t *aligned_buf = NULL;
+	lbaint_t n, write_blks, blks = 0;
 
 	if (CONFIG_IS_ENABLED(SYS_DCACHE_OFF)) {
-		write_blks = info->write(info, blk, n, data);
-		if (write_blks < n)
-			goto write_fail;
+		write_blks = info->write(info, blk, blkcnt, data);
+		if (IS_ERR_VALUE(write_blks) || write_blks < blkcnt)
+			return write_sparse_fail(write_blks, blk, blkcnt, info,
+						 response);
 
 		return write_blks;
 	}
 
-	aligned_buf = memalign(ARCH_DMA_MINALIGN, info->blksz * aligned_buf_blks);
-	if (!aligned_buf) {
-		info->mssg("Malloc failed for: CHUNK_TYPE_RAW", response);
-		return -ENOMEM;
+	if (!ctx->raw_buf) {
+		ctx->raw_buf = memalign(ARCH_DMA_MINALIGN,
+					info->blksz * FASTBOOT_MAX_BLK_WRITE);
+		if (!ctx->raw_buf) {
+			info->mssg("Malloc failed for: CHUNK_TYPE_RAW",
+				   response);
+			return -ENOMEM;
+		}
 	}
 
 	while (blkcnt > 0) {
-		n = min(aligned_buf_blks, blkcnt);
-		memcpy(aligned_buf, data, n * info->blksz);
-
-		/* write_blks might be > n due to NAND bad-blocks */
-		write_blks = info->write(info, blk + blks, n, aligned_buf);
-		if (write_blks < n) {
-			free(aligned_buf);
-			goto write_fail;
-		}
-
-		blks += write_blks;
+		n = min_t(lbaint_t, FASTBOOT_MAX_BLK_WRITE - ctx->raw_blks,
+			  blkcnt);
+		memcpy(ctx->raw_buf + ctx->raw_blks * info->blksz, data,
+		       n * info->blksz);
+		ctx->raw_blks += n;
 		data += n * info->blksz;
 		blkcnt -= n;
+
+		if (ctx->raw_blks == FASTBOOT_MAX_BLK_WRITE) {
+			write_blks = flush_sparse_raw(info, ctx, blk + blks,
+						      response);
+			if (IS_ERR_VALUE(write_blks))
+				return write_blks;
+			blks += write_blks;
+		}
 	}
 
-	free(aligned_buf);
 	return blks;
+}
 
-write_fail:
-	if (IS_ERR_VALUE(write_blks)) {
-		printf("%s: Write failed, block #" LBAFU " [" LBAFU "] (%lld)\n",
-		       __func__, blk + blks, n, (long long)write_blks);
-		info->mssg("flash write failure", response);
-		return write_blks;
+/**
+ * write_sparse_chunk_fill() - write a fill chunk
+ *
+ * @info: storage to write to
+ * @ctx: sparse-image state
+ * @blk: first block to write
+ * @blkcnt: number of blocks to fill
+ * @fill_val: 32-bit value to fill the blocks with
+ * @response: response buffer for error messages
+ * Return: number of blocks used on the storage, or -ve on error
+ */
+static lbaint_t write_sparse_chunk_fill(struct sparse_storage *info,
+					struct sparse_ctx *ctx, lbaint_t blk,
+					lbaint_t blkcnt, uint32_t fill_val,
+					char *response)
+{
+	int fill_buf_num_blks = CONFIG_IMAGE_SPARSE_FILLBUF_SIZE / info->blksz;
+	lbaint_t blks, used = 0;
+	int i;
+	int j;
+
+	if (!ctx->fill_buf) {
+		ctx->fill_buf = (uint32_t *)
+				memalign(ARCH_DMA_MINALIGN,
+					 ROUNDUP(info->blksz * fill_buf_num_blks,
+						 ARCH_DMA_MINALIGN));
+		if (!ctx->fill_buf) {
+			info->mssg("Malloc failed for: CHUNK_TYPE_FILL",
+				   response);
+			return -ENOMEM;
+		}
+		/* make sure that the buffer is filled below */
+		ctx->fill_val = ~fill_val;
 	}
 
-	/* write_blks < n */
-	printf("%s: Write failed, block #" LBAFU " [" LBAFU "]\n",
-	       __func__, blk + blks, n);
-	info->mssg("flash write failure(incomplete)", response);
-	return -1;
+	if (ctx->fill_val != fill_val) {
+		for (i = 0;
+		     i < (info->blksz * fill_buf_num_blks / sizeof(fill_val));
+		     i++)
+			ctx->fill_buf[i] = fill_val;
+		ctx->fill_val = fill_val;
+	}
+
+	for (i = 0; i < blkcnt;) {
+		j = blkcnt - i;
+		if (j > fill_buf_num_blks)
+			j = fill_buf_num_blks;
+		blks = info->write(info, blk + used, j, ctx->fill_buf);
+		/* blks might be > j (eg. NAND bad-blocks) */
+		if (IS_ERR_VALUE(blks) || blks < j) {
+			printf("%s: %s " LBAFU " [%d]\n", __func__,
+			       "Write failed, block #", blk + used, j);
+			info->mssg("flash write failure", response);
+			return -EIO;
+		}
+		used += blks;
+		i += j;
+	}
+
+	return used;
+}
+
+/**
+ * show_sparse_stats() - show the amount of data handled and the rate achieved
+ *
+ * @ctx: sparse-image state
+ */
+static void show_sparse_stats(struct sparse_ctx *ctx)
+{
+	int i;
+
+	for (i = 0; i < SPARSE_STAT_COUNT; i++) {
+		if (!ctx->bytes[i])
+			continue;
+		printf("........ %s: %llu bytes in %llu ms", sparse_stat_name[i],
+		       ctx->bytes[i], div_u64(ctx->us[i], 1000));
+		if (ctx->us[i]) {
+			puts(" (");
+			print_size(div64_u64(ctx->bytes[i] * 1000000,
+					     ctx->us[i]), "/s)");
+		}
+		puts("\n");
+	}
 }
 
 int write_sparse_image(struct sparse_storage *info,
 		       const char *part_name, void *data, char *response)
 {
+	struct sparse_ctx ctx = {};
 	lbaint_t blk;
 	lbaint_t blkcnt;
 	lbaint_t blks;
@@ -116,16 +300,13 @@ int write_sparse_image(struct sparse_storage *info,
 	unsigned int chunk;
 	unsigned int offset;
 	uint64_t chunk_data_sz;
-	uint32_t *fill_buf = NULL;
 	uint32_t fill_val;
 	sparse_header_t *sparse_header;
 	chunk_header_t *chunk_header;
 	uint32_t total_blocks = 0;
-	int fill_buf_num_blks;
-	int i;
-	int j;
-
-	fill_buf_num_blks = CONFIG_IMAGE_SPARSE_FILLBUF_SIZE / info->blksz;
+	enum sparse_stat stat;
+	ulong start;
+	int ret = -1;
 
 	/* Read and skip over sparse image header */
 	sparse_header = (sparse_header_t *)data;
@@ -166,7 +347,10 @@ int write_sparse_image(struct sparse_storage *info,
 
 	puts("Flashing Sparse Image\n");
 
-	/* Start processing chunks */
+	/*
+	 * Start processing chunks. Raw chunks may be waiting in ctx.raw_buf,
+	 * in which case blk is the block they are to be written to.
+	 */
 	blk = info->start;
 	for (chunk = 0; chunk < sparse_header->total_chunks; chunk++) {
 		/* Read and skip over chunk header */
@@ -189,6 +373,18 @@ int write_sparse_image(struct sparse_storage *info,
 				 sizeof(chunk_header_t));
 		}
 
+		/* Fill and don't-care chunks need to know where they start */
+		start = timer_get_us();
+		if (chunk_header->chunk_type == CHUNK_TYPE_FILL ||
+		    chunk_header->chunk_type == CHUNK_TYPE_DONT_CARE) {
+			blks = flush_sparse_raw(info, &ctx, blk, response);
+			if (IS_ERR_VALUE(blks))
+				goto out;
+			blk += blks;
+			ctx.us[SPARSE_STAT_RAW] += timer_get_us() - start;
+			start = timer_get_us();
+		}
+
 		chunk_data_sz = ((u64)sparse_header->blk_sz) * chunk_header->chunk_sz;
 		blkcnt = DIV_ROUND_UP_ULL(chunk_data_sz, info->blksz);
 		switch (chunk_header->chunk_type) {
@@ -197,93 +393,73 @@ int write_sparse_image(struct sparse_storage *info,
 			    (sparse_header->chunk_hdr_sz + chunk_data_sz)) {
 				info->mssg("Bogus chunk size for chunk type Raw",
 					   response);
-				return -1;
+				goto out;
 			}
 
-			if (blk + blkcnt > info->start + info->size) {
+			if (blk + ctx.raw_blks + blkcnt >
+			    info->start + info->size) {
 				printf(
 				    "%s: Request would exceed partition size!\n",
 				    __func__);
 				info->mssg("Request would exceed partition size!",
 					   response);
-				return -1;
+				goto out;
 			}
 
-			blks = write_sparse_chunk_raw(info, blk, blkcnt,
+			blks = write_sparse_chunk_raw(info, &ctx, blk, blkcnt,
 						      data, response);
 			if (IS_ERR_VALUE(blks))
-				return -1;
+				goto out;
 
 			blk += blks;
 			bytes_written += ((u64)blkcnt) * info->blksz;
 			total_blocks += chunk_header->chunk_sz;
 			data += chunk_data_sz;
+			stat = SPARSE_STAT_RAW;
 			break;
 
 		case CHUNK_TYPE_FILL:
 			if (chunk_header->total_sz !=
 			    (sparse_header->chunk_hdr_sz + sizeof(uint32_t))) {
 				info->mssg("Bogus chunk size for chunk type FILL", response);
-				return -1;
-			}
-
-			fill_buf = (uint32_t *)
-				   memalign(ARCH_DMA_MINALIGN,
-					    ROUNDUP(
-						info->blksz * fill_buf_num_blks,
-						ARCH_DMA_MINALIGN));
-			if (!fill_buf) {
-				info->mssg("Malloc failed for: CHUNK_TYPE_FILL",
-					   response);
-				return -1;
+				goto out;
 			}
 
 			fill_val = *(uint32_t *)data;
 			data = (char *)data + sizeof(uint32_t);
 
-			for (i = 0;
-			     i < (info->blksz * fill_buf_num_blks /
-				  sizeof(fill_val));
-			     i++)
-				fill_buf[i] = fill_val;
-
 			if (blk + blkcnt > info->start + info->size) {
 				printf(
 				    "%s: Request would exceed partition size!\n",
 				    __func__);
 				info->mssg("Request would exceed partition size!",
 					   response);
-				return -1;
+				goto out;
 			}
 
-			for (i = 0; i < blkcnt;) {
-				j = blkcnt - i;
-				if (j > fill_buf_num_blks)
-					j = fill_buf_num_blks;
-				blks = info->write(info, blk, j, fill_buf);
-				/* blks might be > j (eg. NAND bad-blocks) */
-				if (blks < j) {
-					printf("%s: %s " LBAFU " [%d]\n",
-					       __func__,
-					       "Write failed, block #",
-					       blk, j);
-					info->mssg("flash write failure",
-						   response);
-					free(fill_buf);
-					return -1;
-				}
+			/* Erasing is much faster than writing zeroes */
+			if (!fill_val && info->erase &&
+			    info->erase(info, blk, blkcnt) == blkcnt) {
+				blk += blkcnt;
+				stat = SPARSE_STAT_ERASE;
+			} else {
+				blks = write_sparse_chunk_fill(info, &ctx, blk,
+							       blkcnt, fill_val,
+							       response);
+				if (IS_ERR_VALUE(blks))
+					goto out;
 				blk += blks;
-				i += j;
+				stat = SPARSE_STAT_FILL;
 			}
 			bytes_written += ((u64)blkcnt) * info->blksz;
 			total_blocks += DIV_ROUND_UP_ULL(chunk_data_sz,
 							 sparse_header->blk_sz);
-			free(fill_buf);
 			break;
 
 		case CHUNK_TYPE_DONT_CARE:
 			blk += info->reserve(info, blk, blkcnt);
 			total_blocks += chunk_header->chunk_sz;
+			stat = SPARSE_STAT_SKIP;
 			break;
 
 		case CHUNK_TYPE_CRC32:
@@ -291,28 +467,42 @@ int write_sparse_image(struct sparse_storage *info,
 			    sparse_header->chunk_hdr_sz + sizeof(uint32_t)) {
 				info->mssg("Bogus chunk size for chunk type CRC32",
 					   response);
-				return -1;
+				goto out;
 			}
 			total_blocks += chunk_header->chunk_sz;
 			data += chunk_data_sz;
-			break;
+			continue;
 
 		default:
 			printf("%s: Unknown chunk type: %x\n", __func__,
 			       chunk_header->chunk_type);
 			info->mssg("Unknown chunk type", response);
-			return -1;
+			goto out;
 		}
+		ctx.bytes[stat] += chunk_data_sz;
+		ctx.us[stat] += timer_get_us() - start;
 	}
 
+	start = timer_get_us();
+	blks = flush_sparse_raw(info, &ctx, blk, response);
+	if (IS_ERR_VALUE(blks))
+		goto out;
+	ctx.us[SPARSE_STAT_RAW] += timer_get_us() - start;
+
 	debug("Wrote %d blocks, expected to write %d blocks\n",
 	      total_blocks, sparse_header->total_blks);
 	printf("........ wrote %llu bytes to '%s'\n", bytes_written, part_name);
+	show_sparse_stats(&ctx);
 
 	if (total_blocks != sparse_header->total_blks) {
 		info->mssg("sparse image write failure", response);
-		return -1;
+		goto out;
 	}
+	ret = 0;
+
+out:
+	free(ctx.fill_buf);
+	free(ctx.raw_buf);
 
-	return 0;
+	return ret;
 }
@@ -7,6 +7,7 @@
 #include <image.h>
 #include <linux/kernel.h>
 #include <linux/types.h>
+#include <linux/xxhash.h>
 #include <asm/unaligned.h>
 #include <u-boot/lz4.h>
 
@@ -15,59 +16,164 @@
 
 #define LZ4F_BLOCKUNCOMPRESSED_FLAG 0x80000000U
 
-__rcode int ulz4fn(const void *src, size_t srcn, void *dst, size_t *dstn)
+/**
+ * struct lz4_frame - information about an LZ4 frame, from its header
+ *
+ * @blocks: First block header
+ * @has_block_checksum: true if each block is followed by its checksum
+ * @has_content_checksum: true if the frame ends with a checksum of the
+ *	uncompressed data
+ * @content_checksum: Expected checksum of the uncompressed data, if
+ *	@has_content_checksum
+ */
+struct lz4_frame {
+	const void *blocks;
+	bool has_block_checksum;
+	bool has_content_checksum;
+	u32 content_checksum;
+};
+
+/**
+ * lz4_parse_header() - parse and check the header of an LZ4 frame
+ *
+ * @src: Start of frame
+ * @srcn: Length of source data
+ * @frame: Returns information about the frame
+ * Return: 0 if OK, -ve on error (see ulz4fn())
+ */
+static __rcode int lz4_parse_header(const void *src, size_t srcn,
+				    struct lz4_frame *frame)
 {
-	const void *end = dst + *dstn;
 	const void *in = src;
-	void *out = dst;
-	int has_block_checksum;
-	int ret;
-	*dstn = 0;
+	u32 magic;
+	u8 flags, version, independent_blocks, has_content_size;
+	u8 block_desc;
+
+	if (srcn < sizeof(u32) + 3*sizeof(u8))
+		return -EINVAL;	/* input overrun */
+
+	magic = get_unaligned_le32(in);
+	in += sizeof(u32);
+	flags = *(u8 *)in;
+	in += sizeof(u8);
+	block_desc = *(u8 *)in;
+	in += sizeof(u8);
+
+	version = (flags >> 6) & 0x3;
+	independent_blocks = (flags >> 5) & 0x1;
+	frame->has_block_checksum = (flags >> 4) & 0x1;
+	has_content_size = (flags >> 3) & 0x1;
+	frame->has_content_checksum = (flags >> 2) & 0x1;
+
+	/* We assume there's always only a single, standard frame. */
+	if (magic != LZ4F_MAGIC || version != 1)
+		return -EPROTONOSUPPORT;	/* unknown format */
+	if ((flags & 0x03) || (block_desc & 0x8f))
+		return -EINVAL;	/* reserved bits must be zero */
+	if (!independent_blocks)
+		return -EPROTONOSUPPORT; /* we can't support this yet */
+
+	if (has_content_size) {
+		if (srcn < sizeof(u32) + 3*sizeof(u8) + sizeof(u64))
+			return -EINVAL;	/* input overrun */
+		in += sizeof(u64);
+	}
 
-	{ /* With in-place decompression the header may become invalid later. */
-		u32 magic;
-		u8 flags, version, independent_blocks, has_content_size;
-		u8 block_desc;
+	/* Header checksum byte, covering the frame descriptor */
+	if (CONFIG_IS_ENABLED(LZ4_CHECKSUM) &&
+	    *(u8 *)in != ((xxh32(src + sizeof(u32), in - src - sizeof(u32),
+				 0) >> 8) & 0xff))
+		return -EBADMSG;
+	in += sizeof(u8);
+	frame->blocks = in;
 
-		if (srcn < sizeof(u32) + 3*sizeof(u8))
-			return -EINVAL;	/* input overrun */
+	return 0;
+}
+
+/**
+ * lz4_scan_blocks() - check the block table of an LZ4 frame
+ *
+ * This walks through the block headers, checking that each block lies within
+ * the source data and, if enabled, that the block checksums match. This is
+ * done before anything is written to the output, since with in-place
+ * decompression the input is overwritten as the blocks are decoded.
+ *
+ * @src: Start of frame
+ * @srcn: Length of source data
+ * @frame: Frame information, updated with the content checksum
+ * Return: 0 if OK, -EINVAL on input overrun, -EBADMSG on checksum mismatch
+ */
+static __rcode int lz4_scan_blocks(const void *src, size_t srcn,
+				   struct lz4_frame *frame)
+{
+	const void *in = frame->blocks;
+	u32 block_header, block_size;
 
-		magic = get_unaligned_le32(in);
+	while (1) {
+		if (in - src + sizeof(u32) > srcn)
+			return -EINVAL;	/* input overrun */
+		block_header = get_unaligned_le32(in);
 		in += sizeof(u32);
-		flags = *(u8 *)in;
-		in += sizeof(u8);
-		block_desc = *(u8 *)in;
-		in += sizeof(u8);
-
-		version = (flags >> 6) & 0x3;
-		independent_blocks = (flags >> 5) & 0x1;
-		has_block_checksum = (flags >> 4) & 0x1;
-		has_content_size = (flags >> 3) & 0x1;
-
-		/* We assume there's always only a single, standard frame. */
-		if (magic != LZ4F_MAGIC || version != 1)
-			return -EPROTONOSUPPORT;	/* unknown format */
-		if ((flags & 0x03) || (block_desc & 0x8f))
-			return -EINVAL;	/* reserved bits must be zero */
-		if (!independent_blocks)
-			return -EPROTONOSUPPORT; /* we can't support this yet */
-
-		if (has_content_size) {
-			if (srcn < sizeof(u32) + 3*sizeof(u8) + sizeof(u64))
+		block_size = block_header & ~LZ4F_BLOCKUNCOMPRESSED_FLAG;
+		if (!block_size)
+			break;
+
+		if (in - src + block_size > srcn)
+			return -EINVAL;	/* input overrun */
+		if (frame->has_block_checksum) {
+			if (in - src + block_size + sizeof(u32) > srcn)
 				return -EINVAL;	/* input overrun */
-			in += sizeof(u64);
+			if (CONFIG_IS_ENABLED(LZ4_CHECKSUM) &&
+			    get_unaligned_le32(in + block_size) !=
+			    xxh32(in, block_size, 0))
+				return -EBADMSG;
+			in += sizeof(u32);
 		}
-		/* Header checksum byte */
-		in += sizeof(u8);
+		in += block_size;
 	}
 
+	if (frame->has_content_checksum) {
+		if (in - src + sizeof(u32) > srcn)
+			return -EINVAL;	/* input overrun */
+		frame->content_checksum = get_unaligned_le32(in);
+	}
+
+	return 0;
+}
+
+__rcode int ulz4fn(const void *src, size_t srcn, void *dst, size_t *dstn)
+{
+	const void *end = dst + *dstn;
+	struct xxh32_state state;
+	struct lz4_frame frame;
+	const void *in;
+	void *out = dst;
+	int ret;
+	*dstn = 0;
+
+	/* With in-place decompression the header may become invalid later. */
+	ret = lz4_parse_header(src, srcn, &frame);
+	if (ret)
+		return ret;
+	ret = lz4_scan_blocks(src, srcn, &frame);
+	if (ret)
+		return ret;
+
+	if (CONFIG_IS_ENABLED(LZ4_CHECKSUM))
+		xxh32_reset(&state, 0);
+	in = frame.blocks;
 	while (1) {
 		u32 block_header, block_size;
+		void *block_out = out;
 
 		block_header = get_unaligned_le32(in);
 		in += sizeof(u32);
 		block_size = block_header & ~LZ4F_BLOCKUNCOMPRESSED_FLAG;
 
+		/*
+		 * The block table was checked above, but with in-place
+		 * decompression the output may have overwritten it since
+		 */
 		if (in - src + block_size > srcn) {
 			ret = -EINVAL;		/* input overrun */
 			break;
@@ -97,12 +203,19 @@ __rcode int ulz4fn(const void *src, size_t srcn, void *dst, size_t *dstn)
 			}
 			out += ret;
 		}
+		if (CONFIG_IS_ENABLED(LZ4_CHECKSUM))
+			xxh32_update(&state, block_out, out - block_out);
 
 		in += block_size;
-		if (has_block_checksum)
+		if (frame.has_block_checksum)
 			in += sizeof(u32);
 	}
 
+	if (CONFIG_IS_ENABLED(LZ4_CHECKSUM) && !ret &&
+	    frame.has_content_checksum &&
+	    xxh32_digest(&state) != frame.content_checksum)
+		ret = -EBADMSG;
+
 	*dstn = out - dst;
 	return ret;
 }
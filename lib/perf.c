@@ -0,0 +1,250 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Performance counters for block, network, filesystem and other hot paths
+ */
+
+#include <bloblist.h>
+#include <event.h>
+#include <fs.h>
+#include <log.h>
+#include <perf.h>
+#include <time.h>
+#include <asm/global_data.h>
+#include <linux/bitops.h>
+#include <linux/errno.h>
+#include <linux/kernel.h>
+#include <linux/math64.h>
+#include <linux/time.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+/**
+ * struct perf_counter - A performance counter, as kept in U-Boot
+ *
+ * @ops: Number of operations
+ * @bytes: Number of bytes transferred
+ * @ticks: Total time taken, in timer ticks
+ * @hist: Histogram of time per operation, see struct perf_rec
+ */
+struct perf_counter {
+	u64 ops;
+	u64 bytes;
+	u64 ticks;
+	u32 hist[PERF_HIST_BUCKETS];
+};
+
+static struct perf_counter perf_data[PERF_COUNT];
+
+static const char *const perf_name[] = {
+	"blk.read",
+	"blk.write",
+	"blk.erase",
+	"net.rx",
+	"net.tx",
+	"net.retransmit",
+
+	/* filesystems, in order of FS_TYPE_... */
+	"fs.other",
+	"fs.fat",
+	"fs.ext4",
+	"fs.sandbox",
+	"fs.ubifs",
+	"fs.btrfs",
+	"fs.squashfs",
+	"fs.erofs",
+	"fs.semihosting",
+	"fs.exfat",
+
+	"hash",
+	"decomp",
+	"malloc",
+	"free",
+};
+
+_Static_assert(ARRAY_SIZE(perf_name) == PERF_COUNT, "perf_name size");
+_Static_assert(FS_TYPE_EXFAT < PERF_FS_TYPES, "PERF_FS_TYPES too small");
+
+/* Counters are in BSS, so cannot be used before relocation */
+static bool perf_ready(void)
+{
+	return gd->flags & GD_FLG_RELOC;
+}
+
+static u64 perf_ticks_to_ns(u64 ticks)
+{
+	ulong rate = get_tbclk();
+	u64 secs = ticks;
+	u32 rem;
+
+	if (!rate)
+		return 0;
+	rem = do_div(secs, rate);
+
+	return secs * NSEC_PER_SEC + div_u64((u64)rem * NSEC_PER_SEC, rate);
+}
+
+u64 perf_begin(void)
+{
+	if (!perf_ready())
+		return 0;
+
+	return get_ticks();
+}
+
+void perf_end(enum perf_id id, u64 start, u64 bytes)
+{
+	struct perf_counter *ctr;
+	u64 ticks, us;
+
+	if (!perf_ready() || id >= PERF_COUNT)
+		return;
+	ctr = &perf_data[id];
+	ctr->ops++;
+	ctr->bytes += bytes;
+	if (!start)
+		return;
+
+	ticks = get_ticks() - start;
+	ctr->ticks += ticks;
+	us = div_u64(perf_ticks_to_ns(ticks), 1000);
+	ctr->hist[min(fls(min_t(u64, us, U32_MAX)), PERF_HIST_BUCKETS - 1)]++;
+}
+
+void perf_add(enum perf_id id, u64 bytes)
+{
+	struct perf_counter *ctr;
+
+	if (!perf_ready() || id >= PERF_COUNT)
+		return;
+	ctr = &perf_data[id];
+	ctr->ops++;
+	ctr->bytes += bytes;
+}
+
+const char *perf_get_name(enum perf_id id)
+{
+	if (id >= PERF_COUNT)
+		return "invalid";
+
+	return perf_name[id];
+}
+
+int perf_get(enum perf_id id, struct perf_rec *rec)
+{
+	const struct perf_counter *ctr;
+
+	if (id >= PERF_COUNT)
+		return -EINVAL;
+	ctr = &perf_data[id];
+	memset(rec, '\0', sizeof(*rec));
+	strlcpy(rec->name, perf_name[id], sizeof(rec->name));
+	rec->id = id;
+	rec->ops = ctr->ops;
+	rec->bytes = ctr->bytes;
+	rec->time_ns = perf_ticks_to_ns(ctr->ticks);
+	memcpy(rec->hist, ctr->hist, sizeof(rec->hist));
+
+	return 0;
+}
+
+void perf_reset(void)
+{
+	memset(perf_data, '\0', sizeof(perf_data));
+}
+
+static void show_hist(const struct perf_rec *rec)
+{
+	int i;
+
+	printf("%18s", "");
+	for (i = 0; i < PERF_HIST_BUCKETS; i++) {
+		if (!rec->hist[i])
+			continue;
+		if (i == PERF_HIST_BUCKETS - 1)
+			printf(" >=%uus:%u", 1 << (i - 1), rec->hist[i]);
+		else
+			printf(" <%uus:%u", 1 << i, rec->hist[i]);
+	}
+	printf("\n");
+}
+
+void perf_show(bool hist)
+{
+	struct perf_rec rec;
+	int id;
+
+	printf("%-16s %10s %14s %12s %10s\n", "Counter", "Ops", "Bytes",
+	       "Time (us)", "KiB/s");
+	for (id = 0; id < PERF_COUNT; id++) {
+		u64 us;
+
+		perf_get(id, &rec);
+		if (!rec.ops)
+			continue;
+		printf("%-16s %10llu %14llu", rec.name, rec.ops, rec.bytes);
+		us = div_u64(rec.time_ns, 1000);
+		if (us) {
+			printf(" %12llu %10llu\n", us,
+			       div64_u64((rec.bytes * 1000000) >> 10, us));
+		} else {
+			printf("\n");
+		}
+		if (hist && rec.time_ns)
+			show_hist(&rec);
+	}
+}
+
+int perf_stash(void)
+{
+	struct perf_hdr *hdr;
+	struct perf_rec *rec;
+	int count, id, size;
+	int ret;
+
+	if (!CONFIG_IS_ENABLED(BLOBLIST))
+		return -ENOSYS;
+
+	for (id = 0, count = 0; id < PERF_COUNT; id++) {
+		if (perf_data[id].ops)
+			count++;
+	}
+	size = sizeof(*hdr) + count * sizeof(*rec);
+
+	if (bloblist_find(BLOBLISTT_U_BOOT_PERF, 0)) {
+		ret = bloblist_resize(BLOBLISTT_U_BOOT_PERF, size);
+		if (ret)
+			return log_msg_ret("res", -ENOSPC);
+		hdr = bloblist_find(BLOBLISTT_U_BOOT_PERF, size);
+	} else {
+		hdr = bloblist_add(BLOBLISTT_U_BOOT_PERF, size, 0);
+	}
+	if (!hdr)
+		return log_msg_ret("add", -ENOSPC);
+
+	hdr->version = PERF_VERSION;
+	hdr->count = count;
+	hdr->rec_size = sizeof(*rec);
+	hdr->spare = 0;
+	rec = (struct perf_rec *)(hdr + 1);
+	for (id = 0; id < PERF_COUNT; id++) {
+		if (perf_data[id].ops)
+			perf_get(id, rec++);
+	}
+
+	return 0;
+}
+
+#if CONFIG_IS_ENABLED(PERF_BLOBLIST)
+static int perf_stash_spy(void)
+{
+	int ret;
+
+	ret = perf_stash();
+	if (ret)
+		log_warning("Cannot stash performance counters (err=%dE)\n",
+			    ret);
+
+	return 0;
+}
+EVENT_SPY_SIMPLE(EVT_FT_FIXUP, perf_stash_spy);
+#endif
@@ -0,0 +1,195 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Sampling profiler
+ *
+ * This records the call stack at regular intervals, from a timer interrupt.
+ * Unlike function tracing, it does not need the code to be instrumented, so it
+ * has little effect on timing and can be used with normal builds. The samples
+ * can be turned into a flame graph with proftool.
+ */
+
+#include <log.h>
+#include <malloc.h>
+#include <prof.h>
+#include <trace.h>
+#include <linux/errno.h>
+#include <asm/global_data.h>
+#include <asm/sections.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+enum {
+	MAX_DEPTH	= CONFIG_PROFILER_STACK_DEPTH,
+};
+
+/**
+ * struct prof_info - Information about the profiler
+ *
+ * @buf: Buffer holding the samples, each a struct trace_sample
+ * @size: Size of @buf in words
+ * @pos: Next word to write in @buf
+ * @count: Number of samples in @buf
+ * @dropped: Number of samples dropped because @buf was full
+ * @truncated: Number of samples with the stack truncated at MAX_DEPTH
+ * @rate: Number of samples per second
+ * @running: true if sampling is in progress
+ */
+struct prof_info {
+	u32 *buf;
+	ulong size;
+	ulong pos;
+	ulong count;
+	ulong dropped;
+	ulong truncated;
+	uint rate;
+	bool running;
+};
+
+static struct prof_info prof;
+
+/* Get the address that offsets are relative to, matching the trace code */
+static ulong prof_text_base(void)
+{
+	if (IS_ENABLED(CONFIG_SANDBOX))
+		return (ulong)_init;
+	if (gd->flags & GD_FLG_RELOC)
+		return gd->relocaddr;
+
+	return CONFIG_TEXT_BASE;
+}
+
+/* Check whether an address is within U-Boot's code, if we know its size */
+static bool prof_in_text(ulong addr, ulong base)
+{
+	return !gd->mon_len || addr - base < gd->mon_len;
+}
+
+void prof_sample(ulong pc, ulong fp, ulong sp, ulong stack_top)
+{
+	ulong base = prof_text_base();
+	u32 offset[MAX_DEPTH];
+	int depth;
+
+	if (!prof.running)
+		return;
+
+	/*
+	 * Follow the chain of frame records, stopping at anything which does
+	 * not look right, e.g. code built without frame pointers
+	 */
+	offset[0] = prof_in_text(pc, base) ? pc - base : TRACE_SAMPLE_OUTSIDE;
+	for (depth = 1; depth < MAX_DEPTH; depth++) {
+		ulong *frame = (ulong *)fp;
+		ulong ret;
+
+		if (fp < sp || fp + 2 * sizeof(ulong) > stack_top ||
+		    fp & (sizeof(ulong) - 1))
+			break;
+		ret = frame[1];
+		if (!prof_in_text(ret, base))
+			break;
+		offset[depth] = ret - base;
+		sp = fp + 2 * sizeof(ulong);
+		fp = frame[0];
+	}
+	if (depth == MAX_DEPTH)
+		prof.truncated++;
+
+	if (prof.pos + 1 + depth > prof.size) {
+		prof.dropped++;
+		return;
+	}
+	prof.buf[prof.pos] = depth;
+	memcpy(&prof.buf[prof.pos + 1], offset, depth * sizeof(u32));
+	prof.pos += 1 + depth;
+	prof.count++;
+}
+
+int prof_start(uint rate)
+{
+	int ret;
+
+	if (prof.running)
+		return -EALREADY;
+	if (!prof.buf) {
+		prof.buf = malloc(CONFIG_PROFILER_BUF_SIZE);
+		if (!prof.buf)
+			return -ENOMEM;
+		prof.size = CONFIG_PROFILER_BUF_SIZE / sizeof(u32);
+	}
+	prof.rate = rate ?: CONFIG_PROFILER_RATE;
+	prof.running = true;
+	ret = arch_prof_start(prof.rate);
+	if (ret) {
+		prof.running = false;
+		return log_msg_ret("pst", ret);
+	}
+
+	return 0;
+}
+
+void prof_stop(void)
+{
+	if (prof.running) {
+		arch_prof_stop();
+		prof.running = false;
+	}
+}
+
+void prof_wipe(void)
+{
+	bool running = prof.running;
+
+	prof.running = false;
+	prof.pos = 0;
+	prof.count = 0;
+	prof.dropped = 0;
+	prof.truncated = 0;
+	prof.running = running;
+}
+
+int prof_list_samples(void *buff, size_t buff_size, size_t *needed)
+{
+	struct trace_output_hdr *output_hdr = buff;
+	bool running = prof.running;
+	size_t size;
+
+	/* Don't take samples while copying them */
+	prof.running = false;
+	size = sizeof(*output_hdr) + prof.pos * sizeof(u32);
+	*needed = size;
+	if (buff && size <= buff_size) {
+		memset(output_hdr, '\0', sizeof(*output_hdr));
+		output_hdr->type = TRACE_CHUNK_SAMPLES;
+		output_hdr->version = TRACE_VERSION;
+		output_hdr->rec_count = prof.count;
+		output_hdr->text_base = CONFIG_TEXT_BASE;
+		memcpy(output_hdr + 1, prof.buf, prof.pos * sizeof(u32));
+	}
+	prof.running = running;
+	if (size > buff_size)
+		return -ENOSPC;
+
+	return 0;
+}
+
+void prof_print_stats(void)
+{
+	printf("Profiler %s, %u samples/sec\n",
+	       prof.running ? "running" : "stopped",
+	       prof.rate ?: CONFIG_PROFILER_RATE);
+	printf("%15lu samples\n", prof.count);
+	printf("%15lu samples dropped (buffer full)\n", prof.dropped);
+	printf("%15lu stacks truncated\n", prof.truncated);
+	printf("%15lu of %lu bytes used\n", prof.pos * sizeof(u32),
+	       prof.size * sizeof(u32));
+}
+
+__weak int arch_prof_start(uint rate)
+{
+	return -ENOSYS;
+}
+
+__weak void arch_prof_stop(void)
+{
+}
@@ -138,6 +138,19 @@ bool uthread_grp_done(unsigned int grp_id)
 	return true;
 }
 
+void uthread_grp_abandon(unsigned int grp_id)
+{
+	struct uthread *next;
+	struct uthread *tmp;
+
+	list_for_each_entry_safe(next, tmp, &main_thread.list, list) {
+		if (next->grp_id == grp_id && next != current) {
+			list_del(&next->list);
+			uthread_free(next);
+		}
+	}
+}
+
 int uthread_mutex_lock(struct uthread_mutex *mutex)
 {
 	while (mutex->state == UTHREAD_MUTEX_LOCKED)
@@ -8,4 +8,12 @@
    subject to change. Applications should only use zlib.h.
  */
 
+/*
+ * Input and output space that inflate() must have available before calling
+ * inflate_fast(). A refill of the bit buffer loads eight bytes of input at a
+ * time and a match copy may write up to seven bytes past the end of the match.
+ */
+#define INFLATE_FAST_MIN_HAVE   8
+#define INFLATE_FAST_MIN_LEFT   (258 + 7)
+
 void inflate_fast OF((z_streamp strm, unsigned start));
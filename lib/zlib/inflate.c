@@ -736,7 +736,8 @@ __rcode int ZEXPORT inflate(z_streamp strm, int flush)
             fallthrough;
         case LEN:
 	    schedule();
-            if (have >= 6 && left >= 258) {
+            if (have >= INFLATE_FAST_MIN_HAVE &&
+                left >= INFLATE_FAST_MIN_LEFT) {
                 RESTORE();
                 inflate_fast(strm, out);
                 LOAD();
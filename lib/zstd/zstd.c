@@ -11,51 +11,191 @@
 #include <linux/errno.h>
 #include <linux/zstd.h>
 
-int zstd_decompress(struct abuf *in, struct abuf *out)
+/*
+ * Workspaces are kept between calls, since filesystems call zstd_decompress()
+ * for every compressed block
+ */
+static void *zstd_workspace;
+static zstd_dctx *zstd_ctx;
+static void *zstd_stream_workspace;
+
+/**
+ * zstd_get_dctx() - get the decompression context, creating it if needed
+ *
+ * Return: decompression context, or NULL if out of memory
+ */
+static zstd_dctx *zstd_get_dctx(void)
 {
-	zstd_dctx *ctx;
-	size_t wsize, len;
-	void *workspace;
-	int ret;
+	size_t wsize;
+
+	if (zstd_ctx)
+		return zstd_ctx;
 
 	wsize = zstd_dctx_workspace_bound();
-	workspace = malloc(wsize);
-	if (!workspace) {
+	zstd_workspace = malloc(wsize);
+	if (!zstd_workspace) {
 		debug("%s: cannot allocate workspace of size %zu\n", __func__,
-			wsize);
-		return -ENOMEM;
+		      wsize);
+		return NULL;
 	}
-
-	ctx = zstd_init_dctx(workspace, wsize);
-	if (!ctx) {
+	zstd_ctx = zstd_init_dctx(zstd_workspace, wsize);
+	if (!zstd_ctx) {
 		log_err("%s: zstd_init_dctx() failed\n", __func__);
-		ret = -EPERM;
-		goto do_free;
+		free(zstd_workspace);
+		zstd_workspace = NULL;
 	}
 
+	return zstd_ctx;
+}
+
+int zstd_decompress(struct abuf *in, struct abuf *out)
+{
+	size_t pos, len, total;
+	zstd_dctx *ctx;
+
+	ctx = zstd_get_dctx();
+	if (!ctx)
+		return -ENOMEM;
+
 	/*
-	 * Find out how large the frame actually is, there may be junk at
-	 * the end of the frame that zstd_decompress_dctx() can't handle.
+	 * Decompress each frame in turn. Skippable frames produce no output.
+	 * There may be junk after the last frame, which zstd_decompress_dctx()
+	 * can't handle, so find out how large each frame actually is.
 	 */
-	len = zstd_find_frame_compressed_size(abuf_data(in), abuf_size(in));
-	if (zstd_is_error(len)) {
-		log_err("%s: failed to detect compressed size: %d\n", __func__,
-			zstd_get_error_code(len));
-		ret = -EINVAL;
-		goto do_free;
-	}
-
-	len = zstd_decompress_dctx(ctx, abuf_data(out), abuf_size(out),
-				   abuf_data(in), len);
-	if (zstd_is_error(len)) {
-		log_err("%s: failed to decompress: %d\n", __func__,
-			zstd_get_error_code(len));
-		ret = -EINVAL;
-		goto do_free;
-	}
-
-	ret = len;
-do_free:
-	free(workspace);
-	return ret;
+	for (pos = 0, total = 0; pos < abuf_size(in); pos += len) {
+		size_t ret;
+
+		len = zstd_find_frame_compressed_size(abuf_data(in) + pos,
+						      abuf_size(in) - pos);
+		if (zstd_is_error(len)) {
+			if (pos && zstd_get_error_code(len) ==
+			    ZSTD_error_prefix_unknown)
+				break;
+			log_err("%s: failed to detect compressed size: %d\n",
+				__func__, zstd_get_error_code(len));
+			return -EINVAL;
+		}
+
+		ret = zstd_decompress_dctx(ctx, abuf_data(out) + total,
+					   abuf_size(out) - total,
+					   abuf_data(in) + pos, len);
+		if (zstd_is_error(ret)) {
+			log_err("%s: failed to decompress: %d\n", __func__,
+				zstd_get_error_code(ret));
+			return -EINVAL;
+		}
+		total += ret;
+	}
+
+	return total;
+}
+
+void zstd_stream_init(struct zstd_stream *zs, struct abuf *out)
+{
+	zs->dstream = NULL;
+	zs->out.dst = abuf_data(out);
+	zs->out.size = abuf_size(out);
+	zs->out.pos = 0;
+	zs->done = false;
+	zs->trailing = false;
+}
+
+/**
+ * zstd_stream_setup() - set up the decompression context for a stream
+ *
+ * The output buffer does not move while the stream is in progress, so the
+ * decoder writes straight into it and uses it as its window. The workspace
+ * then only needs room for the context and one block of input, whatever the
+ * window size of the frames. It is allocated once and reused by later
+ * streams.
+ *
+ * @zs: Stream state
+ * Return: 0 if OK, -ENOMEM if out of memory, -EPERM if the context could not
+ *	be set up
+ */
+static int zstd_stream_setup(struct zstd_stream *zs)
+{
+	size_t wsize = zstd_dctx_workspace_bound() + ZSTD_BLOCKSIZE_MAX;
+	size_t ret;
+
+	if (!zstd_stream_workspace) {
+		zstd_stream_workspace = malloc(wsize);
+		if (!zstd_stream_workspace) {
+			debug("%s: cannot allocate workspace of size %zu\n",
+			      __func__, wsize);
+			return -ENOMEM;
+		}
+	}
+
+	zs->dstream = zstd_init_dstream(ZSTD_BLOCKSIZE_MAX,
+					zstd_stream_workspace, wsize);
+	if (!zs->dstream) {
+		log_err("%s: zstd_init_dstream() failed\n", __func__);
+		return -EPERM;
+	}
+	ret = ZSTD_DCtx_setParameter(zs->dstream, ZSTD_d_stableOutBuffer, 1);
+	if (zstd_is_error(ret)) {
+		log_err("%s: cannot use a stable output buffer: %d\n",
+			__func__, zstd_get_error_code(ret));
+		zs->dstream = NULL;
+		return -EPERM;
+	}
+
+	return 0;
+}
+
+int zstd_stream_decompress(struct zstd_stream *zs, const void *in,
+			   size_t size)
+{
+	zstd_in_buffer inbuf = { .src = in, .size = size, .pos = 0 };
+	size_t ret, in_pos, out_pos;
+	int err;
+
+	if (zs->trailing)
+		return 0;
+	if (!zs->dstream) {
+		err = zstd_stream_setup(zs);
+		if (err)
+			return err;
+	}
+
+	while (inbuf.pos < inbuf.size) {
+		in_pos = inbuf.pos;
+		out_pos = zs->out.pos;
+		ret = zstd_decompress_stream(zs->dstream, &zs->out, &inbuf);
+		if (zstd_is_error(ret)) {
+			switch (zstd_get_error_code(ret)) {
+			case ZSTD_error_prefix_unknown:
+				/* there may be junk after the last frame */
+				if (!zs->done)
+					break;
+				zs->trailing = true;
+				return 0;
+			case ZSTD_error_dstSize_tooSmall:
+				return -ENOSPC;
+			default:
+				break;
+			}
+			log_err("%s: failed to decompress: %d\n", __func__,
+				zstd_get_error_code(ret));
+			return -EINVAL;
+		}
+
+		/* no progress is only possible if the output is full */
+		if (inbuf.pos == in_pos && zs->out.pos == out_pos)
+			return -ENOSPC;
+
+		/* a frame ending here may be followed by another */
+		zs->done = !ret;
+	}
+
+	return 0;
+}
+
+int zstd_stream_finish(struct zstd_stream *zs)
+{
+	if (!zs->done)
+		return zs->out.pos == zs->out.size ? -ENOSPC : -EINVAL;
+
+	return zs->out.pos;
 }
@@ -16,6 +16,7 @@
 #include <mapmem.h>
 #include <net.h>
 #include <net6.h>
+#include <perf.h>
 #include <asm/global_data.h>
 #include <net/tftp.h>
 #include "bootp.h"
@@ -709,8 +710,10 @@ static void tftp_timeout_handler(void)
 	} else {
 		puts("T ");
 		net_set_timeout_handler(timeout_ms, tftp_timeout_handler);
-		if (tftp_state != STATE_RECV_WRQ)
+		if (tftp_state != STATE_RECV_WRQ) {
+			perf_add(PERF_NET_RETRANSMIT, 0);
 			tftp_send();
+		}
 	}
 }
 
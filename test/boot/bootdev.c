@@ -13,6 +13,7 @@
 #include <env.h>
 #include <mapmem.h>
 #include <os.h>
+#include <uthread.h>
 #include <test/ut.h>
 #include "bootstd_common.h"
 
@@ -496,6 +497,44 @@ static int bootdev_test_hunt_scan(struct unit_test_state *uts)
 }
 BOOTSTD_TEST(bootdev_test_hunt_scan, UTF_DM | UTF_SCAN_FDT);
 
+/* Check searching for bootdevs with the hunters running in the background */
+static int bootdev_test_hunt_bg(struct unit_test_state *uts)
+{
+	struct bootflow_iter iter;
+	struct bootstd_priv *std;
+	struct bootflow bflow;
+
+	bootstd_reset_usb();
+	test_set_eth_enable(false);
+	test_set_skip_delays(true);
+
+	/* get access to the used hunters */
+	ut_assertok(bootstd_get_priv(&std));
+
+	ut_assertok(bootstd_test_drop_bootdev_order(uts));
+	ut_assertok(bootflow_scan_first(NULL, NULL, &iter,
+					BOOTFLOWIF_HUNT | BOOTFLOWIF_HUNT_BG |
+					BOOTFLOWIF_SKIP_GLOBAL, &bflow));
+
+	/* the hunters needed for the first bootflow have finished */
+	ut_asserteq(BIT(MMC_HUNTER) | BIT(1),
+		    std->hunters_used & (BIT(MMC_HUNTER) | BIT(1)));
+
+	/* all the others have been started, or have finished already */
+	ut_asserteq(GENMASK(MAX_HUNTER, 0),
+		    std->hunters_used | std->hunters_busy);
+	ut_assert(std->hunt_grp);
+	bootflow_iter_uninit(&iter);
+
+	/* waiting for them leaves nothing running */
+	bootdev_hunt_join(std);
+	ut_asserteq(0, std->hunters_busy);
+	ut_asserteq(GENMASK(MAX_HUNTER, 0), std->hunters_used);
+
+	return 0;
+}
+BOOTSTD_TEST(bootdev_test_hunt_bg, UTF_DM | UTF_SCAN_FDT | UTF_ETH_BOOTDEV);
+
 /* Check that only bootable partitions are processed */
 static int bootdev_test_bootable(struct unit_test_state *uts)
 {
@@ -557,6 +596,81 @@ static int bootdev_test_hunt_prio(struct unit_test_state *uts)
 }
 BOOTSTD_TEST(bootdev_test_hunt_prio, UTF_DM | UTF_SCAN_FDT | UTF_CONSOLE);
 
+/* Check running hunters in the background */
+static int bootdev_test_hunt_start(struct unit_test_state *uts)
+{
+	struct bootstd_priv *std;
+
+	bootstd_reset_usb();
+	test_set_skip_delays(true);
+
+	/* get access to the used hunters */
+	ut_assertok(bootstd_get_priv(&std));
+
+	/* ethernet, ide and usb are queued but have not run yet */
+	ut_assertok(bootdev_hunt_start(BOOTDEVP_5_SCAN_SLOW));
+	ut_asserteq(0, std->hunters_used);
+	ut_asserteq(BIT(0) | BIT(2) | BIT(8), std->hunters_busy);
+
+	/* starting again should not queue anything twice */
+	ut_assertok(bootdev_hunt_start(BOOTDEVP_5_SCAN_SLOW));
+	ut_asserteq(BIT(0) | BIT(2) | BIT(8), std->hunters_busy);
+
+	/* hunting a priority waits for the hunters running in the background */
+	ut_assertok(bootdev_hunt_prio(BOOTDEVP_5_SCAN_SLOW, false));
+	ut_asserteq(BIT(2) | BIT(8), std->hunters_used & (BIT(2) | BIT(8)));
+	ut_assert_skip_to_line("Bus usb@1: 5 USB Device(s) found");
+
+	ut_assertok(bootdev_hunt_prio(BOOTDEVP_6_NET_BASE, false));
+	ut_asserteq(BIT(0) | BIT(2) | BIT(8), std->hunters_used);
+	ut_asserteq(0, std->hunters_busy);
+
+	return 0;
+}
+BOOTSTD_TEST(bootdev_test_hunt_start, UTF_DM | UTF_SCAN_FDT | UTF_CONSOLE);
+
+/* Check abandoning the hunters running in the background */
+static int bootdev_test_hunt_abandon(struct unit_test_state *uts)
+{
+	struct bootflow_iter iter;
+	struct bootstd_priv *std;
+	struct bootflow bflow;
+	struct udevice *dev;
+	uint grp;
+
+	bootstd_reset_usb();
+	test_set_skip_delays(true);
+
+	/* get access to the used hunters */
+	ut_assertok(bootstd_get_priv(&std));
+
+	/* queue all the hunters, then abandon them before they run */
+	ut_assertok(bootdev_hunt_start(BOOTDEVP_1_PRE_SCAN));
+	ut_asserteq(GENMASK(MAX_HUNTER, 0), std->hunters_busy);
+	grp = std->hunt_grp;
+	bootdev_hunt_abandon(std);
+	ut_assert(uthread_grp_done(grp));
+	ut_asserteq(0, std->hunt_grp);
+	ut_asserteq(0, std->hunters_busy);
+	ut_asserteq(0, std->hunters_used);
+	ut_asserteq(GENMASK(MAX_HUNTER, 0), std->hunters_abandoned);
+
+	/* abandoned hunters are not run again */
+	ut_assertok(bootdev_hunt_prio(BOOTDEVP_5_SCAN_SLOW, true));
+	ut_assertok(bootdev_hunt_start(BOOTDEVP_1_PRE_SCAN));
+	ut_asserteq(0, std->hunters_used | std->hunters_busy);
+	ut_assert_console_end();
+
+	/* nor are the bootdevs they cover */
+	ut_assertok(uclass_get_device_by_name(UCLASS_BOOTDEV, "mmc1.bootdev",
+					      &dev));
+	memset(&iter, '\0', sizeof(iter));
+	ut_asserteq(-ESHUTDOWN, bootdev_get_bootflow(dev, &iter, &bflow));
+
+	return 0;
+}
+BOOTSTD_TEST(bootdev_test_hunt_abandon, UTF_DM | UTF_SCAN_FDT | UTF_CONSOLE);
+
 /* Check hunting for bootdevs with a particular label */
 static int bootdev_test_hunt_label(struct unit_test_state *uts)
 {
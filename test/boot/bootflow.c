@@ -15,13 +15,16 @@
 #include <efi.h>
 #include <efi_loader.h>
 #include <env.h>
+#include <event.h>
 #include <expo.h>
 #include <mapmem.h>
+#include <of_live.h>
 #ifdef CONFIG_SANDBOX
 #include <asm/test.h>
 #endif
 #include <dm/device-internal.h>
 #include <dm/lists.h>
+#include <linux/libfdt.h>
 #include <test/ut.h>
 #include "bootstd_common.h"
 #include "../../boot/bootflow_internal.h"
@@ -270,6 +273,8 @@ BOOTSTD_TEST(bootflow_cmd_info, UTF_DM | UTF_SCAN_FDT | UTF_CONSOLE);
 /* Check 'bootflow scan -b' to boot the first available bootdev */
 static int bootflow_scan_boot(struct unit_test_state *uts)
 {
+	/* don't go to a bootflow recorded by an earlier test */
+	ut_assertok(env_set(BOOTFLOW_CACHE_VAR, NULL));
 	ut_assertok(inject_response(uts));
 	ut_assertok(run_command("bootflow scan -b", 0));
 	ut_assert_nextline(
@@ -288,6 +293,157 @@ static int bootflow_scan_boot(struct unit_test_state *uts)
 }
 BOOTSTD_TEST(bootflow_scan_boot, UTF_DM | UTF_SCAN_FDT | UTF_CONSOLE);
 
+/* Check recording a bootflow and going straight back to it */
+static int bootflow_cache(struct unit_test_state *uts)
+{
+	struct event_ft_fixup fixup;
+	struct bootflow_iter iter;
+	struct bootflow bflow;
+	char fdt_buf[1024];
+	struct device_node *np;
+	const char *prop;
+	char *saved;
+
+	ut_assertok(env_set(BOOTFLOW_CACHE_VAR, NULL));
+	ut_asserteq(-ENOENT, bootflow_cache_find(&iter, 0, &bflow));
+
+	ut_assertok(bootflow_scan_first(NULL, "mmc1", &iter, 0, &bflow));
+	ut_asserteq_str("mmc1.bootdev.part_1", bflow.name);
+	ut_assertok(bootflow_cache_set(&bflow));
+	bootflow_free(&bflow);
+	bootflow_iter_uninit(&iter);
+
+	/* the record is only held in memory */
+	ut_assertnull(env_get(BOOTFLOW_CACHE_VAR));
+	ut_assertnonnull(bootflow_cache_get());
+	saved = strdup(bootflow_cache_get());
+	ut_assertnonnull(saved);
+	ut_asserteq_strn("mmc1.bootdev:1 extlinux /extlinux/extlinux.conf ",
+			 saved);
+
+	/* it is passed to the OS in /chosen, which is created if needed */
+	ut_assertok(fdt_create_empty_tree(fdt_buf, sizeof(fdt_buf)));
+	if (of_live_active()) {
+		ut_assertok(unflatten_device_tree(fdt_buf, &np));
+		fixup.tree = oftree_from_np(np);
+	} else {
+		fixup.tree = oftree_from_fdt(fdt_buf);
+	}
+	fixup.images = NULL;
+	ut_assertok(event_notify(EVT_FT_FIXUP, &fixup, sizeof(fixup)));
+	prop = ofnode_read_string(oftree_path(fixup.tree, "/chosen"),
+				  BOOTFLOW_CACHE_PROP);
+	ut_assertnonnull(prop);
+	ut_asserteq_str(saved, prop);
+
+	/* the OS confirms that the boot worked */
+	ut_assertok(env_set(BOOTFLOW_CACHE_VAR, saved));
+	ut_assertok(bootflow_cache_find(&iter, 0, &bflow));
+	ut_asserteq_str("mmc1.bootdev.part_1", bflow.name);
+	ut_asserteq_str("extlinux", bflow.method->name);
+	ut_asserteq(1, iter.part);
+	ut_asserteq(1, iter.num_methods);
+	bootflow_free(&bflow);
+	bootflow_iter_uninit(&iter);
+
+	/* a different partition UUID means that the media has changed */
+	ut_assertok(env_set(BOOTFLOW_CACHE_VAR,
+			    "mmc1.bootdev:1 extlinux /extlinux/extlinux.conf "
+			    "01234567-89ab-cdef-0123-456789abcdef"));
+	ut_asserteq(-ESTALE, bootflow_cache_find(&iter, 0, &bflow));
+
+	/* likewise a different file */
+	ut_assertok(env_set(BOOTFLOW_CACHE_VAR,
+			    "mmc1.bootdev:1 extlinux /boot/extlinux.conf -"));
+	ut_asserteq(-ESTALE, bootflow_cache_find(&iter, 0, &bflow));
+
+	/* a bootdev which is not there */
+	ut_assertok(env_set(BOOTFLOW_CACHE_VAR,
+			    "mmc9.bootdev:1 extlinux /extlinux/extlinux.conf -"));
+	ut_asserteq(-ESTALE, bootflow_cache_find(&iter, 0, &bflow));
+
+	/* and a bootmeth which is not there */
+	ut_assertok(env_set(BOOTFLOW_CACHE_VAR,
+			    "mmc1.bootdev:1 fred /extlinux/extlinux.conf -"));
+	ut_asserteq(-ESTALE, bootflow_cache_find(&iter, 0, &bflow));
+
+	/* the original record still works */
+	ut_assertok(env_set(BOOTFLOW_CACHE_VAR, saved));
+	free(saved);
+	ut_assertok(bootflow_cache_find(&iter, 0, &bflow));
+	bootflow_free(&bflow);
+	bootflow_iter_uninit(&iter);
+	ut_assertok(env_set(BOOTFLOW_CACHE_VAR, NULL));
+
+	ut_assertok(bootflow_cache_set(NULL));
+	ut_assertnull(bootflow_cache_get());
+
+	return 0;
+}
+BOOTSTD_TEST(bootflow_cache, UTF_DM | UTF_SCAN_FDT);
+
+/* Check that 'bootflow scan -b' goes straight back to the recorded bootflow */
+static int bootflow_cache_cmd(struct unit_test_state *uts)
+{
+	struct bootflow_iter iter;
+	struct bootflow bflow;
+	char *saved;
+
+	if (!IS_ENABLED(CONFIG_BOOTFLOW_CACHE))
+		return -EAGAIN;
+
+	ut_assertok(env_set(BOOTFLOW_CACHE_VAR, NULL));
+	ut_assertok(inject_response(uts));
+	ut_assertok(run_command("bootflow scan -b", 0));
+	ut_assert_nextline(
+		"** Booting bootflow 'mmc1.bootdev.part_1' with extlinux");
+	ut_assert_skip_to_line("Boot failed (err=-14)");
+	ut_assert_console_end();
+
+	/* nothing is written to the environment and the boot failed */
+	ut_assertnull(env_get(BOOTFLOW_CACHE_VAR));
+	ut_assertnull(bootflow_cache_get());
+
+	/* record the bootflow as the OS would after a successful boot */
+	ut_assertok(bootflow_scan_first(NULL, "mmc1", &iter, 0, &bflow));
+	ut_assertok(bootflow_cache_set(&bflow));
+	bootflow_free(&bflow);
+	bootflow_iter_uninit(&iter);
+	saved = strdup(bootflow_cache_get());
+	ut_assertnonnull(saved);
+	ut_assertok(bootflow_cache_set(NULL));
+	ut_assertok(env_set(BOOTFLOW_CACHE_VAR, saved));
+	free(saved);
+
+	/*
+	 * The recorded bootflow is booted first. When that fails, the normal
+	 * scan does not boot it a second time.
+	 */
+	ut_assertok(inject_response(uts));
+	ut_assertok(run_command("bootflow scan -b", 0));
+	ut_assert_nextline(
+		"** Booting bootflow 'mmc1.bootdev.part_1' with extlinux");
+	ut_assert_skip_to_line("Boot failed (err=-14)");
+	ut_assert_console_end();
+
+	/* a stale record is ignored and the normal scan boots mmc1 */
+	ut_assertok(env_set(BOOTFLOW_CACHE_VAR,
+			    "mmc9.bootdev:1 extlinux /extlinux/extlinux.conf -"));
+	ut_assertok(inject_response(uts));
+	ut_assertok(run_command("bootflow scan -bH", 0));
+	ut_assert_nextline(
+		"** Booting bootflow 'mmc1.bootdev.part_1' with extlinux");
+	ut_assert_skip_to_line("Boot failed (err=-14)");
+	ut_assert_console_end();
+	ut_asserteq_str("mmc9.bootdev:1 extlinux /extlinux/extlinux.conf -",
+			env_get(BOOTFLOW_CACHE_VAR));
+
+	ut_assertok(env_set(BOOTFLOW_CACHE_VAR, NULL));
+
+	return 0;
+}
+BOOTSTD_TEST(bootflow_cache_cmd, UTF_DM | UTF_SCAN_FDT | UTF_CONSOLE);
+
 /* Check iterating through available bootflows */
 static int bootflow_iter(struct unit_test_state *uts)
 {
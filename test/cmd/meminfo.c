@@ -17,6 +17,15 @@ static int cmd_test_meminfo(struct unit_test_state *uts)
 	ut_assert_nextline("DRAM:  256 MiB");
 	ut_assert_nextline_empty();
 
+	if (IS_ENABLED(CONFIG_SYS_MALLOC_SLAB)) {
+		ut_assert_nextline("Pool               Size  Pages  Objects   In use     Allocs");
+		ut_assert_nextlinen("-");
+
+		/* the pools in use depend on what has run so far */
+		ut_assert_skip_to_linen("Slab pages use");
+		ut_assert_nextline_empty();
+	}
+
 	ut_assert_nextline("Region           Base     Size      End      Gap");
 	ut_assert_nextlinen("-");
 
@@ -0,0 +1,110 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Test for performance counters and the 'perf' command
+ */
+
+#include <bloblist.h>
+#include <fs.h>
+#include <malloc.h>
+#include <perf.h>
+#include <test/cmd.h>
+#include <test/ut.h>
+#include <linux/errno.h>
+
+/* Test updating and reading counters */
+static int cmd_test_perf_counters(struct unit_test_state *uts)
+{
+	struct perf_rec rec, old;
+	u64 start;
+	void *ptr;
+	int i, total;
+
+	perf_reset();
+	perf_add(PERF_BLK_READ, 512);
+	perf_add(PERF_BLK_READ, 1024);
+	ut_assertok(perf_get(PERF_BLK_READ, &rec));
+	ut_asserteq_str("blk.read", rec.name);
+	ut_asserteq(PERF_BLK_READ, rec.id);
+	ut_asserteq(2, rec.ops);
+	ut_asserteq(1536, rec.bytes);
+	ut_asserteq(0, rec.time_ns);
+
+	/* A timed operation should land in exactly one histogram bucket */
+	start = perf_begin();
+	ut_assert(start);
+	perf_end(PERF_HASH, start, 4096);
+	ut_assertok(perf_get(PERF_HASH, &rec));
+	ut_asserteq(1, rec.ops);
+	ut_asserteq(4096, rec.bytes);
+	for (i = 0, total = 0; i < PERF_HIST_BUCKETS; i++)
+		total += rec.hist[i];
+	ut_asserteq(1, total);
+
+	/* Filesystems each have their own counter */
+	ut_asserteq_str("fs.fat", perf_get_name(PERF_FS_READ + FS_TYPE_FAT));
+	ut_asserteq_str("fs.exfat",
+			perf_get_name(PERF_FS_READ + FS_TYPE_EXFAT));
+	ut_asserteq(-EINVAL, perf_get(PERF_COUNT, &rec));
+
+	/* Check the heap hooks */
+	ut_assertok(perf_get(PERF_MALLOC, &old));
+	ptr = malloc(100);
+	ut_assertnonnull(ptr);
+	ut_assertok(perf_get(PERF_MALLOC, &rec));
+	ut_asserteq(old.ops + 1, rec.ops);
+	ut_asserteq(old.bytes + 100, rec.bytes);
+	ut_assertok(perf_get(PERF_FREE, &old));
+	free(ptr);
+	ut_assertok(perf_get(PERF_FREE, &rec));
+	ut_asserteq(old.ops + 1, rec.ops);
+
+	perf_reset();
+	ut_assertok(perf_get(PERF_BLK_READ, &rec));
+	ut_asserteq(0, rec.ops);
+
+	return 0;
+}
+CMD_TEST(cmd_test_perf_counters, 0);
+
+/* Test the 'perf' command */
+static int cmd_test_perf(struct unit_test_state *uts)
+{
+	struct perf_rec *rec, val;
+	struct perf_hdr *hdr;
+
+	perf_reset();
+	perf_add(PERF_BLK_READ, 512);
+	perf_add(PERF_BLK_READ, 1024);
+	perf_add(PERF_NET_TX, 60);
+	perf_end(PERF_HASH, perf_begin(), 4096);
+
+	ut_assertok(run_command("perf show", 0));
+	ut_assert_nextline("Counter                 Ops          Bytes    Time (us)      KiB/s");
+	ut_assert_nextline("blk.read                  2           1536");
+	ut_assert_nextline("net.tx                    1             60");
+	ut_assert_nextlinen("hash                      1           4096");
+
+	/* Heap counters may follow, since the command itself uses the heap */
+	console_record_reset();
+
+	ut_assertok(run_command("perf stash", 0));
+	hdr = bloblist_find(BLOBLISTT_U_BOOT_PERF, 0);
+	ut_assertnonnull(hdr);
+	ut_asserteq(PERF_VERSION, hdr->version);
+	ut_asserteq(sizeof(struct perf_rec), hdr->rec_size);
+	ut_assert(hdr->count >= 3);
+	rec = (struct perf_rec *)(hdr + 1);
+	ut_asserteq_str("blk.read", rec[0].name);
+	ut_asserteq(2, rec[0].ops);
+	ut_asserteq_str("net.tx", rec[1].name);
+	ut_asserteq(60, rec[1].bytes);
+	ut_asserteq_str("hash", rec[2].name);
+
+	ut_assertok(run_command("perf reset", 0));
+	ut_assertok(perf_get(PERF_BLK_READ, &val));
+	ut_asserteq(0, val.ops);
+	ut_assert_console_end();
+
+	return 0;
+}
+CMD_TEST(cmd_test_perf, UTF_CONSOLE);
@@ -0,0 +1,106 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Test for the slab front-end of malloc()
+ */
+
+#include <malloc.h>
+#include <slab.h>
+#include <test/common.h>
+#include <test/test.h>
+#include <test/ut.h>
+
+struct slab_test_obj {
+	char name[40];
+	ulong val;
+};
+
+static SLAB_POOL(test_pool, struct slab_test_obj);
+
+/* Test that small allocations come from the slab and larger ones do not */
+static int common_test_slab_malloc(struct unit_test_state *uts)
+{
+	void *small, *large, *ptr;
+	ulong start;
+
+	start = ut_check_free();
+	small = malloc(20);
+	ut_assertnonnull(small);
+	ut_assert(slab_owns(small));
+	ut_asserteq(32, malloc_usable_size(small));
+	ut_asserteq(32, ut_check_delta(start));
+
+	large = malloc(SLAB_MAX_SIZE + 1);
+	ut_assertnonnull(large);
+	ut_assert(!slab_owns(large));
+
+	/* growing within the object keeps it in place */
+	memset(small, 0xaa, 20);
+	ut_asserteq_ptr(small, realloc(small, 30));
+
+	/* growing beyond it moves it, keeping the contents */
+	ptr = realloc(small, 200);
+	ut_assertnonnull(ptr);
+	ut_assert(slab_owns(ptr));
+	ut_asserteq(0xaa, *(u8 *)(ptr + 19));
+	small = realloc(ptr, 1000);
+	ut_assertnonnull(small);
+	ut_assert(!slab_owns(small));
+	ut_asserteq(0xaa, *(u8 *)(small + 19));
+
+	free(small);
+	free(large);
+	ut_assertok(ut_check_delta(start));
+
+	/* calloc() must clear a reused object */
+	ptr = malloc(64);
+	memset(ptr, 0xff, 64);
+	free(ptr);
+	ptr = calloc(8, 8);
+	ut_assert(slab_owns(ptr));
+	ut_asserteq(0, *(ulong *)ptr);
+	free(ptr);
+	ut_assertok(ut_check_delta(start));
+
+	return 0;
+}
+COMMON_TEST(common_test_slab_malloc, 0);
+
+/* Test a typed pool, filling more than one page */
+static int common_test_slab_pool(struct unit_test_state *uts)
+{
+	struct slab_test_obj *obj[200];
+	ulong start;
+	int i;
+
+	start = ut_check_free();
+	for (i = 0; i < ARRAY_SIZE(obj); i++) {
+		obj[i] = slab_pool_alloc(&test_pool);
+		ut_assertnonnull(obj[i]);
+		ut_assert(slab_owns(obj[i]));
+		ut_asserteq(0, obj[i]->val);
+		obj[i]->val = i;
+	}
+	ut_asserteq(ARRAY_SIZE(obj), test_pool.inuse);
+	ut_assert(test_pool.pages > 1);
+	for (i = 0; i < ARRAY_SIZE(obj); i++)
+		ut_asserteq(i, obj[i]->val);
+
+	/* objects are freed with free(), leaving one empty page */
+	for (i = 0; i < ARRAY_SIZE(obj); i++)
+		free(obj[i]);
+	ut_asserteq(0, test_pool.inuse);
+	ut_asserteq(1, test_pool.pages);
+	ut_assertok(ut_check_delta(start));
+
+	/* the pool shows in the statistics */
+	obj[0] = slab_pool_alloc(&test_pool);
+	slab_show_stats();
+	ut_assert_nextlinen("Pool");
+	ut_assert_skip_to_linen("struct slab_test_obj");
+	ut_assert_skip_to_linen("Slab pages use");
+	ut_assert_console_end();
+	free(obj[0]);
+
+	return 0;
+}
+COMMON_TEST(common_test_slab_pool, UTF_CONSOLE);
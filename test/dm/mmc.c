@@ -3,7 +3,10 @@
  * Copyright (C) 2015 Google, Inc
  */
 
+#include <blk.h>
 #include <dm.h>
+#include <gzip.h>
+#include <malloc.h>
 #include <mmc.h>
 #include <part.h>
 #include <dm/test.h>
@@ -51,3 +54,124 @@ static int dm_test_mmc_blk(struct unit_test_state *uts)
 	return 0;
 }
 DM_TEST(dm_test_mmc_blk, UTF_SCAN_PDATA | UTF_SCAN_FDT);
+
+#if IS_ENABLED(CONFIG_CMD_UNZIP)
+/* Number of blocks in each gzwrite() write buffer, and number of buffers */
+#define GZW_BLKS	4
+#define GZW_BUFS	8
+
+/**
+ * check_gzwrite() - write a gzipped image and read it back
+ *
+ * @uts: Test state
+ * @dev_desc: Block device to write to
+ * @gz: Compressed image
+ * @gz_len: Length of compressed image
+ * @zeros: How gzwrite() should handle zero buffers
+ * @buf: Returns the data read back, GZW_BUFS * GZW_BLKS blocks
+ * Return: 0 if OK, -ve on error
+ */
+static int check_gzwrite(struct unit_test_state *uts,
+			 struct blk_desc *dev_desc, void *gz, ulong gz_len,
+			 enum gzwrite_zeros zeros, char *buf)
+{
+	int size = GZW_BUFS * GZW_BLKS * 512;
+
+	/* fill the device with something other than zero first */
+	memset(buf, 0xaa, size);
+	ut_asserteq(GZW_BUFS * GZW_BLKS,
+		    blk_dwrite(dev_desc, 0, GZW_BUFS * GZW_BLKS, buf));
+	ut_assertok(gzwrite(gz, gz_len, dev_desc, GZW_BLKS * 512, 0, size,
+			    zeros));
+	ut_asserteq(GZW_BUFS * GZW_BLKS,
+		    blk_dread(dev_desc, 0, GZW_BUFS * GZW_BLKS, buf));
+
+	return 0;
+}
+
+/* Check whether write buffer @n is all zero in the test image */
+static bool gzw_zero_buf(int n)
+{
+	return (n >= 1 && n <= 4) || n == 6;
+}
+
+/* Test skipping and erasing zero buffers when writing a gzipped image */
+static int dm_test_mmc_gzwrite(struct unit_test_state *uts)
+{
+	int bufsize = GZW_BLKS * 512, size = GZW_BUFS * bufsize;
+	struct blk_desc *dev_desc;
+	char *data, *read, *gz;
+	ulong gz_len = size;
+	struct mmc *mmc;
+	uint grp_size;
+	bool can_trim;
+	int i;
+
+	ut_assertok(blk_get_device_by_str("mmc", "0", &dev_desc));
+	ut_asserteq(512, dev_desc->blksz);
+
+	/* buffers 1-4 and 6 are zero, including the last one but one */
+	data = calloc(1, size);
+	ut_assertnonnull(data);
+	for (i = 0; i < size; i++) {
+		int n = i / bufsize;
+
+		if (!gzw_zero_buf(n))
+			data[i] = i * 7 + n;
+	}
+	read = malloc(size);
+	ut_assertnonnull(read);
+	gz = malloc(gz_len);
+	ut_assertnonnull(gz);
+	ut_assertok(gzip(gz, &gz_len, (uchar *)data, size));
+
+	ut_assertok(check_gzwrite(uts, dev_desc, gz, gz_len,
+				  GZWRITE_ZEROS_WRITE, read));
+	ut_asserteq_mem(data, read, size);
+
+	/* erased blocks read as zero on sandbox */
+	ut_assertok(check_gzwrite(uts, dev_desc, gz, gz_len,
+				  GZWRITE_ZEROS_ERASE, read));
+	ut_asserteq_mem(data, read, size);
+
+	/*
+	 * With erase groups of two buffers, only blocks 8-15 can be erased.
+	 * Erasing any other blocks would also erase their neighbours, which
+	 * the MMC layer warns about.
+	 */
+	mmc = find_mmc_device(dev_desc->devnum);
+	ut_assertnonnull(mmc);
+	grp_size = mmc->erase_grp_size;
+	can_trim = mmc->can_trim;
+	mmc->erase_grp_size = 2 * GZW_BLKS;
+	mmc->can_trim = false;
+	i = check_gzwrite(uts, dev_desc, gz, gz_len, GZWRITE_ZEROS_ERASE,
+			  read);
+	mmc->erase_grp_size = grp_size;
+	mmc->can_trim = can_trim;
+	ut_assertok(i);
+	ut_asserteq(-ENOENT, ut_check_skip_to_line(uts,
+			"Caution! Your devices Erase group is 0x%x",
+			2 * GZW_BLKS));
+	ut_asserteq_mem(data, read, size);
+
+	/* skipped blocks keep their previous contents */
+	ut_assertok(check_gzwrite(uts, dev_desc, gz, gz_len,
+				  GZWRITE_ZEROS_SKIP, read));
+	for (i = 0; i < GZW_BUFS; i++) {
+		int pos = i * bufsize;
+
+		if (gzw_zero_buf(i))
+			ut_assertnull(memchr_inv(read + pos, 0xaa, bufsize));
+		else
+			ut_asserteq_mem(data + pos, read + pos, bufsize);
+	}
+
+	free(gz);
+	free(read);
+	free(data);
+
+	return 0;
+}
+DM_TEST(dm_test_mmc_gzwrite, UTF_SCAN_PDATA | UTF_SCAN_FDT | UTF_CONSOLE);
+#endif
@@ -3,15 +3,23 @@
  * Copyright (C) 2023 Sean Anderson <seanga2@gmail.com>
  */
 
+#include <bloblist.h>
+#include <dm.h>
+#include <malloc.h>
+#include <mapmem.h>
 #include <nand.h>
 #include <part.h>
 #include <rand.h>
+#include <asm/global_data.h>
+#include <dm/device-internal.h>
 #include <dm/test.h>
 #include <test/test.h>
 #include <test/ut.h>
 #include <linux/mtd/mtd.h>
 #include <linux/mtd/rawnand.h>
 
+DECLARE_GLOBAL_DATA_PTR;
+
 static int run_test_nand(struct unit_test_state *uts, int dev, bool end)
 {
 	nand_erase_options_t opts = { };
@@ -119,3 +127,217 @@ static int dm_test_nand1_end(struct unit_test_state *uts)
 	return 0;
 }
 DM_TEST(dm_test_nand1_end, UTF_SCAN_FDT);
+
+static int dm_test_nand_cache_read(struct unit_test_state *uts)
+{
+	nand_erase_options_t opts = { };
+	struct nand_chip *chip;
+	struct mtd_info *mtd;
+	size_t length, retlen;
+	loff_t off;
+	int *gold, i, ret;
+	u_char *buf;
+
+	srand(1);
+
+	mtd = get_nand_dev_by_index(1);
+	ut_assertnonnull(mtd);
+	chip = mtd_to_nand(mtd);
+
+	/* This chip advertises READ CACHE, so runs of pages use it */
+	ut_assert(chip->options & NAND_CMDFUNC_CACHE_READ);
+	ut_assert(le16_to_cpu(chip->onfi_params.opt_cmd) &
+		  ONFI_OPT_CMD_READ_CACHE);
+
+	length = mtd->erasesize * 2;
+	buf = malloc(length);
+	ut_assertnonnull(buf);
+	gold = malloc(length);
+	ut_assertnonnull(gold);
+
+	opts.offset = mtd->erasesize * 8;
+	opts.length = length;
+	ut_assertok(nand_erase_opts(mtd, &opts));
+
+	for (i = 0; i < length / sizeof(int); i++)
+		gold[i] = rand();
+	ut_assertok(mtd_write(mtd, opts.offset, length, &retlen,
+			      (u_char *)gold));
+	ut_asserteq(length, retlen);
+
+	/* Both blocks in one go; injected bitflips are corrected */
+	ret = mtd_read(mtd, opts.offset, length, &retlen, buf);
+	ut_assert(!ret || ret == -EUCLEAN);
+	ut_asserteq(length, retlen);
+	ut_asserteq_mem(gold, buf, length);
+	ut_assert(!chip->cont_read.ongoing);
+
+	/* Unaligned start and end, crossing the eraseblock boundary */
+	off = mtd->erasesize - 3 * mtd->writesize + 100;
+	length = 5 * mtd->writesize;
+	memset(buf, '\0', length);
+	ret = mtd_read(mtd, opts.offset + off, length, &retlen, buf);
+	ut_assert(!ret || ret == -EUCLEAN);
+	ut_asserteq(length, retlen);
+	ut_asserteq_mem((u_char *)gold + off, buf, length);
+	ut_assert(!chip->cont_read.ongoing);
+
+	/* Exactly two pages */
+	length = 2 * mtd->writesize;
+	memset(buf, '\0', length);
+	ret = mtd_read(mtd, opts.offset, length, &retlen, buf);
+	ut_assert(!ret || ret == -EUCLEAN);
+	ut_asserteq(length, retlen);
+	ut_asserteq_mem(gold, buf, length);
+
+	free(gold);
+	free(buf);
+
+	return 0;
+}
+DM_TEST(dm_test_nand_cache_read, UTF_SCAN_FDT);
+
+static int dm_test_nand_bbt_handoff(struct unit_test_state *uts)
+{
+	struct nand_bbt_handoff *ho;
+	struct nand_chip *chip;
+	struct mtd_info *mtd;
+	struct udevice *dev;
+	int len, size;
+	void *blob;
+
+	ut_assertok(uclass_get_device_by_driver(UCLASS_MTD,
+						DM_DRIVER_GET(sand_nand), &dev));
+	mtd = get_nand_dev_by_index(0);
+	ut_assertnonnull(mtd);
+	chip = mtd_to_nand(mtd);
+	ut_asserteq(0, mtd_block_isbad(mtd, 5 * mtd->erasesize));
+	ut_asserteq(0, mtd_block_isbad(mtd, 6 * mtd->erasesize));
+
+	/* Use a scratch bloblist, which is dropped when the test finishes */
+	len = mtd->size >> (chip->bbt_erase_shift + 2);
+	size = sizeof(struct bloblist_hdr) + sizeof(struct bloblist_rec) +
+		sizeof(*ho) + len + BLOBLIST_BLOB_ALIGN;
+	blob = memalign(BLOBLIST_ALIGN, size);
+	ut_assertnonnull(blob);
+	ut_assertok(bloblist_new(map_to_sysmem(blob), size, 0, 0));
+
+	/* Pretend that an earlier phase found block 5 to be bad */
+	ut_assertok(bloblist_ensure_size(BLOBLISTT_U_BOOT_NAND_BBT,
+					 sizeof(*ho) + len, 0, (void **)&ho));
+	ho->gen = 1;
+	ho->erase_shift = chip->bbt_erase_shift;
+	ho->size = mtd->size;
+	ho->id_len = chip->id.len;
+	memcpy(ho->id, chip->id.data, sizeof(ho->id));
+	memcpy(ho->bbt, chip->bbt, len);
+	ho->bbt[5 / 4] |= 1 << (5 % 4 * 2);
+
+	/* The chip is not scanned again, so the table is used as is */
+	ut_assertok(device_remove(dev, DM_REMOVE_NORMAL));
+	ut_assertok(device_probe(dev));
+	mtd = get_nand_dev_by_index(0);
+	ut_assertnonnull(mtd);
+	ut_asserteq(1, mtd_block_isbad(mtd, 5 * mtd->erasesize));
+	ut_asserteq(0, mtd_block_isbad(mtd, 6 * mtd->erasesize));
+
+	/* Blocks marked bad later end up in the table with a new generation */
+	ut_assertok(mtd_block_markbad(mtd, 6 * mtd->erasesize));
+	ut_asserteq(2, ho->gen);
+	ut_asserteq(1 << (6 % 4 * 2), ho->bbt[6 / 4] & (3 << (6 % 4 * 2)));
+
+	/* An incomplete table is ignored */
+	ho->gen = 0;
+	ut_assertok(device_remove(dev, DM_REMOVE_NORMAL));
+	ut_assertok(device_probe(dev));
+	mtd = get_nand_dev_by_index(0);
+	ut_assertnonnull(mtd);
+	ut_asserteq(0, mtd_block_isbad(mtd, 5 * mtd->erasesize));
+
+	/*
+	 * Drop the handoff and probe again, so that the table is rebuilt from
+	 * a fresh chip without the bad blocks added above
+	 */
+	gd_set_bloblist(NULL);
+	free(blob);
+	ut_assertok(device_remove(dev, DM_REMOVE_NORMAL));
+	ut_assertok(device_probe(dev));
+	mtd = get_nand_dev_by_index(0);
+	ut_assertnonnull(mtd);
+	ut_asserteq(0, mtd_block_isbad(mtd, 5 * mtd->erasesize));
+	ut_asserteq(0, mtd_block_isbad(mtd, 6 * mtd->erasesize));
+
+	return 0;
+}
+DM_TEST(dm_test_nand_bbt_handoff, UTF_SCAN_FDT | UFT_BLOBLIST);
+
+static int dm_test_nand_cache_read_pagebuf(struct unit_test_state *uts)
+{
+	nand_erase_options_t opts = { };
+	struct nand_chip *chip;
+	struct mtd_info *mtd;
+	size_t length, retlen;
+	unsigned int options;
+	int *gold, i, n, ret;
+	u_char *buf;
+
+	srand(1);
+
+	mtd = get_nand_dev_by_index(1);
+	ut_assertnonnull(mtd);
+	chip = mtd_to_nand(mtd);
+
+	length = mtd->erasesize;
+	buf = malloc(length);
+	ut_assertnonnull(buf);
+	gold = malloc(length);
+	ut_assertnonnull(gold);
+
+	opts.offset = mtd->erasesize * 10;
+	opts.length = length;
+	ut_assertok(nand_erase_opts(mtd, &opts));
+
+	for (i = 0; i < length / sizeof(int); i++)
+		gold[i] = rand();
+	ut_assertok(mtd_write(mtd, opts.offset, length, &retlen,
+			      (u_char *)gold));
+	ut_asserteq(length, retlen);
+
+	/* Partial page reads only fill the page buffer without subpage reads */
+	options = chip->options;
+	chip->options &= ~NAND_SUBPAGE_READ;
+
+	/*
+	 * Read part of one of pages 1-4 so that it ends up in the page buffer,
+	 * then read pages 1-4 with a cache read and check each of them
+	 */
+	for (n = 1; n <= 4; n++) {
+		loff_t off = n * mtd->writesize;
+
+		ret = mtd_read(mtd, opts.offset + off + 100, 100, &retlen, buf);
+		ut_assert(!ret || ret == -EUCLEAN);
+		ut_asserteq(100, retlen);
+		ut_asserteq_mem((u_char *)gold + off + 100, buf, 100);
+
+		length = 4 * mtd->writesize;
+		memset(buf, '\0', length);
+		ret = mtd_read(mtd, opts.offset + mtd->writesize, length,
+			       &retlen, buf);
+		ut_assert(!ret || ret == -EUCLEAN);
+		ut_asserteq(length, retlen);
+		for (i = 0; i < 4; i++) {
+			off = (i + 1) * mtd->writesize;
+			ut_asserteq_mem((u_char *)gold + off,
+					buf + i * mtd->writesize,
+					mtd->writesize);
+		}
+		ut_assert(!chip->cont_read.ongoing);
+	}
+
+	chip->options = options;
+	free(gold);
+	free(buf);
+
+	return 0;
+}
+DM_TEST(dm_test_nand_cache_read_pagebuf, UTF_SCAN_FDT);
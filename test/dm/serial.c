@@ -3,10 +3,13 @@
  * Copyright (c) 2018, STMicroelectronics
  */
 
+#include <cyclic.h>
 #include <log.h>
 #include <serial.h>
 #include <dm.h>
+#include <sysreset.h>
 #include <asm/serial.h>
+#include <asm/state.h>
 #include <dm/test.h>
 #include <test/test.h>
 #include <test/ut.h>
@@ -88,3 +91,48 @@ static int dm_test_serial(struct unit_test_state *uts)
 	return 0;
 }
 DM_TEST(dm_test_serial, UTF_SCAN_FDT);
+
+/* Check that buffered output goes out from the cyclic function and on reset */
+static int dm_test_serial_tx_buffer(struct unit_test_state *uts)
+{
+	struct sandbox_state *state = state_get_current();
+	size_t start, len;
+
+	if (!IS_ENABLED(CONFIG_SERIAL_TX_BUFFER))
+		return -EAGAIN;
+
+	/* With room in the FIFO the output goes straight out */
+	sandbox_serial_endisable(false);
+	start = sandbox_serial_written();
+	serial_puts(test_message);
+	len = sandbox_serial_written() - start;
+	ut_assert(len >= sizeof(test_message) - 1);
+
+	/* With a full FIFO it is held in the buffer... */
+	sandbox_serial_set_busy(true);
+	start = sandbox_serial_written();
+	serial_puts(test_message);
+	ut_asserteq(start, sandbox_serial_written());
+
+	/* ...and sent once the UART has room again */
+	sandbox_serial_set_busy(false);
+	schedule();
+	ut_asserteq(start + len, sandbox_serial_written());
+
+	/* A reset request sends everything first; don't actually reset */
+	state->sysreset_allowed[SYSRESET_WARM] = false;
+	state->sysreset_allowed[SYSRESET_COLD] = false;
+	state->sysreset_allowed[SYSRESET_POWER] = false;
+	state->sysreset_allowed[SYSRESET_POWER_OFF] = false;
+	sandbox_serial_set_busy(true);
+	start = sandbox_serial_written();
+	serial_puts(test_message);
+	ut_asserteq(start, sandbox_serial_written());
+	sandbox_serial_set_busy(false);
+	ut_asserteq(-EACCES, sysreset_walk(SYSRESET_WARM));
+	sandbox_serial_endisable(true);
+	ut_asserteq(start + len, sandbox_serial_written());
+
+	return 0;
+}
+DM_TEST(dm_test_serial_tx_buffer, UTF_SCAN_FDT);
@@ -10,6 +10,7 @@
 #include <os.h>
 #include <spi.h>
 #include <spi_flash.h>
+#include <linux/mtd/spi-nor.h>
 #include <asm/state.h>
 #include <asm/test.h>
 #include <dm/test.h>
@@ -101,3 +102,61 @@ static int dm_test_spi_flash_func(struct unit_test_state *uts)
 	return 0;
 }
 DM_TEST(dm_test_spi_flash_func, UTF_SCAN_PDATA | UTF_SCAN_FDT);
+
+/* Test switching between read protocols and the 'sf bench' command */
+static int dm_test_spi_flash_read_proto(struct unit_test_state *uts)
+{
+	int full_size = 0x200000;
+	int size = 0x10000;
+	struct spi_flash *flash;
+	struct udevice *dev;
+	u32 hwcap;
+	u8 *src, *dst;
+
+	if (!CONFIG_IS_ENABLED(SPI_FLASH_READ_SELFTEST))
+		return -EAGAIN;
+
+	src = map_sysmem(0x20000, full_size);
+	ut_assertok(os_write_file("spi.bin", src, full_size));
+	ut_assertok(uclass_first_device_err(UCLASS_SPI_FLASH, &dev));
+	flash = dev_get_uclass_priv(dev);
+
+	/* The selected read command must have passed the self-test */
+	hwcap = flash->read_hwcap;
+	ut_assert(flash->read_hwcaps & hwcap);
+	ut_assert(flash->read_hwcaps & SNOR_HWCAPS_READ);
+
+	/* Plain 1-1-1 Read must give the same data */
+	ut_assertok(spi_nor_select_read_hwcap(flash, SNOR_HWCAPS_READ));
+	ut_asserteq(SPINOR_OP_READ, flash->read_opcode);
+	dst = map_sysmem(0x20000 + full_size, size);
+	ut_assertok(spi_flash_read_dm(dev, 0, size, dst));
+	ut_asserteq_mem(src, dst, size);
+
+	/* Protocols which are not supported are refused */
+	ut_asserteq(-EINVAL,
+		    spi_nor_select_read_hwcap(flash, SNOR_HWCAPS_READ_8_8_8_DTR));
+	ut_assertok(spi_nor_select_read_hwcap(flash, hwcap));
+
+	ut_assertok(run_command("sf probe", 0));
+	ut_assertok(run_command("sf bench 0 1000", 0));
+	ut_assert_skip_to_line("Reading 4096 bytes @ 0x0");
+	if (hwcap == SNOR_HWCAPS_READ) {
+		ut_assert_nextlinen("* 1-1-1 (03): ");
+	} else {
+		ut_assert_nextlinen("  1-1-1 (03): ");
+		ut_asserteq(SNOR_HWCAPS_READ_FAST, hwcap);
+		ut_assert_nextlinen("* 1-1-1 (0b): ");
+	}
+	ut_assert_console_end();
+
+	/*
+	 * Since we are about to destroy all devices, we must tell sandbox
+	 * to forget the emulation device
+	 */
+	sandbox_sf_unbind_emul(state_get_current(), 0, 0);
+
+	return 0;
+}
+DM_TEST(dm_test_spi_flash_read_proto,
+	UTF_SCAN_PDATA | UTF_SCAN_FDT | UTF_CONSOLE);
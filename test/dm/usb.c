@@ -166,6 +166,66 @@ static int dm_test_usb_stop(struct unit_test_state *uts)
 }
 DM_TEST(dm_test_usb_stop, UTF_SCAN_PDATA | UTF_SCAN_FDT);
 
+/* Switch the power of a port on the sandbox root hub */
+static int usb_test_port_power(struct udevice *hub, int port, bool on)
+{
+	struct usb_device *udev = dev_get_parent_priv(hub);
+
+	return usb_control_msg(udev, usb_sndctrlpipe(udev, 0),
+			       on ? USB_REQ_SET_FEATURE : USB_REQ_CLEAR_FEATURE,
+			       USB_RT_PORT, USB_PORT_FEAT_POWER, port, NULL, 0,
+			       USB_CNTL_TIMEOUT);
+}
+
+/* test that a rescan only touches ports which changed */
+static int dm_test_usb_rescan(struct unit_test_state *uts)
+{
+	struct udevice *hub, *stor[3], *dev;
+
+	state_set_skip_delays(true);
+	ut_assertok(usb_init());
+	ut_assertok(uclass_get_device_by_ofnode(UCLASS_USB_HUB,
+						ofnode_path("/usb@1/hub"),
+						&hub));
+	ut_assertok(uclass_get_device(UCLASS_MASS_STORAGE, 0, &stor[0]));
+	ut_assertok(uclass_get_device(UCLASS_MASS_STORAGE, 1, &stor[1]));
+	ut_assertok(uclass_get_device(UCLASS_MASS_STORAGE, 2, &stor[2]));
+	ut_asserteq(6, count_usb_devices());
+
+	/* Nothing changed, so the same devices must still be there */
+	ut_asserteq(0, usb_rescan());
+	ut_asserteq(6, count_usb_devices());
+	ut_assertok(uclass_get_device(UCLASS_MASS_STORAGE, 0, &dev));
+	ut_asserteq_ptr(stor[0], dev);
+	ut_assertok(uclass_get_device(UCLASS_MASS_STORAGE, 2, &dev));
+	ut_asserteq_ptr(stor[2], dev);
+
+	/* Unplug the second flash stick (port 2) */
+	ut_assertok(usb_test_port_power(hub, 2, false));
+	ut_asserteq(1, usb_rescan());
+	ut_asserteq(5, count_usb_devices());
+	ut_asserteq(-ENODEV, uclass_get_device(UCLASS_MASS_STORAGE, 2, &dev));
+	ut_asserteq(0, usb_rescan());
+
+	/* Plug it back in; the other devices must be left alone */
+	ut_assertok(usb_test_port_power(hub, 2, true));
+	ut_asserteq(1, usb_rescan());
+	ut_asserteq(6, count_usb_devices());
+	ut_assertok(uclass_get_device(UCLASS_MASS_STORAGE, 0, &dev));
+	ut_asserteq_ptr(stor[0], dev);
+	ut_assertok(uclass_get_device(UCLASS_MASS_STORAGE, 1, &dev));
+	ut_asserteq_ptr(stor[2], dev);
+	ut_assertok(uclass_get_device(UCLASS_MASS_STORAGE, 2, &dev));
+	ut_assert(dev != stor[1]);
+	ut_asserteq(0, usb_rescan());
+
+	ut_assertok(usb_stop());
+	ut_asserteq(0, count_usb_devices());
+
+	return 0;
+}
+DM_TEST(dm_test_usb_rescan, UTF_SCAN_PDATA | UTF_SCAN_FDT);
+
 /**
  * dm_test_usb_keyb() - test USB keyboard driver
  *
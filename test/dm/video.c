@@ -135,6 +135,61 @@ static int video_get_nologo(struct unit_test_state *uts, struct udevice **devp)
 	return 0;
 }
 
+/* Read a pixel from the (16bpp) sandbox frame buffer */
+static u16 video_get_pixel16(struct udevice *dev, int x, int y)
+{
+	struct video_priv *priv = dev_get_uclass_priv(dev);
+
+	return *(u16 *)(priv->fb + y * priv->line_length + x * 2);
+}
+
+/* Test the 2D operations: filling, copying and blending rectangles */
+static int dm_test_video_2d_ops(struct unit_test_state *uts)
+{
+	static const u8 alpha[] = { 0, 0x80, 0xff, 0xff, 0x80, 0 };
+	struct video_priv *priv;
+	struct udevice *dev;
+
+	ut_assertok(video_get_nologo(uts, &dev));
+	priv = dev_get_uclass_priv(dev);
+	ut_asserteq(VIDEO_BPP16, priv->bpix);
+	ut_assertok(video_fill(dev, 0));
+
+	ut_assertok(video_fill_rect(dev, 10, 20, 30, 4, 0x1234));
+	ut_asserteq(0, video_get_pixel16(dev, 9, 20));
+	ut_asserteq(0x1234, video_get_pixel16(dev, 10, 20));
+	ut_asserteq(0x1234, video_get_pixel16(dev, 39, 23));
+	ut_asserteq(0, video_get_pixel16(dev, 40, 23));
+	ut_asserteq(0, video_get_pixel16(dev, 39, 24));
+
+	/* overlapping copy, down and to the right */
+	ut_assertok(video_copy_rect(dev, 12, 22, 10, 20, 30, 4));
+	ut_asserteq(0x1234, video_get_pixel16(dev, 41, 25));
+	ut_asserteq(0, video_get_pixel16(dev, 42, 25));
+	ut_asserteq(0, video_get_pixel16(dev, 41, 26));
+	ut_asserteq(0x1234, video_get_pixel16(dev, 10, 20));
+
+	/* full-width copy, upwards */
+	ut_assertok(video_copy_rect(dev, 0, 0, 0, 20, priv->xsize, 6));
+	ut_asserteq(0x1234, video_get_pixel16(dev, 10, 0));
+	ut_asserteq(0x1234, video_get_pixel16(dev, 41, 5));
+	ut_asserteq(0, video_get_pixel16(dev, 9, 0));
+
+	/* white-on-black text is ORed in */
+	priv->colour_fg = 0xffff;
+	priv->colour_bg = 0;
+	ut_assertok(video_blit_alpha(dev, 100, 100, 3, 2, alpha, 3));
+	ut_asserteq(0, video_get_pixel16(dev, 100, 100));
+	ut_asserteq(0x8410, video_get_pixel16(dev, 101, 100));
+	ut_asserteq(0xffff, video_get_pixel16(dev, 102, 100));
+	ut_asserteq(0xffff, video_get_pixel16(dev, 100, 101));
+	ut_asserteq(0, video_get_pixel16(dev, 103, 100));
+	ut_assertok(video_check_copy_fb(uts, dev));
+
+	return 0;
+}
+DM_TEST(dm_test_video_2d_ops, UTF_SCAN_PDATA | UTF_SCAN_FDT);
+
 /* Test text output works on the video console */
 static int dm_test_video_text(struct unit_test_state *uts)
 {
@@ -589,6 +644,46 @@ static int dm_test_video_truetype(struct unit_test_state *uts)
 }
 DM_TEST(dm_test_video_truetype, UTF_SCAN_PDATA | UTF_SCAN_FDT);
 
+/* Test that the TrueType glyph cache gives the same output as rendering */
+static int dm_test_video_truetype_glyph_cache(struct unit_test_state *uts)
+{
+	struct vidconsole_glyph_stats base, stats;
+	struct udevice *dev, *con;
+	const char *test_string = "Criticism may not be agreeable, but it is necessary.";
+	int len = strlen(test_string);
+	int size;
+
+	if (!IF_ENABLED_INT(CONFIG_CONSOLE_TRUETYPE,
+			    CONFIG_CONSOLE_TRUETYPE_GLYPH_CACHE))
+		return -EAGAIN;
+
+	ut_assertok(video_get_nologo(uts, &dev));
+	ut_assertok(uclass_get_device(UCLASS_VIDEO_CONSOLE, 0, &con));
+	ut_assertok(console_truetype_glyph_stats(con, &base));
+
+	vidconsole_position_cursor(con, 0, 0);
+	vidconsole_put_string(con, test_string);
+	size = video_compress_fb(uts, dev, false);
+	ut_assertok(console_truetype_glyph_stats(con, &stats));
+	ut_assert(stats.misses > base.misses);
+	ut_asserteq(len, stats.hits + stats.misses - base.hits - base.misses);
+	ut_assert(stats.used <= stats.limit);
+
+	/* drawing the same text in the same place should always hit */
+	base = stats;
+	ut_assertok(video_clear(dev));
+	vidconsole_position_cursor(con, 0, 0);
+	vidconsole_put_string(con, test_string);
+	ut_asserteq(size, video_compress_fb(uts, dev, false));
+	ut_assertok(console_truetype_glyph_stats(con, &stats));
+	ut_asserteq(len, stats.hits - base.hits);
+	ut_asserteq(base.misses, stats.misses);
+	ut_assertok(video_check_copy_fb(uts, dev));
+
+	return 0;
+}
+DM_TEST(dm_test_video_truetype_glyph_cache, UTF_SCAN_PDATA | UTF_SCAN_FDT);
+
 /* Test scrolling TrueType console */
 static int dm_test_video_truetype_scroll(struct unit_test_state *uts)
 {
@@ -161,9 +161,10 @@ static size_t start_fit(void *dst, size_t fit_size, size_t data_size,
 }
 
 static size_t create_fit(void *dst, struct spl_image_info *spl_image,
-			 size_t *data_offset, bool external)
+			 size_t *data_offset, bool external, bool hash)
 {
-	size_t prop_size = 596, total_size = prop_size + spl_image->size;
+	size_t prop_size = hash ? 768 : 596;
+	size_t total_size = prop_size + spl_image->size;
 	size_t off, size;
 
 	if (external) {
@@ -205,6 +206,22 @@ static size_t create_fit(void *dst, struct spl_image_info *spl_image,
 		return 0;
 	if (fdt_property_addr(dst, FIT_LOAD_PROP, spl_image->load_addr))
 		return 0;
+	if (hash) {
+		u8 value[FIT_MAX_HASH_LEN];
+		int len;
+
+		if (calculate_hash(dst + off, spl_image->size, "sha256", value,
+				   &len))
+			return 0;
+		if (fdt_begin_node(dst, FIT_HASH_NODENAME "-1"))
+			return 0;
+		if (fdt_property_string(dst, FIT_ALGO_PROP, "sha256"))
+			return 0;
+		if (fdt_property(dst, FIT_VALUE_PROP, value, len))
+			return 0;
+		if (fdt_end_node(dst)) /* hash-1 */
+			return 0;
+	}
 	if (fdt_end_node(dst)) /* u-boot */
 		return 0;
 	if (fdt_end_node(dst)) /* images */
@@ -243,7 +260,7 @@ out:
 size_t create_image(void *dst, enum spl_test_image type,
 		    struct spl_image_info *info, size_t *data_offset)
 {
-	bool external = false;
+	bool external = false, hash = false;
 
 	info->os = IH_OS_U_BOOT;
 	info->load_addr = CONFIG_TEXT_BASE;
@@ -258,6 +275,9 @@ size_t create_image(void *dst, enum spl_test_image type,
 	case IMX8:
 		info->flags = SPL_IMX_CONTAINER;
 		return create_imx8(dst, info, data_offset);
+	case FIT_EXTERNAL_HASH:
+		hash = true;
+		fallthrough;
 	case FIT_EXTERNAL:
 		/*
 		 * spl_fit_append_fdt will clobber external images with U-Boot's
@@ -269,7 +289,7 @@ size_t create_image(void *dst, enum spl_test_image type,
 		external = true;
 	case FIT_INTERNAL:
 		info->flags = SPL_FIT_FOUND;
-		return create_fit(dst, info, data_offset, external);
+		return create_fit(dst, info, data_offset, external, hash);
 	}
 
 	return 0;
@@ -367,6 +387,53 @@ SPL_IMG_TEST(spl_test_image, IMX8, 0);
 SPL_IMG_TEST(spl_test_image, FIT_INTERNAL, 0);
 SPL_IMG_TEST(spl_test_image, FIT_EXTERNAL, 0);
 
+#if CONFIG_IS_ENABLED(FIT_HASH_WHILE_LOADING)
+/* Test hashing a FIT image in chunks as it is read */
+static int spl_test_fit_hash(struct unit_test_state *uts)
+{
+	size_t img_size, img_data;
+	size_t data_size = 3 * CONFIG_SPL_FIT_HASH_CHUNK_SIZE + 100;
+	struct spl_image_info info_write = {
+		.name = "fit_hash",
+		.size = data_size,
+	}, info_read = { };
+	struct spl_load_info load;
+	char *data;
+	void *img;
+
+	img_size = create_image(NULL, FIT_EXTERNAL_HASH, &info_write,
+				&img_data);
+	ut_assert(img_size);
+
+	/* reads are rounded up to the block length */
+	img = calloc(ALIGN(img_size, 512), 1);
+	ut_assertnonnull(img);
+
+	data = img + img_data;
+	generate_data(data, data_size, "fit_hash");
+	ut_asserteq(img_size, create_image(img, FIT_EXTERNAL_HASH, &info_write,
+					   NULL));
+
+	/* the data does not start on a block boundary */
+	spl_load_init(&load, spl_test_read, img, 512);
+	ut_asserteq(512, spl_get_bl_len(&load));
+	ut_assert(img_data % 512);
+
+	ut_assertok(spl_load_simple_fit(&info_read, &load, 0, img));
+	if (check_image_info(uts, &info_write, &info_read))
+		return CMD_RET_FAILURE;
+	ut_asserteq_mem(data, phys_to_virt(info_write.load_addr), data_size);
+
+	/* a corrupted byte in a middle chunk is found */
+	data[CONFIG_SPL_FIT_HASH_CHUNK_SIZE + 0x123] ^= 1;
+	ut_asserteq(-EPERM, spl_load_simple_fit(&info_read, &load, 0, img));
+
+	free(img);
+	return 0;
+}
+SPL_TEST(spl_test_fit_hash, 0);
+#endif
+
 /*
  * LZMA is too complex to generate on the fly, so let's use some data I put in
  * the oven^H^H^H^H compressed earlier
@@ -3,10 +3,17 @@
  * Copyright (C) 2023 Sean Anderson <seanga2@gmail.com>
  */
 
+#include <bloblist.h>
+#include <malloc.h>
+#include <mapmem.h>
 #include <nand.h>
 #include <spl.h>
+#include <asm/global_data.h>
 #include <test/spl.h>
 #include <test/ut.h>
+#include <linux/mtd/rawnand.h>
+
+DECLARE_GLOBAL_DATA_PTR;
 
 uint32_t spl_nand_get_uboot_raw_page(void);
 
@@ -54,3 +61,55 @@ SPL_IMG_TEST(spl_test_nand, FIT_INTERNAL, DM_FLAGS);
 #if !IS_ENABLED(CONFIG_SPL_LOAD_FIT_FULL)
 SPL_IMG_TEST(spl_test_nand, FIT_EXTERNAL, DM_FLAGS);
 #endif
+
+#if CONFIG_IS_ENABLED(NAND_BBT_HANDOFF)
+/* Check that SPL builds the bad block table and hands it over */
+static int spl_test_nand_bbt_handoff(struct unit_test_state *uts)
+{
+	struct nand_bbt_handoff *ho;
+	struct nand_chip *chip;
+	struct mtd_info *mtd;
+	int len, size;
+	loff_t ofs;
+	void *blob;
+
+	nand_reinit();
+	mtd = get_nand_dev_by_index(0);
+	ut_assertnonnull(mtd);
+	chip = mtd_to_nand(mtd);
+
+	/* Use a scratch bloblist, which is dropped when the test finishes */
+	len = mtd->size >> (chip->bbt_erase_shift + 2);
+	size = sizeof(struct bloblist_hdr) + sizeof(struct bloblist_rec) +
+		sizeof(*ho) + len + BLOBLIST_BLOB_ALIGN;
+	blob = memalign(BLOBLIST_ALIGN, size);
+	ut_assertnonnull(blob);
+	ut_assertok(bloblist_new(map_to_sysmem(blob), size, 0, 0));
+
+	/* The table is built when the first block is checked */
+	ut_assertnull(chip->bbt);
+	ofs = mtd->size / 2;
+	ut_asserteq(0, mtd_block_isbad(mtd, ofs));
+	ut_assertnonnull(chip->bbt);
+	ho = bloblist_find(BLOBLISTT_U_BOOT_NAND_BBT, sizeof(*ho) + len);
+	ut_assertnonnull(ho);
+	ut_asserteq(1, ho->gen);
+	ut_asserteq(chip->bbt_erase_shift, ho->erase_shift);
+	ut_asserteq_64(mtd->size, ho->size);
+	ut_asserteq(chip->id.len, ho->id_len);
+	ut_asserteq_mem(chip->id.data, ho->id, chip->id.len);
+	ut_asserteq_mem(chip->bbt, ho->bbt, len);
+
+	/* Marking a block bad updates the table and its generation */
+	ut_assertok(mtd_block_markbad(mtd, ofs));
+	ut_asserteq(1, mtd_block_isbad(mtd, ofs));
+	ut_asserteq(2, ho->gen);
+	ut_asserteq_mem(chip->bbt, ho->bbt, len);
+
+	gd_set_bloblist(NULL);
+	free(blob);
+
+	return 0;
+}
+SPL_TEST(spl_test_nand_bbt_handoff, DM_FLAGS | UFT_BLOBLIST);
+#endif
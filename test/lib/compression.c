@@ -12,6 +12,7 @@
 #include <malloc.h>
 #include <mapmem.h>
 #include <asm/io.h>
+#include <asm/unaligned.h>
 
 #include <u-boot/lz4.h>
 #include <u-boot/zlib.h>
@@ -22,6 +23,7 @@
 #include <lzma/LzmaTools.h>
 
 #include <linux/lzo.h>
+#include <linux/xxhash.h>
 #include <linux/zstd.h>
 #include <test/lib.h>
 #include <test/ut.h>
@@ -472,6 +474,111 @@ static int compression_test_gzip(struct unit_test_state *uts)
 }
 LIB_TEST(compression_test_gzip, 0);
 
+/* Size of the data for compression_test_inflate_stream() */
+#define INFLATE_TEST_SIZE	(96 << 10)
+
+/**
+ * fill_inflate_data() - create data with matches at many distances
+ *
+ * This mixes literals with runs repeating the data 1-7 and 8-15 bytes back,
+ * which inflate_fast() copies specially, and with copies from up to 32KB back,
+ * which come from the sliding window when streaming
+ *
+ * @buf: Buffer to fill
+ * @size: Size of buffer
+ */
+static void fill_inflate_data(u8 *buf, int size)
+{
+	u32 seed = 1;
+	int pos, len, dist, i;
+
+	for (pos = 0; pos < size; pos += len) {
+		seed = seed * 1103515245 + 12345;
+		len = min(3 + (int)(seed >> 8) % 256, size - pos);
+		switch (seed >> 30) {
+		case 1:
+			dist = 1 + (seed >> 20) % 7;
+			break;
+		case 2:
+			dist = 8 + (seed >> 20) % 8;
+			break;
+		case 3:
+			seed = seed * 1103515245 + 12345;
+			dist = 16 + (seed >> 8) % 32752;
+			break;
+		default:
+			dist = 0;
+			break;
+		}
+
+		for (i = 0; i < len; i++) {
+			if (dist && dist <= pos) {
+				buf[pos + i] = buf[pos + i - dist];
+			} else {
+				seed = seed * 1103515245 + 12345;
+				buf[pos + i] = 'a' + (seed >> 16) % 16;
+			}
+		}
+	}
+}
+
+/* Test streaming inflate with a small output buffer */
+static int compression_test_inflate_stream(struct unit_test_state *uts)
+{
+	static const int out_sizes[] = { 1, 7, 265, 266, 300, 1000, 4096 };
+	u8 *plain_buf, *comp, *out, chunk[4096 + 8];
+	unsigned long comp_size = INFLATE_TEST_SIZE + 1024;
+	int ret, hdr, i, j, len, pos, step;
+	z_stream s;
+
+	plain_buf = malloc(INFLATE_TEST_SIZE);
+	comp = malloc(comp_size);
+	out = malloc(INFLATE_TEST_SIZE);
+	ut_assertnonnull(plain_buf);
+	ut_assertnonnull(comp);
+	ut_assertnonnull(out);
+
+	fill_inflate_data(plain_buf, INFLATE_TEST_SIZE);
+	ut_assertok(gzip(comp, &comp_size, plain_buf, INFLATE_TEST_SIZE));
+	hdr = gzip_parse_header(comp, comp_size);
+	ut_assert(hdr > 0);
+
+	memset(&s, '\0', sizeof(s));
+	ut_asserteq(Z_OK, inflateInit2(&s, -MAX_WBITS));
+	s.next_in = comp + hdr;
+	s.avail_in = comp_size - hdr;
+	pos = 0;
+	i = 0;
+	do {
+		step = out_sizes[i++ % ARRAY_SIZE(out_sizes)];
+		memset(chunk, 0xaa, sizeof(chunk));
+		s.next_out = chunk;
+		s.avail_out = step;
+		ret = inflate(&s, Z_NO_FLUSH);
+		ut_assert(ret == Z_OK || ret == Z_STREAM_END);
+
+		/* nothing may be written past the end of the output space */
+		for (j = step; j < step + 8; j++)
+			ut_asserteq(0xaa, chunk[j]);
+
+		len = step - s.avail_out;
+		ut_assert(pos + len <= INFLATE_TEST_SIZE);
+		memcpy(out + pos, chunk, len);
+		pos += len;
+	} while (ret != Z_STREAM_END);
+	inflateEnd(&s);
+
+	ut_asserteq(INFLATE_TEST_SIZE, pos);
+	ut_asserteq_mem(plain_buf, out, INFLATE_TEST_SIZE);
+
+	free(out);
+	free(comp);
+	free(plain_buf);
+
+	return 0;
+}
+LIB_TEST(compression_test_inflate_stream, 0);
+
 static int compression_test_bzip2(struct unit_test_state *uts)
 {
 	return run_test(uts, "bzip2", compress_using_bzip2,
@@ -498,6 +605,105 @@ static int compression_test_lz4(struct unit_test_state *uts)
 }
 LIB_TEST(compression_test_lz4, 0);
 
+#if CONFIG_IS_ENABLED(LZ4_CHECKSUM)
+/* Offset of the first block header in lz4_compressed */
+#define LZ4_BLOCKS_OFFSET	7
+
+/**
+ * make_lz4_frame() - create an LZ4 frame with block and content checksums
+ *
+ * The frame holds the compressed block from lz4_compressed followed by an
+ * uncompressed block with the plain text, so it decompresses to two copies of
+ * the plain text.
+ *
+ * @buf: Buffer for the frame
+ * Return: size of the frame
+ */
+static int make_lz4_frame(u8 *buf)
+{
+	const u8 *block = (const u8 *)lz4_compressed + LZ4_BLOCKS_OFFSET;
+	u32 block_size = get_unaligned_le32(block);
+	int len = strlen(plain);
+	struct xxh32_state state;
+	u8 *ptr = buf;
+
+	put_unaligned_le32(LZ4F_MAGIC, ptr);
+	ptr[4] = 0x74;	/* version 1, independent blocks, both checksums */
+	ptr[5] = 0x40;	/* 64KB blocks */
+	ptr[6] = xxh32(ptr + 4, 2, 0) >> 8;
+	ptr += LZ4_BLOCKS_OFFSET;
+
+	memcpy(ptr, block, sizeof(u32) + block_size);
+	ptr += sizeof(u32) + block_size;
+	put_unaligned_le32(xxh32(block + sizeof(u32), block_size, 0), ptr);
+	ptr += sizeof(u32);
+
+	put_unaligned_le32(len | 0x80000000, ptr);
+	ptr += sizeof(u32);
+	memcpy(ptr, plain, len);
+	ptr += len;
+	put_unaligned_le32(xxh32(plain, len, 0), ptr);
+	ptr += sizeof(u32);
+
+	put_unaligned_le32(0, ptr);
+	ptr += sizeof(u32);
+	xxh32_reset(&state, 0);
+	xxh32_update(&state, plain, len);
+	xxh32_update(&state, plain, len);
+	put_unaligned_le32(xxh32_digest(&state), ptr);
+	ptr += sizeof(u32);
+
+	return ptr - buf;
+}
+
+/* Test that the checksums in an LZ4 frame are verified */
+static int compression_test_lz4_checksum(struct unit_test_state *uts)
+{
+	u8 frame[1024], out[1024];
+	int len = strlen(plain);
+	size_t out_size;
+	int size;
+
+	size = make_lz4_frame(frame);
+	out_size = sizeof(out);
+	ut_assertok(ulz4fn(frame, size, out, &out_size));
+	ut_asserteq(2 * len, out_size);
+	ut_asserteq_mem(plain, out, len);
+	ut_asserteq_mem(plain, out + len, len);
+
+	/* a corrupted block is rejected before anything is written */
+	frame[size - 20] ^= 1;
+	memset(out, 'A', sizeof(out));
+	out_size = sizeof(out);
+	ut_asserteq(-EBADMSG, ulz4fn(frame, size, out, &out_size));
+	ut_asserteq(0, out_size);
+	ut_asserteq('A', out[0]);
+	frame[size - 20] ^= 1;
+
+	/* header checksum */
+	frame[LZ4_BLOCKS_OFFSET - 1] ^= 1;
+	out_size = sizeof(out);
+	ut_asserteq(-EBADMSG, ulz4fn(frame, size, out, &out_size));
+	frame[LZ4_BLOCKS_OFFSET - 1] ^= 1;
+
+	/* content checksum */
+	frame[size - 1] ^= 1;
+	out_size = sizeof(out);
+	ut_asserteq(-EBADMSG, ulz4fn(frame, size, out, &out_size));
+	frame[size - 1] ^= 1;
+
+	/* a frame without block checksums still has its content checked */
+	memcpy(frame, lz4_compressed, lz4_compressed_size);
+	frame[lz4_compressed_size - 1] ^= 1;
+	out_size = sizeof(out);
+	ut_asserteq(-EBADMSG, ulz4fn(frame, lz4_compressed_size, out,
+				     &out_size));
+
+	return 0;
+}
+LIB_TEST(compression_test_lz4_checksum, 0);
+#endif
+
 static int compression_test_zstd(struct unit_test_state *uts)
 {
 	return run_test(uts, "zstd", compress_using_zstd,
@@ -505,6 +711,115 @@ static int compression_test_zstd(struct unit_test_state *uts)
 }
 LIB_TEST(compression_test_zstd, 0);
 
+/* Test decompressing data with two frames, in one go and in chunks */
+static int compression_test_zstd_frames(struct unit_test_state *uts)
+{
+	char in[2 * sizeof(zstd_compressed) + 4], out[1024];
+	int size = 2 * zstd_compressed_size;
+	int len = strlen(plain);
+	struct abuf in_buf, out_buf;
+	struct zstd_stream zs;
+	int i, chunk, ret;
+
+	memcpy(in, zstd_compressed, zstd_compressed_size);
+	memcpy(in + zstd_compressed_size, zstd_compressed,
+	       zstd_compressed_size);
+	strcpy(in + size, "junk");
+
+	/* the junk at the end is ignored */
+	abuf_init_set(&in_buf, in, size + 4);
+	abuf_init_set(&out_buf, out, sizeof(out));
+	ut_asserteq(2 * len, zstd_decompress(&in_buf, &out_buf));
+	ut_asserteq_mem(plain, out, len);
+	ut_asserteq_mem(plain, out + len, len);
+
+	memset(out, '\0', sizeof(out));
+	zstd_stream_init(&zs, &out_buf);
+	for (i = 0; i < size; i += chunk) {
+		chunk = min(16, size - i);
+		ut_assertok(zstd_stream_decompress(&zs, in + i, chunk));
+	}
+	ut_asserteq(2 * len, zstd_stream_finish(&zs));
+	ut_asserteq_mem(plain, out, len);
+	ut_asserteq_mem(plain, out + len, len);
+
+	/* the junk is ignored when streaming too */
+	memset(out, '\0', sizeof(out));
+	zstd_stream_init(&zs, &out_buf);
+	ut_assertok(zstd_stream_decompress(&zs, in, size + 4));
+	ut_assertok(zstd_stream_decompress(&zs, "more", 4));
+	ut_asserteq(2 * len, zstd_stream_finish(&zs));
+	ut_asserteq_mem(plain, out + len, len);
+
+	/* data ending part-way through a frame */
+	zstd_stream_init(&zs, &out_buf);
+	ut_assertok(zstd_stream_decompress(&zs, in, size - 1));
+	ut_asserteq(-EINVAL, zstd_stream_finish(&zs));
+
+	/* output buffer too small */
+	abuf_init_set(&out_buf, out, len + 1);
+	zstd_stream_init(&zs, &out_buf);
+	ut_asserteq(-ENOSPC, zstd_stream_decompress(&zs, in, size));
+
+	/* output buffer filling up part-way through the last chunk */
+	abuf_init_set(&out_buf, out, len - 1);
+	zstd_stream_init(&zs, &out_buf);
+	for (i = 0, ret = 0; !ret && i < zstd_compressed_size; i += chunk) {
+		chunk = min(16, (int)zstd_compressed_size - i);
+		ret = zstd_stream_decompress(&zs, in + i, chunk);
+	}
+	if (!ret)
+		ret = zstd_stream_finish(&zs);
+	ut_asserteq(-ENOSPC, ret);
+
+	return 0;
+}
+LIB_TEST(compression_test_zstd_frames, 0);
+
+/* Test streaming data which starts with skippable frames */
+static int compression_test_zstd_skippable(struct unit_test_state *uts)
+{
+	static const char skip[] = {
+		0x50, 0x2a, 0x4d, 0x18, 4, 0, 0, 0, 'a', 'b', 'c', 'd',
+		0x5f, 0x2a, 0x4d, 0x18, 0, 0, 0, 0,
+	};
+	char in[sizeof(skip) + sizeof(zstd_compressed)], out[1024];
+	int size = sizeof(skip) + zstd_compressed_size;
+	int len = strlen(plain);
+	struct abuf out_buf;
+	struct zstd_stream zs;
+	int i, chunk, step;
+
+	memcpy(in, skip, sizeof(skip));
+	memcpy(in + sizeof(skip), zstd_compressed, zstd_compressed_size);
+	abuf_init_set(&out_buf, out, sizeof(out));
+
+	/* use chunks which split the frame headers in different places */
+	for (step = 1; step <= 16; step++) {
+		memset(out, '\0', sizeof(out));
+		zstd_stream_init(&zs, &out_buf);
+		for (i = 0; i < size; i += chunk) {
+			chunk = min(step, size - i);
+			ut_assertok(zstd_stream_decompress(&zs, in + i, chunk));
+		}
+		ut_asserteq(len, zstd_stream_finish(&zs));
+		ut_asserteq_mem(plain, out, len);
+	}
+
+	/* only skippable frames */
+	zstd_stream_init(&zs, &out_buf);
+	ut_assertok(zstd_stream_decompress(&zs, skip, sizeof(skip)));
+	ut_asserteq(0, zstd_stream_finish(&zs));
+
+	/* ending part-way through a skippable frame */
+	zstd_stream_init(&zs, &out_buf);
+	ut_assertok(zstd_stream_decompress(&zs, skip, 10));
+	ut_asserteq(-EINVAL, zstd_stream_finish(&zs));
+
+	return 0;
+}
+LIB_TEST(compression_test_zstd_skippable, 0);
+
 static int compress_using_none(struct unit_test_state *uts,
 			       void *in, unsigned long in_size,
 			       void *out, unsigned long out_max,
@@ -601,6 +916,42 @@ static int compression_test_bootm_zstd(struct unit_test_state *uts)
 }
 LIB_TEST(compression_test_bootm_zstd, 0);
 
+/* Test decompressing a zstd image which spans several chunks */
+static int compression_test_bootm_zstd_chunks(struct unit_test_state *uts)
+{
+	int count = CHUNKSZ / zstd_compressed_size + 2;
+	ulong in_size = count * zstd_compressed_size;
+	int len = strlen(plain);
+	ulong load_end;
+	char *in, *out;
+	int i;
+
+	/* each copy is a frame, so some frames straddle two chunks */
+	in = malloc(in_size);
+	ut_assertnonnull(in);
+	out = malloc(count * len);
+	ut_assertnonnull(out);
+	for (i = 0; i < count; i++)
+		memcpy(in + i * zstd_compressed_size, zstd_compressed,
+		       zstd_compressed_size);
+
+	ut_assertok(image_decomp(IH_COMP_ZSTD, 0, 1, IH_TYPE_KERNEL, out, in,
+				 in_size, count * len, &load_end));
+	ut_asserteq(count * len, load_end);
+	for (i = 0; i < count; i++)
+		ut_asserteq_mem(plain, out + i * len, len);
+
+	ut_asserteq(-ENOSPC, image_decomp(IH_COMP_ZSTD, 0, 1, IH_TYPE_KERNEL,
+					  out, in, in_size, count * len - 1,
+					  &load_end));
+
+	free(out);
+	free(in);
+
+	return 0;
+}
+LIB_TEST(compression_test_bootm_zstd_chunks, 0);
+
 static int compression_test_bootm_none(struct unit_test_state *uts)
 {
 	return run_bootm_test(uts, IH_COMP_NONE, compress_using_none);
@@ -6,6 +6,7 @@
  */
 
 #include <efi_loader.h>
+#include <malloc.h>
 #include <test/lib.h>
 #include <test/test.h>
 #include <test/ut.h>
@@ -61,3 +62,85 @@ static int lib_test_efi_allocate_pages(struct unit_test_state *uts)
 	return 0;
 }
 LIB_TEST(lib_test_efi_allocate_pages, 0);
+
+/* Get a copy of the memory map, checking that it is sorted and merged */
+static int get_checked_map(struct unit_test_state *uts,
+			   struct efi_mem_desc **mapp, efi_uintn_t *countp,
+			   efi_uintn_t *keyp)
+{
+	struct efi_mem_desc *map, *prev, *cur;
+	efi_uintn_t size = 0, desc_size, i;
+	u32 desc_version;
+
+	ut_asserteq_64(EFI_BUFFER_TOO_SMALL,
+		       efi_get_memory_map(&size, NULL, keyp, &desc_size,
+					  &desc_version));
+	ut_asserteq(sizeof(*map), desc_size);
+	map = malloc(size);
+	ut_assertnonnull(map);
+	ut_asserteq_64(EFI_SUCCESS,
+		       efi_get_memory_map(&size, map, keyp, NULL, NULL));
+
+	for (i = 1; i < size / desc_size; i++) {
+		prev = &map[i - 1];
+		cur = &map[i];
+		ut_assert(prev->physical_start +
+			  (prev->num_pages << EFI_PAGE_SHIFT) <=
+			  cur->physical_start);
+		ut_assert(prev->physical_start +
+			  (prev->num_pages << EFI_PAGE_SHIFT) !=
+			  cur->physical_start || prev->type != cur->type ||
+			  prev->attribute != cur->attribute);
+	}
+	*mapp = map;
+	*countp = size / desc_size;
+
+	return 0;
+}
+
+static int lib_test_efi_memory_map(struct unit_test_state *uts)
+{
+	efi_uintn_t orig_count, count, orig_key, key, i;
+	struct efi_mem_desc *orig, *map;
+	u64 memory[100], addr;
+
+	ut_assertok(get_checked_map(uts, &orig, &orig_count, &orig_key));
+
+	/* alternate the type, so that adjacent allocations are not merged */
+	for (i = 0; i < ARRAY_SIZE(memory); i++) {
+		ut_asserteq_64(EFI_SUCCESS,
+			       efi_allocate_pages(EFI_ALLOCATE_ANY_PAGES,
+						  i & 1 ? EFI_LOADER_DATA :
+						  EFI_BOOT_SERVICES_DATA, 1,
+						  &memory[i]));
+	}
+	ut_assertok(get_checked_map(uts, &map, &count, &key));
+	ut_assert(key != orig_key);
+	ut_assert(count >= orig_count + ARRAY_SIZE(memory) - 1);
+	free(map);
+
+	/* an unchanged map keeps its key */
+	ut_assertok(get_checked_map(uts, &map, &count, &orig_key));
+	free(map);
+	ut_assertok(get_checked_map(uts, &map, &count, &key));
+	ut_asserteq(orig_key, key);
+	free(map);
+
+	/* allocated pages cannot be allocated again */
+	addr = memory[5];
+	ut_asserteq_64(EFI_NOT_FOUND,
+		       efi_allocate_pages(EFI_ALLOCATE_ADDRESS,
+					  EFI_LOADER_DATA, 1, &addr));
+
+	/* freeing everything restores the original map */
+	for (i = 0; i < ARRAY_SIZE(memory); i++)
+		ut_asserteq_64(EFI_SUCCESS, efi_free_pages(memory[i], 1));
+	ut_assertok(get_checked_map(uts, &map, &count, &key));
+	ut_asserteq(orig_count, count);
+	ut_asserteq_mem(orig, map, count * sizeof(*map));
+	free(orig);
+	free(map);
+
+	return 0;
+}
+LIB_TEST(lib_test_efi_memory_map, 0);
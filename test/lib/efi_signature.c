@@ -0,0 +1,337 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Test looking up digests in a large signature database
+ */
+
+#include <efi_loader.h>
+#include <efi_variable.h>
+#include <malloc.h>
+#include <test/lib.h>
+#include <test/test.h>
+#include <test/ut.h>
+
+/* Number of entries in the test dbx, similar to the UEFI revocation list */
+#define DBX_ENTRIES	10000
+#define DIGEST_SIZE	32
+
+/* Where the image digest goes in the sorted dbx, see make_dbx() */
+enum dbx_pos {
+	DBX_NONE,	/* not present */
+	DBX_RANDOM,	/* among pseudo-random digests */
+	DBX_FIRST,
+	DBX_MIDDLE,
+	DBX_LAST,
+};
+
+/**
+ * near_digest() - create a digest close to another one
+ *
+ * @out: Returns the new digest
+ * @digest: Digest to start from
+ * @delta: Amount to add to @digest, treating it as a big-endian number
+ */
+static void near_digest(u8 *out, const u8 *digest, int delta)
+{
+	int i, val;
+
+	for (i = DIGEST_SIZE - 1; i >= 0; i--) {
+		val = digest[i] + delta;
+		out[i] = val;
+		delta = val >> 8;
+	}
+}
+
+/**
+ * make_dbx() - create a signature list of SHA-256 digests
+ *
+ * With DBX_RANDOM the digests are pseudo-random, except for one which is set
+ * to @digest. With DBX_FIRST, DBX_MIDDLE and DBX_LAST the other digests are
+ * just above and/or below @digest, so that it ends up in that position when
+ * the list is sorted.
+ *
+ * @digest: Digest to include in the list
+ * @pos: Where to put @digest
+ * @sizep: Returns the size of the list
+ * Return: signature list, or NULL if out of memory
+ */
+static void *make_dbx(const u8 *digest, enum dbx_pos pos, efi_uintn_t *sizep)
+{
+	struct efi_signature_list *esl;
+	struct efi_signature_data *esd;
+	efi_uintn_t entry_size, size;
+	u32 seed = 1;
+	int i, j;
+
+	entry_size = sizeof(*esd) + DIGEST_SIZE;
+	size = sizeof(*esl) + DBX_ENTRIES * entry_size;
+	esl = calloc(1, size);
+	if (!esl)
+		return NULL;
+	esl->signature_type = efi_guid_sha256;
+	esl->signature_list_size = size;
+	esl->signature_size = entry_size;
+
+	esd = (void *)esl + sizeof(*esl);
+	for (i = 0; i < DBX_ENTRIES; i++) {
+		if (pos != DBX_NONE && i == DBX_ENTRIES / 3) {
+			memcpy(esd->signature_data, digest, DIGEST_SIZE);
+		} else if (pos == DBX_FIRST) {
+			near_digest(esd->signature_data, digest, i + 1);
+		} else if (pos == DBX_LAST) {
+			near_digest(esd->signature_data, digest, -i - 1);
+		} else if (pos == DBX_MIDDLE) {
+			near_digest(esd->signature_data, digest,
+				    i & 1 ? i + 1 : -i - 1);
+		} else {
+			for (j = 0; j < DIGEST_SIZE; j++) {
+				seed = seed * 1103515245 + 12345;
+				esd->signature_data[j] = seed >> 16;
+			}
+		}
+		esd = (void *)esd + entry_size;
+	}
+	*sizep = size;
+
+	return esl;
+}
+
+/**
+ * setup_image() - set up a region list for a test image
+ *
+ * @uts: Test state
+ * @image: Image contents, filled in by this function
+ * @size: Size of @image
+ * @regsp: Returns the region list
+ * @digestp: Returns the SHA-256 digest of @image
+ * Return: 0 if OK, -ve on error
+ */
+static int setup_image(struct unit_test_state *uts, u8 *image, int size,
+		       struct efi_image_regions **regsp, u8 **digestp)
+{
+	struct efi_image_regions *regs;
+	int i, len;
+
+	regs = calloc(sizeof(*regs) + sizeof(struct image_region), 1);
+	ut_assertnonnull(regs);
+	for (i = 0; i < size; i++)
+		image[i] = i;
+	regs->max = 1;
+	ut_assertok(efi_image_region_add(regs, image, image + size, 0));
+	*digestp = NULL;
+	ut_assert(efi_hash_regions(regs->reg, regs->num, (void **)digestp,
+				   "sha256", &len));
+	ut_asserteq(DIGEST_SIZE, len);
+	*regsp = regs;
+
+	return 0;
+}
+
+/**
+ * check_revoked() - check lookup of an image in a dbx
+ *
+ * @uts: Test state
+ * @regs: Regions of the image to look up
+ * @digest: Digest to put in the dbx
+ * @pos: Where to put @digest in the dbx
+ * @expect: true if the image is expected to be revoked
+ * Return: 0 if OK, -ve on error
+ */
+static int check_revoked(struct unit_test_state *uts,
+			 struct efi_image_regions *regs, const u8 *digest,
+			 enum dbx_pos pos, bool expect)
+{
+	struct efi_signature_store *dbx;
+	efi_uintn_t size;
+	void *esl;
+
+	esl = make_dbx(digest, pos, &size);
+	ut_assertnonnull(esl);
+	dbx = efi_build_signature_store(esl, size);
+	ut_assertnonnull(dbx);
+	ut_asserteq(DBX_ENTRIES, dbx->sig_count);
+	ut_asserteq(expect, efi_signature_lookup_digest(regs, dbx, true));
+	efi_sigstore_free(dbx);
+
+	return 0;
+}
+
+/* Check lookups of an image digest in a dbx with 10k entries */
+static int lib_test_efi_signature_dbx(struct unit_test_state *uts)
+{
+	struct efi_image_regions *regs;
+	u8 image[64], *digest;
+
+	ut_assertok(setup_image(uts, image, sizeof(image), &regs, &digest));
+
+	ut_assertok(check_revoked(uts, regs, digest, DBX_NONE, false));
+	ut_assertok(check_revoked(uts, regs, digest, DBX_RANDOM, true));
+	ut_assertok(check_revoked(uts, regs, digest, DBX_FIRST, true));
+	ut_assertok(check_revoked(uts, regs, digest, DBX_MIDDLE, true));
+	ut_assertok(check_revoked(uts, regs, digest, DBX_LAST, true));
+
+	/* a different image is not revoked */
+	image[0] ^= 0xff;
+	ut_assertok(check_revoked(uts, regs, digest, DBX_RANDOM, false));
+	ut_assertok(check_revoked(uts, regs, digest, DBX_FIRST, false));
+	ut_assertok(check_revoked(uts, regs, digest, DBX_LAST, false));
+
+	free(digest);
+	free(regs);
+
+	return 0;
+}
+LIB_TEST(lib_test_efi_signature_dbx, 0);
+
+/**
+ * make_mixed_dbx() - create a dbx with SHA-256 and SHA-512 lists
+ *
+ * The SHA-256 list comes first and does not include the image, so a lookup
+ * must go on to check the SHA-512 list, with a SHA-512 digest of the image
+ *
+ * @digest: SHA-256 digest to leave out of the first list
+ * @digest512: SHA-512 digest to put in the second list
+ * @sizep: Returns the size of the lists
+ * Return: signature lists, or NULL if out of memory
+ */
+static void *make_mixed_dbx(const u8 *digest, const u8 *digest512,
+			    efi_uintn_t *sizep)
+{
+	struct efi_signature_list *esl;
+	struct efi_signature_data *esd;
+	efi_uintn_t size, size512;
+	void *buf, *new;
+
+	buf = make_dbx(digest, DBX_NONE, &size);
+	if (!buf)
+		return NULL;
+	size512 = sizeof(*esl) + sizeof(*esd) + SHA512_SUM_LEN;
+	new = realloc(buf, size + size512);
+	if (!new) {
+		free(buf);
+		return NULL;
+	}
+
+	esl = new + size;
+	memset(esl, '\0', size512);
+	esl->signature_type = (efi_guid_t)EFI_CERT_SHA512_GUID;
+	esl->signature_list_size = size512;
+	esl->signature_size = sizeof(*esd) + SHA512_SUM_LEN;
+	esd = (void *)esl + sizeof(*esl);
+	memcpy(esd->signature_data, digest512, SHA512_SUM_LEN);
+	*sizep = size + size512;
+
+	return new;
+}
+
+/* Check that each list in a dbx is checked with a digest of its own type */
+static int lib_test_efi_signature_mixed(struct unit_test_state *uts)
+{
+	struct efi_signature_store *dbx;
+	struct efi_image_regions *regs;
+	u8 image[64], *digest, *digest512 = NULL;
+	efi_uintn_t size;
+	void *esl;
+	int len;
+
+	ut_assertok(setup_image(uts, image, sizeof(image), &regs, &digest));
+	ut_assert(efi_hash_regions(regs->reg, regs->num, (void **)&digest512,
+				   "sha512", &len));
+	ut_asserteq(SHA512_SUM_LEN, len);
+
+	esl = make_mixed_dbx(digest, digest512, &size);
+	ut_assertnonnull(esl);
+	dbx = efi_build_signature_store(esl, size);
+	ut_assertnonnull(dbx);
+	ut_assertnonnull(dbx->next);
+	ut_asserteq(DBX_ENTRIES + 1, dbx->sig_count + dbx->next->sig_count);
+	ut_assert(efi_signature_lookup_digest(regs, dbx, true));
+
+	/* a different image is not revoked */
+	image[0] ^= 0xff;
+	ut_assert(!efi_signature_lookup_digest(regs, dbx, true));
+	efi_sigstore_free(dbx);
+
+	free(digest512);
+	free(digest);
+	free(regs);
+
+	return 0;
+}
+LIB_TEST(lib_test_efi_signature_mixed, 0);
+
+/**
+ * set_dbx() - set the value of the dbx variable
+ *
+ * This writes the variable store directly, since a real update of dbx must
+ * be signed.
+ *
+ * @uts: Test state
+ * @digest: Digest to include in the list, or NULL to delete the variable
+ * @pos: Where to put @digest
+ * Return: 0 if OK, -ve on error
+ */
+static int set_dbx(struct unit_test_state *uts, const u8 *digest,
+		   enum dbx_pos pos)
+{
+	const efi_guid_t *guid = &efi_guid_image_security_database;
+	struct efi_var_entry *old;
+	efi_uintn_t size;
+	void *esl;
+
+	old = efi_var_mem_find(guid, u"dbx", NULL);
+	if (digest) {
+		esl = make_dbx(digest, pos, &size);
+		ut_assertnonnull(esl);
+		ut_assertok(efi_var_mem_ins(u"dbx", guid,
+					    EFI_VARIABLE_BOOTSERVICE_ACCESS |
+					    EFI_VARIABLE_RUNTIME_ACCESS |
+					    EFI_VARIABLE_TIME_BASED_AUTHENTICATED_WRITE_ACCESS,
+					    size, esl, 0, NULL, 0));
+		free(esl);
+	}
+	efi_var_mem_del(old);
+
+	return 0;
+}
+
+/* Check that the cached dbx is rebuilt when the variable changes */
+static int lib_test_efi_signature_cache(struct unit_test_state *uts)
+{
+	struct efi_signature_store *dbx;
+	struct efi_image_regions *regs;
+	u8 image[64], *digest;
+
+	ut_assertok(efi_init_obj_list());
+	ut_assertok(setup_image(uts, image, sizeof(image), &regs, &digest));
+
+	ut_assertok(set_dbx(uts, digest, DBX_RANDOM));
+	dbx = efi_sigstore_get_sigdb(u"dbx");
+	ut_assertnonnull(dbx);
+	ut_assert(efi_signature_lookup_digest(regs, dbx, true));
+
+	/* an unchanged variable gives the same store */
+	ut_asserteq_ptr(dbx, efi_sigstore_get_sigdb(u"dbx"));
+
+	/* change dbx after the first lookup */
+	ut_assertok(set_dbx(uts, digest, DBX_NONE));
+	dbx = efi_sigstore_get_sigdb(u"dbx");
+	ut_assertnonnull(dbx);
+	ut_assert(!efi_signature_lookup_digest(regs, dbx, true));
+
+	ut_assertok(set_dbx(uts, digest, DBX_LAST));
+	dbx = efi_sigstore_get_sigdb(u"dbx");
+	ut_assertnonnull(dbx);
+	ut_assert(efi_signature_lookup_digest(regs, dbx, true));
+
+	/* without a dbx variable the store is empty */
+	ut_assertok(set_dbx(uts, NULL, DBX_NONE));
+	dbx = efi_sigstore_get_sigdb(u"dbx");
+	ut_assertnonnull(dbx);
+	ut_assert(!efi_signature_lookup_digest(regs, dbx, true));
+
+	free(digest);
+	free(regs);
+
+	return 0;
+}
+LIB_TEST(lib_test_efi_signature_cache, 0);
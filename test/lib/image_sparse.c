@@ -0,0 +1,154 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Test writing Android sparse images
+ */
+
+#include <image-sparse.h>
+#include <malloc.h>
+#include <test/lib.h>
+#include <test/test.h>
+#include <test/ut.h>
+
+#define BLKSZ		512
+#define DEV_BLKS	32
+
+/**
+ * struct sparse_test_dev - storage for the test, counting operations
+ *
+ * @data: contents of the storage
+ * @writes: number of calls to the write method
+ * @erases: number of calls to the erase method
+ */
+struct sparse_test_dev {
+	u8 data[DEV_BLKS * BLKSZ];
+	int writes;
+	int erases;
+};
+
+static lbaint_t sparse_test_write(struct sparse_storage *info, lbaint_t blk,
+				  lbaint_t blkcnt, const void *buffer)
+{
+	struct sparse_test_dev *dev = info->priv;
+
+	memcpy(dev->data + blk * BLKSZ, buffer, blkcnt * BLKSZ);
+	dev->writes++;
+
+	return blkcnt;
+}
+
+static lbaint_t sparse_test_reserve(struct sparse_storage *info, lbaint_t blk,
+				    lbaint_t blkcnt)
+{
+	return blkcnt;
+}
+
+static lbaint_t sparse_test_erase(struct sparse_storage *info, lbaint_t blk,
+				  lbaint_t blkcnt)
+{
+	struct sparse_test_dev *dev = info->priv;
+
+	memset(dev->data + blk * BLKSZ, '\0', blkcnt * BLKSZ);
+	dev->erases++;
+
+	return blkcnt;
+}
+
+/**
+ * add_chunk() - add a chunk to a sparse image
+ *
+ * @ptr: Position in the image, updated to point after the chunk
+ * @type: Chunk type
+ * @blks: Number of blocks in the output
+ * @data: Chunk data
+ * @size: Size of chunk data in bytes
+ */
+static void add_chunk(void **ptr, int type, int blks, const void *data,
+		      int size)
+{
+	chunk_header_t *chunk = *ptr;
+
+	chunk->chunk_type = type;
+	chunk->reserved1 = 0;
+	chunk->chunk_sz = blks;
+	chunk->total_sz = sizeof(*chunk) + size;
+	memcpy(chunk + 1, data, size);
+	*ptr += chunk->total_sz;
+}
+
+/* Check raw chunks are gathered into one write and zero fills are erased */
+static int lib_test_image_sparse(struct unit_test_state *uts)
+{
+	sparse_header_t *hdr;
+	struct sparse_test_dev *dev;
+	struct sparse_storage info;
+	u8 raw[6 * BLKSZ], expect[DEV_BLKS * BLKSZ];
+	u32 fill = 0x12345678, zero = 0;
+	void *image, *ptr;
+	int i;
+
+	for (i = 0; i < sizeof(raw); i++)
+		raw[i] = i * 7 + 1;
+
+	image = malloc(sizeof(*hdr) + 6 * sizeof(chunk_header_t) +
+		       7 * BLKSZ + 2 * sizeof(u32));
+	ut_assertnonnull(image);
+	hdr = image;
+	hdr->magic = SPARSE_HEADER_MAGIC;
+	hdr->major_version = 1;
+	hdr->minor_version = 0;
+	hdr->file_hdr_sz = sizeof(*hdr);
+	hdr->chunk_hdr_sz = sizeof(chunk_header_t);
+	hdr->blk_sz = BLKSZ;
+	hdr->total_blks = 20;
+	hdr->total_chunks = 6;
+	hdr->image_checksum = 0;
+
+	/* blocks 0-4 raw, 5-12 zero, 13-14 skipped, 15-17 filled, 18-19 raw */
+	ptr = hdr + 1;
+	add_chunk(&ptr, CHUNK_TYPE_RAW, 4, raw, 4 * BLKSZ);
+	add_chunk(&ptr, CHUNK_TYPE_RAW, 1, raw + 4 * BLKSZ, BLKSZ);
+	add_chunk(&ptr, CHUNK_TYPE_FILL, 8, &zero, sizeof(zero));
+	add_chunk(&ptr, CHUNK_TYPE_DONT_CARE, 2, raw, 0);
+	add_chunk(&ptr, CHUNK_TYPE_FILL, 3, &fill, sizeof(fill));
+	add_chunk(&ptr, CHUNK_TYPE_RAW, 2, raw + 4 * BLKSZ, 2 * BLKSZ);
+
+	memset(expect, 0xaa, sizeof(expect));
+	memcpy(expect, raw, 5 * BLKSZ);
+	memset(expect + 5 * BLKSZ, '\0', 8 * BLKSZ);
+	for (i = 0; i < 3 * BLKSZ; i += sizeof(fill))
+		memcpy(expect + 15 * BLKSZ + i, &fill, sizeof(fill));
+	memcpy(expect + 18 * BLKSZ, raw + 4 * BLKSZ, 2 * BLKSZ);
+
+	dev = malloc(sizeof(*dev));
+	ut_assertnonnull(dev);
+	memset(&info, '\0', sizeof(info));
+	info.blksz = BLKSZ;
+	info.start = 0;
+	info.size = DEV_BLKS;
+	info.priv = dev;
+	info.write = sparse_test_write;
+	info.reserve = sparse_test_reserve;
+	info.erase = sparse_test_erase;
+
+	memset(dev, '\0', sizeof(*dev));
+	memset(dev->data, 0xaa, sizeof(dev->data));
+	ut_assertok(write_sparse_image(&info, "test", image, NULL));
+	ut_asserteq_mem(expect, dev->data, sizeof(expect));
+	ut_asserteq(1, dev->erases);
+	ut_asserteq(CONFIG_IS_ENABLED(SYS_DCACHE_OFF) ? 4 : 3, dev->writes);
+
+	/* without an erase method the zeroes are written */
+	info.erase = NULL;
+	memset(dev, '\0', sizeof(*dev));
+	memset(dev->data, 0xaa, sizeof(dev->data));
+	ut_assertok(write_sparse_image(&info, "test", image, NULL));
+	ut_asserteq_mem(expect, dev->data, sizeof(expect));
+	ut_asserteq(0, dev->erases);
+	ut_asserteq(CONFIG_IS_ENABLED(SYS_DCACHE_OFF) ? 5 : 4, dev->writes);
+
+	free(dev);
+	free(image);
+
+	return 0;
+}
+LIB_TEST(lib_test_image_sparse, 0);
@@ -0,0 +1,60 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Test of the sampling profiler
+ */
+
+#include <malloc.h>
+#include <prof.h>
+#include <time.h>
+#include <trace.h>
+#include <linux/errno.h>
+#include <test/lib.h>
+#include <test/test.h>
+#include <test/ut.h>
+
+/* Check that samples are taken and can be written out for proftool */
+static int lib_test_prof(struct unit_test_state *uts)
+{
+	struct trace_output_hdr *hdr;
+	struct trace_sample *sample;
+	size_t needed, size;
+	ulong start;
+	void *buf;
+
+	prof_wipe();
+	ut_assertok(prof_start(1000));
+	ut_asserteq(-EALREADY, prof_start(1000));
+
+	/* Keep the CPU busy until some samples arrive, or give up */
+	start = get_timer(0);
+	do {
+		ut_asserteq(-ENOSPC, prof_list_samples(NULL, 0, &needed));
+	} while (needed == sizeof(*hdr) && get_timer(start) < 2000);
+	prof_stop();
+	ut_assert(needed > sizeof(*hdr));
+
+	/* A buffer which is too small is rejected */
+	ut_asserteq(-ENOSPC, prof_list_samples(NULL, 0, &size));
+	buf = malloc(size);
+	ut_assertnonnull(buf);
+	ut_asserteq(-ENOSPC, prof_list_samples(buf, size - 1, &needed));
+	ut_asserteq(size, needed);
+
+	ut_assertok(prof_list_samples(buf, size, &needed));
+	hdr = buf;
+	ut_asserteq(TRACE_CHUNK_SAMPLES, hdr->type);
+	ut_asserteq(TRACE_VERSION, hdr->version);
+	ut_assert(hdr->rec_count > 0);
+	sample = (struct trace_sample *)(hdr + 1);
+	ut_assert(sample->depth >= 1);
+	ut_assert(sample->depth <= CONFIG_PROFILER_STACK_DEPTH);
+	free(buf);
+
+	/* Wiping removes the samples */
+	prof_wipe();
+	ut_asserteq(-ENOSPC, prof_list_samples(NULL, 0, &needed));
+	ut_asserteq(sizeof(*hdr), needed);
+
+	return 0;
+}
+LIB_TEST(lib_test_prof, 0);
@@ -144,3 +144,33 @@ static int uthread_mutex(struct unit_test_state *uts)
 	return 0;
 }
 LIB_TEST(uthread_mutex, 0);
+
+/*
+ * uthread_abandon() - testing abandoning a thread group
+ *
+ * Two workers are started, one in a group. After both have run once, the group
+ * is abandoned. Only the other worker should make any further progress.
+ */
+static int uthread_abandon(struct unit_test_state *uts)
+{
+	int id;
+
+	count = 0;
+	id = uthread_grp_new_id();
+	ut_assert(id != 0);
+	ut_assertok(uthread_create(NULL, worker, (void *)5, 0, id));
+	ut_assertok(uthread_create(NULL, worker, (void *)2, 0, 0));
+	ut_assert(uthread_schedule());
+	ut_asserteq(2, count);
+	ut_assert(!uthread_grp_done(id));
+
+	/* The first worker is dropped without running again */
+	uthread_grp_abandon(id);
+	ut_assert(uthread_grp_done(id));
+	while (uthread_schedule())
+		;
+	ut_asserteq(3, count);
+
+	return 0;
+}
+LIB_TEST(uthread_abandon, 0);
@@ -0,0 +1,88 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Test of the binary log driver
+ */
+
+#include <command.h>
+#include <console.h>
+#include <log.h>
+#include <asm/global_data.h>
+#include <test/log.h>
+#include <test/test.h>
+#include <test/ut.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+/* Check the next line of 'log dump' output, skipping the timestamp */
+static int check_bin_line(struct unit_test_state *uts, const char *expect)
+{
+	char *msg;
+
+	ut_assert(console_record_readline(uts->actual_str,
+					  sizeof(uts->actual_str)) >= 0);
+	ut_asserteq('[', *uts->actual_str);
+	msg = strstr(uts->actual_str, "] ");
+	ut_assertnonnull(msg);
+	ut_asserteq_str(expect, msg + 2);
+
+	return 0;
+}
+
+static int check_lines(struct unit_test_state *uts)
+{
+	ut_assertok(check_bin_line(uts,
+				   "ERR.arch, int -3, hex 00ab, str 'stack'"));
+	ut_assertok(check_bin_line(uts,
+				   "INFO.boot, long -4, llong 123456789, width '   ab'"));
+	ut_assertok(check_bin_line(uts, "ERR.arch, first cont second"));
+	ut_assertok(check_bin_line(uts, "INFO.boot, prec 'abc' %"));
+	ut_assert_console_end();
+
+	return 0;
+}
+
+static int log_test_bin(struct unit_test_state *uts)
+{
+	struct log_driver *drv = LOG_GET_DRIVER(console);
+	char str[20];
+	int log_fmt;
+	int log_level;
+
+	log_fmt = gd->log_fmt;
+	log_level = gd->default_log_level;
+	log_bin_reset();
+
+	/* Only record in the binary log */
+	gd->default_log_level = LOGL_INFO;
+	ut_assertok(log_device_set_enable(drv, false));
+	strcpy(str, "stack");
+	log(LOGC_ARCH, LOGL_ERR, "int %d, hex %04x, str '%s'\n", -3, 0xab,
+	    str);
+
+	/* The string should have been copied */
+	strcpy(str, "changed");
+	log(LOGC_BOOT, LOGL_INFO, "long %ld, llong %llx, width '%*s'\n",
+	    -4L, 0x123456789ULL, 5, "ab");
+	log(LOGC_ARCH, LOGL_ERR, "first ");
+	log(LOGC_CONT, LOGL_CONT, "cont %s\n", "second");
+	log(LOGC_BOOT, LOGL_INFO, "prec '%.3s' %%\n", "abcdef");
+	log(LOGC_BOOT, LOGL_DEBUG, "not recorded\n");
+	ut_assertok(log_device_set_enable(drv, true));
+	gd->default_log_level = log_level;
+	ut_assert_console_end();
+
+	/* Now format the records, twice */
+	gd->log_fmt = (1 << LOGF_CAT) | (1 << LOGF_LEVEL) | (1 << LOGF_MSG);
+	ut_asserteq(5, log_bin_dump());
+	ut_assertok(check_lines(uts));
+	ut_assertok(run_command("log dump -c", 0));
+	ut_assertok(check_lines(uts));
+	gd->log_fmt = log_fmt;
+
+	/* The log should now be empty */
+	ut_asserteq(0, log_bin_dump());
+	ut_assert_console_end();
+
+	return 0;
+}
+LOG_TEST(log_test_bin);
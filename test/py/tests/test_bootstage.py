@@ -23,6 +23,7 @@ For example:
     }
 """
 
+import json
 import pytest
 
 @pytest.mark.buildconfigspec('bootstage')
@@ -44,6 +45,39 @@ def test_bootstage_report(ubman):
     assert 'Accumulated time:' in output
     assert 'dm_r' in output
 
+@pytest.mark.buildconfigspec('bootstage')
+@pytest.mark.buildconfigspec('cmd_bootstage')
+@pytest.mark.buildconfigspec('bootstage_spans')
+def test_bootstage_trace(ubman):
+    """Test the bootstage trace subcommand
+
+    This checks that the output is valid JSON in Chrome trace format, that it
+    includes the 'reset' mark and that device probes are recorded as nested
+    spans.
+    """
+    output = ubman.run_command('bootstage trace')
+    trace = json.loads(output)
+    events = trace['traceEvents']
+    assert 'reset' in [evt['name'] for evt in events if evt['ph'] == 'i']
+
+    spans = [evt for evt in events if evt['ph'] == 'X']
+    probes = [evt for evt in spans if evt['cat'] == 'probe']
+    assert 'root_driver' in [evt['name'] for evt in probes]
+    for evt in spans:
+        assert evt['dur'] >= 0
+        parent = evt['args']['parent']
+        assert parent < evt['args']['id']
+        if parent >= 0:
+            assert spans[parent]['ts'] <= evt['ts']
+
+    output = ubman.run_command('bootstage trace 1000 10')
+    assert 'Trace needs' in output
+    output = ubman.run_command('bootstage trace 1000')
+    assert 'Usage' in output
+
+    output = ubman.run_command('bootstage report')
+    assert 'Spans (' in output
+
 @pytest.mark.buildconfigspec('bootstage')
 @pytest.mark.buildconfigspec('cmd_bootstage')
 @pytest.mark.buildconfigspec('bootstage_stash')
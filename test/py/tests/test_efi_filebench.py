@@ -0,0 +1,99 @@
+# SPDX-License-Identifier:      GPL-2.0+
+
+""" Benchmark for reading a file through the EFI_FILE_PROTOCOL
+"""
+
+import random
+import shutil
+import pytest
+from subprocess import call, check_call, CalledProcessError
+from tests import fs_helper
+
+# Size of the file to read, which filebench.efi reads in 4 KiB chunks
+FILE_SIZE = 4 << 20
+CHUNK_SIZE = 4096
+
+# Position which filebench.efi seeks back to, before reading one more chunk
+REREAD_POS = FILE_SIZE // 2 + 100
+
+def checksum(data):
+    """Calculate the checksum reported by filebench.efi
+
+    Args:
+        data (bytes): File contents
+
+    Returns:
+        int: Checksum
+    """
+    csum = 0
+    for byte in data:
+        csum = (((csum << 1) | (csum >> 31)) + byte) & 0xffffffff
+    return csum
+
+@pytest.mark.boardspec('sandbox')
+@pytest.mark.buildconfigspec('bootefi_testapp_compile')
+@pytest.mark.buildconfigspec('cmd_perf')
+@pytest.mark.buildconfigspec('cmd_block_cache')
+@pytest.mark.singlethread
+def test_efi_filebench(ubman):
+    """Read a large file in 4 KiB chunks, as GRUB does with a kernel
+
+    The number of filesystem reads and their throughput are shown by the
+    'perf' command. The block cache is disabled, so that the number of
+    block reads shows whether the file is kept open: looking the file up
+    again for each Read() would need several block reads each time.
+
+    Args:
+        ubman -- U-Boot console
+    """
+    try:
+        image, mnt = fs_helper.setup_image(ubman, 0, 0xc,
+                                           basename='test_efi_filebench')
+
+        data = random.Random(0).randbytes(FILE_SIZE)
+        with open(mnt + '/bench.bin', 'wb') as outf:
+            outf.write(data)
+        shutil.copyfile(ubman.config.build_dir +
+                        '/lib/efi_loader/filebench.efi',
+                        mnt + '/filebench.efi')
+
+        fsfile = fs_helper.mk_fs(ubman.config, 'vfat', FILE_SIZE + 0x200000,
+                                 'test_efi_filebench', mnt)
+        check_call(f'dd if={fsfile} of={image} bs=1M seek=1', shell=True)
+    except CalledProcessError:
+        pytest.skip('Preparing test_efi_filebench image failed')
+        return
+    finally:
+        call(f'rm -rf {mnt}', shell=True)
+
+    try:
+        ubman.run_command(f'host bind 0 {image}')
+        ubman.run_command('load host 0:1 ${kernel_addr_r} filebench.efi')
+        ubman.run_command('blkcache configure 0 0')
+        ubman.run_command('perf reset')
+        response = ubman.run_command('bootefi ${kernel_addr_r}')
+
+        chunks = FILE_SIZE // CHUNK_SIZE + 1
+        assert (f'Read {FILE_SIZE:#010x} bytes in {chunks:#010x} chunks, '
+                f'checksum {checksum(data):#010x}') in response
+        reread = data[REREAD_POS:REREAD_POS + CHUNK_SIZE]
+        assert (f'Re-read {CHUNK_SIZE:#010x} bytes at {REREAD_POS:#010x}, '
+                f'checksum {checksum(reread):#010x}') in response
+
+        response = ubman.run_command('perf show')
+        ops = {}
+        for line in response.splitlines():
+            fields = line.split()
+            if len(fields) > 1 and fields[1].isdigit():
+                ops[fields[0]] = int(fields[1])
+
+        # Each Read() should be a single filesystem read
+        assert 0 < ops.get('fs.fat', 0) <= chunks + 1
+
+        # and should only read the data, without mounting the file system
+        # and looking up the file again
+        assert ops.get('blk.read', 0) < chunks * 2
+    finally:
+        ubman.run_command('blkcache configure 8 32')
+        ubman.run_command('host unbind 0')
+        call(f'rm -f {image}', shell=True)
@@ -0,0 +1,163 @@
+# SPDX-License-Identifier:      GPL-2.0+
+
+""" Test for the journal of changes to non-volatile UEFI variables
+
+Changes are appended to ubootefi.jnl on the EFI system partition, which is
+replayed after ubootefi.var when U-Boot starts.
+"""
+
+import pytest
+from subprocess import call, check_call, CalledProcessError
+from tests import fs_helper
+
+GUID = '8a9ac4f2-2e2a-4f1c-9b69-8d0d7e1a4b21'
+
+def setup_esp(ubman, fs_type, basename):
+    """Create a disk image with an empty EFI system partition
+
+    Args:
+        ubman (ConsoleBase): U-Boot console
+        fs_type (str): File system to use, e.g. 'vfat'
+        basename (str): Base name to use for the image files
+
+    Returns:
+        str: Filename of the disk image
+    """
+    try:
+        image, mnt = fs_helper.setup_image(ubman, 0, 0xef, img_size=4,
+                                           basename=basename)
+        fsfile = fs_helper.mk_fs(ubman.config, fs_type, 0x100000, basename)
+        check_call(f'dd if={fsfile} of={image} bs=1M seek=1', shell=True)
+        call(f'rm -f {fsfile}', shell=True)
+    except CalledProcessError:
+        pytest.skip(f'Preparing {basename} image failed')
+    finally:
+        call(f'rm -rf {mnt}', shell=True)
+    return image
+
+def start(ubman, image):
+    """Restart U-Boot with the image bound, so variables are read from it
+
+    The image must be bound before the EFI sub-system is started, so that
+    its partition is used as the EFI system partition.
+
+    Args:
+        ubman (ConsoleBase): U-Boot console
+        image (str): Filename of the disk image
+
+    Returns:
+        str: Output from binding the image
+    """
+    ubman.restart_uboot()
+    return ubman.run_command(f'host bind 0 {image}')
+
+def set_var(ubman, name, value=''):
+    """Set or delete a non-volatile variable
+
+    Args:
+        ubman (ConsoleBase): U-Boot console
+        name (str): Name of the variable
+        value (str): Value to set, or '' to delete the variable
+
+    Returns:
+        str: Output from the command
+    """
+    return ubman.run_command(f'setenv -e -nv -bs -rt -guid {GUID} {name} '
+                             f'{value}')
+
+def var_size(ubman, name):
+    """Get the size of a variable
+
+    Args:
+        ubman (ConsoleBase): U-Boot console
+        name (str): Name of the variable
+
+    Returns:
+        int: Size of the variable in bytes, or None if it does not exist
+    """
+    response = ubman.run_command(f'printenv -e -n -guid {GUID} {name}')
+    if 'not defined' in response:
+        return None
+    return int(response.split('DataSize = ')[1].split()[0], 16)
+
+@pytest.mark.boardspec('sandbox')
+@pytest.mark.buildconfigspec('efi_variable_file_store')
+@pytest.mark.buildconfigspec('cmd_nvedit_efi')
+@pytest.mark.singlethread
+def test_efi_var_journal(ubman):
+    """Set, change and delete variables, then read them back after restart
+
+    Args:
+        ubman -- U-Boot console
+    """
+    image = setup_esp(ubman, 'vfat', 'test_efi_var_journal')
+    try:
+        start(ubman, image)
+
+        # The first change writes ubootefi.var, the rest go in the journal
+        set_var(ubman, 'JnlVar1', 'one')
+        set_var(ubman, 'JnlVar2', 'two')
+        set_var(ubman, 'JnlVar3', 'three')
+        set_var(ubman, 'JnlVar1', 'eins')
+        set_var(ubman, 'JnlVar2')
+        ubman.run_command('size host 0:1 ubootefi.jnl')
+        response = ubman.run_command('printenv filesize')
+        assert int(response.split('=')[1], 16) > 0
+
+        start(ubman, image)
+        assert var_size(ubman, 'JnlVar1') == 4
+        assert var_size(ubman, 'JnlVar2') is None
+        assert var_size(ubman, 'JnlVar3') == 5
+
+        # Corrupt the last record, which deletes JnlVar2
+        start(ubman, image)
+        ubman.run_command_list([
+            'load host 0:1 ${loadaddr} ubootefi.jnl',
+            'setenv jnlsize ${filesize}',
+            'setexpr addr ${loadaddr} + ${jnlsize}',
+            'setexpr addr ${addr} - 1',
+            'setexpr.b val *${addr} ^ ff',
+            'mw.b ${addr} ${val}',
+            'save host 0:1 ${loadaddr} ubootefi.jnl ${jnlsize}'])
+        response = ubman.run_command(f'printenv -e -n -guid {GUID} JnlVar2')
+        assert 'Ignoring invalid EFI variables journal' in response
+        assert var_size(ubman, 'JnlVar1') == 4
+        assert var_size(ubman, 'JnlVar2') == 3
+        assert var_size(ubman, 'JnlVar3') == 5
+
+        # The next change rewrites ubootefi.var and empties the journal
+        set_var(ubman, 'JnlVar4', 'four')
+        start(ubman, image)
+        response = ubman.run_command(f'printenv -e -n -guid {GUID} JnlVar4')
+        assert 'Ignoring' not in response
+        assert 'DataSize = 0x4' in response
+        assert var_size(ubman, 'JnlVar2') == 3
+    finally:
+        ubman.restart_uboot()
+        call(f'rm -f {image}', shell=True)
+
+@pytest.mark.boardspec('sandbox')
+@pytest.mark.buildconfigspec('efi_variable_file_store')
+@pytest.mark.buildconfigspec('cmd_nvedit_efi')
+@pytest.mark.buildconfigspec('ext4_write')
+@pytest.mark.singlethread
+def test_efi_var_journal_ext4(ubman):
+    """Check that variables are saved in full when ext4 cannot append
+
+    Args:
+        ubman -- U-Boot console
+    """
+    image = setup_esp(ubman, 'ext4', 'test_efi_var_journal_ext4')
+    try:
+        start(ubman, image)
+        outputs = [set_var(ubman, f'JnlVar{i}', f'value{i}')
+                   for i in range(4)]
+        warnings = [out for out in outputs if 'Cannot append' in out]
+        assert len(warnings) == 1
+
+        start(ubman, image)
+        for i in range(4):
+            assert var_size(ubman, f'JnlVar{i}') == 6
+    finally:
+        ubman.restart_uboot()
+        call(f'rm -f {image}', shell=True)
@@ -70,6 +70,8 @@ enum {
  * @OUT_FMT_FLAMEGRAPH_CALLS: Write a file suitable for flamegraph.pl
  * @OUT_FMT_FLAMEGRAPH_TIMING: Write a file suitable for flamegraph.pl with the
  * counts set to the number of microseconds used by each function
+ * @OUT_FMT_FLAMEGRAPH_SAMPLES: Write a file suitable for flamegraph.pl with the
+ * counts set to the number of profiler samples taken in each function
  */
 enum out_format_t {
 	OUT_FMT_DEFAULT,
@@ -77,6 +79,7 @@ enum out_format_t {
 	OUT_FMT_FUNCGRAPH,
 	OUT_FMT_FLAMEGRAPH_CALLS,
 	OUT_FMT_FLAMEGRAPH_TIMING,
+	OUT_FMT_FLAMEGRAPH_SAMPLES,
 };
 
 /* Section types for v7 format (trace-cmd format) */
@@ -254,6 +257,9 @@ struct func_info *func_list;
 int func_count;			/* number of functions */
 struct trace_call *call_list;	/* list of all calls in the input trace file */
 int call_count;			/* number of calls */
+uint32_t *sample_list;		/* samples from the profiler, see trace_sample */
+size_t sample_words;		/* number of words in sample_list */
+int sample_count;		/* number of samples */
 int verbose;	/* Verbosity level 0=none, 1=warn, 2=notice, 3=info, 4=debug */
 ulong text_offset;		/* text address of first function */
 ulong text_base;		/* CONFIG_TEXT_BASE from trace file */
@@ -292,7 +298,8 @@ static void usage(void)
 		"   -f <subtype>\tSpecify output subtype\n"
 		"   -m <map>\tSpecify System.map file\n"
 		"   -o <fname>\tSpecify output file\n"
-		"   -t <fname>\tSpecify trace data file (from U-Boot 'trace calls')\n"
+		"   -t <fname>\tSpecify trace data file (from U-Boot 'trace calls' or\n"
+		"\t\t'prof samples')\n"
 		"   -v <0-4>\tSpecify verbosity\n"
 		"\n"
 		"Subtypes for dump-ftrace:\n"
@@ -301,7 +308,9 @@ static void usage(void)
 		"\n"
 		"Subtypes for dump-flamegraph\n"
 		"   calls - create a flamegraph of stack frames\n"
-		"   timing - create a flamegraph of microseconds for each stack frame\n");
+		"   timing - create a flamegraph of microseconds for each stack frame\n"
+		"   samples - create a flamegraph of profiler samples (default if the\n"
+		"\tfile has samples but no calls)\n");
 	exit(EXIT_FAILURE);
 }
 
@@ -483,6 +492,51 @@ static int read_calls(FILE *fin, size_t count)
 	return 0;
 }
 
+/**
+ * read_samples() - Read the samples from the profiler
+ *
+ * Each sample is a struct trace_sample, so this reads the depth and then the
+ * offsets, storing them in sample_list in the same format
+ *
+ * @fin: File to read from
+ * @count: Number of samples to read
+ * Returns: 0 if OK, -1 on error
+ */
+static int read_samples(FILE *fin, size_t count)
+{
+	size_t alloced = sample_words;
+	int i;
+
+	notice("sample count: %zu\n", count);
+	for (i = 0; i < count; i++) {
+		uint32_t depth;
+
+		if (read_data(fin, &depth, sizeof(depth)))
+			return -1;
+		if (!depth || depth > MAX_STACK_DEPTH) {
+			error("Invalid sample depth %u\n", depth);
+			return -1;
+		}
+		if (sample_words + 1 + depth > alloced) {
+			alloced = (alloced + 1 + depth) * 2;
+			sample_list = realloc(sample_list,
+					      alloced * sizeof(uint32_t));
+			if (!sample_list) {
+				error("Cannot allocate sample_list\n");
+				return -1;
+			}
+		}
+		sample_list[sample_words] = depth;
+		if (read_data(fin, &sample_list[sample_words + 1],
+			      depth * sizeof(uint32_t)))
+			return -1;
+		sample_words += 1 + depth;
+		sample_count++;
+	}
+
+	return 0;
+}
+
 /**
  * read_trace() - Read the U-Boot trace file
  *
@@ -515,6 +569,11 @@ static int read_trace(FILE *fin)
 			if (read_calls(fin, hdr.rec_count))
 				return 1;
 			break;
+
+		case TRACE_CHUNK_SAMPLES:
+			if (read_samples(fin, hdr.rec_count))
+				return 1;
+			break;
 		}
 	}
 	return 0;
@@ -1638,6 +1697,36 @@ static struct flame_node *create_node(const char *msg)
 	return node;
 }
 
+/**
+ * find_child() - Find or create the child node for a function
+ *
+ * @state: Current flamegraph state
+ * @node: Parent node
+ * @func: Function to look for
+ * Returns: Child node, or NULL if out of memory
+ */
+static struct flame_node *find_child(struct flame_state *state,
+				     struct flame_node *node,
+				     struct func_info *func)
+{
+	struct flame_node *child;
+
+	list_for_each_entry(child, &node->child_head, sibling_node) {
+		if (child->func == func)
+			return child;
+	}
+
+	child = create_node("child");
+	if (!child)
+		return NULL;
+	list_add_tail(&child->sibling_node, &node->child_head);
+	child->func = func;
+	child->parent = node;
+	state->nodes++;
+
+	return child;
+}
+
 /**
  * process_call(): Add a call to the flamegraph info
  *
@@ -1661,26 +1750,11 @@ static int process_call(struct flame_state *state, bool entry, ulong timestamp,
 	int stack_ptr = state->stack_ptr;
 
 	if (entry) {
-		struct flame_node *child, *chd;
-
-		/* see if we have this as a child node already */
-		child = NULL;
-		list_for_each_entry(chd, &node->child_head, sibling_node) {
-			if (chd->func == func) {
-				child = chd;
-				break;
-			}
-		}
-		if (!child) {
-			/* create a new node */
-			child = create_node("child");
-			if (!child)
-				return -1;
-			list_add_tail(&child->sibling_node, &node->child_head);
-			child->func = func;
-			child->parent = node;
-			state->nodes++;
-		}
+		struct flame_node *child;
+
+		child = find_child(state, node, func);
+		if (!child)
+			return -1;
 		debug("entry %s: move from %s to %s\n", func->name,
 		      node->func ? node->func->name : "(root)",
 		      child->func->name);
@@ -1777,6 +1851,66 @@ static int make_flame_tree(enum out_format_t out_format,
 	return 0;
 }
 
+/**
+ * make_sample_tree() - Create a tree of stack traces from profiler samples
+ *
+ * This works like make_flame_tree() but each sample is a complete call stack,
+ * so the count is added to the leaf node, i.e. the function which was running
+ * when the sample was taken
+ *
+ * @treep: Returns the resulting flamegraph tree
+ * Returns: 0 on success, -ve on error
+ */
+static int make_sample_tree(struct flame_node **treep)
+{
+	static struct func_info outside = { .name = "[outside]" };
+	struct flame_state state;
+	struct flame_node *tree;
+	size_t pos;
+
+	tree = create_node("tree");
+	if (!tree)
+		return -1;
+	state.nodes = 0;
+
+	for (pos = 0; pos < sample_words; pos += 1 + sample_list[pos]) {
+		uint32_t depth = sample_list[pos];
+		const uint32_t *offset = &sample_list[pos + 1];
+		struct flame_node *node = tree;
+		int i;
+
+		/* The outermost caller comes last */
+		for (i = depth - 1; i >= 0; i--) {
+			struct func_info *func;
+
+			if (offset[i] == TRACE_SAMPLE_OUTSIDE) {
+				func = &outside;
+			} else {
+				/*
+				 * Callers are recorded by their return address,
+				 * which may be just past the end of the calling
+				 * function, so look up the call instruction
+				 */
+				func = find_caller_by_offset(i ? offset[i] - 1 :
+							     offset[i]);
+				if (!func) {
+					warn("Cannot find function at %lx\n",
+					     text_offset + offset[i]);
+					break;
+				}
+			}
+			node = find_child(&state, node, func);
+			if (!node)
+				return -1;
+		}
+		node->count++;
+	}
+	fprintf(stderr, "%d nodes\n", state.nodes);
+	*treep = tree;
+
+	return 0;
+}
+
 /**
  * output_tree() - Output a flamegraph tree
  *
@@ -1813,7 +1947,8 @@ static int output_tree(FILE *fout, enum out_format_t out_format,
 	char *str = abuf_data(str_buf);
 
 	if (node->count) {
-		if (out_format == OUT_FMT_FLAMEGRAPH_CALLS) {
+		if (out_format == OUT_FMT_FLAMEGRAPH_CALLS ||
+		    out_format == OUT_FMT_FLAMEGRAPH_SAMPLES) {
 			fprintf(fout, "%s %d\n", str, node->count);
 		} else {
 			/*
@@ -1878,7 +2013,11 @@ static int make_flamegraph(FILE *fout, enum out_format_t out_format)
 	char *str;
 	int ret = 0;
 
-	if (make_flame_tree(out_format, &tree))
+	if (out_format == OUT_FMT_FLAMEGRAPH_SAMPLES)
+		ret = make_sample_tree(&tree);
+	else
+		ret = make_flame_tree(out_format, &tree);
+	if (ret)
 		return -1;
 
 	abuf_init(&str_buf);
@@ -1941,8 +2080,11 @@ static int prof_tool(int argc, char *const argv[],
 			FILE *fout;
 
 			if (out_format != OUT_FMT_FLAMEGRAPH_CALLS &&
-			    out_format != OUT_FMT_FLAMEGRAPH_TIMING)
-				out_format = OUT_FMT_FLAMEGRAPH_CALLS;
+			    out_format != OUT_FMT_FLAMEGRAPH_TIMING &&
+			    out_format != OUT_FMT_FLAMEGRAPH_SAMPLES)
+				out_format = sample_count && !call_count ?
+					OUT_FMT_FLAMEGRAPH_SAMPLES :
+					OUT_FMT_FLAMEGRAPH_CALLS;
 			fout = fopen(out_fname, "w");
 			if (!fout) {
 				fprintf(stderr, "Cannot write file '%s'\n",
@@ -1983,9 +2125,11 @@ int main(int argc, char *argv[])
 				out_format = OUT_FMT_FLAMEGRAPH_CALLS;
 			} else if (!strcmp("timing", optarg)) {
 				out_format = OUT_FMT_FLAMEGRAPH_TIMING;
+			} else if (!strcmp("samples", optarg)) {
+				out_format = OUT_FMT_FLAMEGRAPH_SAMPLES;
 			} else {
 				fprintf(stderr,
-					"Invalid format: use function, funcgraph, calls, timing\n");
+					"Invalid format: use function, funcgraph, calls, timing, samples\n");
 				exit(1);
 			}
 			break;